@@ -50,6 +50,12 @@ namespace uicore
 		void read(void *data, int size) { int bytes = try_read(data, size); if (bytes != size) throw Exception("Could not read all bytes"); }
 		virtual void write(const void *data, int size) = 0;
 
+		/// \brief Returns a pointer to the next size bytes and moves past them, if the device is memory backed
+		///
+		/// Allows parsers to use the data in place instead of copying it. Returns nullptr without changing the position
+		/// if the device is not memory backed or fewer than size bytes remain.
+		virtual const void *try_read_in_place(int /*size*/) { return nullptr; }
+
 		virtual void close() { }
 
 		bool is_big_endian_mode() const { return swap_bytes; }
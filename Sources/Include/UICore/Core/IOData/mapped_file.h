@@ -0,0 +1,62 @@
+/*
+**  UICore
+**  Copyright (c) 1997-2015 The UICore Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries UICore may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include <string>
+#include <memory>
+#include "../System/databuffer.h"
+
+namespace uicore
+{
+	/// \brief Data buffer backed by a memory mapped file
+	///
+	/// The file is mapped copy-on-write, so the contents can be parsed in place without first being read into
+	/// a heap buffer. Writing to the buffer never modifies the file. Growing the buffer beyond the file size
+	/// moves the contents to regular heap memory.
+	///
+	/// Unlike File::read_all_bytes the buffer is not a snapshot: pages not yet written to may reflect later changes
+	/// to the file. The caller must make sure the file is not truncated or replaced while it is mapped, as reading
+	/// pages beyond the new end of the file fails with a bus error instead of an exception. The same happens if the
+	/// file lives on a network share that becomes unavailable.
+	/// Use it for large files that are parsed right away and released afterwards, such as when decoding an image file.
+	class MappedFile : public DataBuffer
+	{
+	public:
+		/// \brief Maps an existing file into memory
+		static std::shared_ptr<MappedFile> open(const std::string &filename);
+
+		/// \brief Maps the file if it is at least min_mapped_size bytes, otherwise reads it with File::read_all_bytes
+		///
+		/// Small files gain nothing from a mapping, and reading them keeps read errors as exceptions.
+		static std::shared_ptr<DataBuffer> open_or_read(const std::string &filename, size_t min_mapped_size = 1024 * 1024);
+
+		/// \brief Returns true while the data is still backed by the file mapping
+		virtual bool is_mapped() const = 0;
+	};
+}
@@ -102,6 +102,12 @@ namespace uicore
 			return base_table[(f >> 23) & 0x1ff] + ((f & 0x007fffff) >> shift_table[(f >> 23) & 0x1ff]);
 		}
 
+		/// \brief Converts an array of half-floats to floats
+		static void to_float_array(const HalfFloat *input, float *output, int count);
+
+		/// \brief Converts an array of floats to half-floats
+		static void from_float_array(const float *input, HalfFloat *output, int count);
+
 	private:
 		unsigned short value;
 
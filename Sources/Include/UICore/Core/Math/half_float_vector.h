@@ -73,6 +73,12 @@ namespace uicore
 	public:
 		operator Vec2f() const { return to_float(); }
 		Vec2f to_float() const { return Vec2f((float)x, (float)y); }
+
+		/// \brief Converts an array of vectors to float vectors
+		static void to_float_array(const Vec2hf *input, Vec2f *output, int count) { HalfFloat::to_float_array(&input->x, &output->x, count * 2); }
+
+		/// \brief Converts an array of float vectors to half-float vectors
+		static void from_float_array(const Vec2f *input, Vec2hf *output, int count) { HalfFloat::from_float_array(&input->x, &output->x, count * 2); }
 	};
 
 	/// \brief 3D half-float vector
@@ -104,6 +110,12 @@ namespace uicore
 	public:
 		operator Vec3f() const { return to_float(); }
 		Vec3f to_float() const { return Vec3f((float)x, (float)y, (float)z); }
+
+		/// \brief Converts an array of vectors to float vectors
+		static void to_float_array(const Vec3hf *input, Vec3f *output, int count) { HalfFloat::to_float_array(&input->x, &output->x, count * 3); }
+
+		/// \brief Converts an array of float vectors to half-float vectors
+		static void from_float_array(const Vec3f *input, Vec3hf *output, int count) { HalfFloat::from_float_array(&input->x, &output->x, count * 3); }
 	};
 
 	/// \brief 4D half-float vector
@@ -137,6 +149,12 @@ namespace uicore
 	public:
 		operator Vec4f() const { return to_float(); }
 		Vec4f to_float() const { return Vec4f((float)x, (float)y, (float)z, (float)w); }
+
+		/// \brief Converts an array of vectors to float vectors
+		static void to_float_array(const Vec4hf *input, Vec4f *output, int count) { HalfFloat::to_float_array(&input->x, &output->x, count * 4); }
+
+		/// \brief Converts an array of float vectors to half-float vectors
+		static void from_float_array(const Vec4f *input, Vec4hf *output, int count) { HalfFloat::from_float_array(&input->x, &output->x, count * 4); }
 	};
 
 	inline Vec2hf::Vec2hf(const Vec3hf &copy) : x(copy.x), y(copy.y) {}
@@ -52,9 +52,48 @@ namespace uicore
 		// \param mode Compression strategy
 		static std::shared_ptr<DataBuffer> compress(const std::shared_ptr<DataBuffer> &data, bool raw = true, int compression_level = 6, CompressionMode mode = default_strategy);
 
+		// \brief Compress data using multiple threads
+		//
+		// The data is split into blocks that are deflated independently and joined at sync flush boundaries, producing a single valid stream.
+		// Each block is primed with the last 32 KB of the block before it, so the result is close to the size produced by compress().
+		// \param data Data to compress
+		// \param raw Skips header if true
+		// \param compression_level Compression level in range 0-9. 0 = no compression, 1 = best speed, 6 = default, 9 = best compression.
+		// \param mode Compression strategy
+		// \param block_size Uncompressed bytes per block
+		static std::shared_ptr<DataBuffer> compress_parallel(const std::shared_ptr<DataBuffer> &data, bool raw = true, int compression_level = 6, CompressionMode mode = default_strategy, int block_size = 256 * 1024);
+
 		// \brief Decompress data
 		// \param data Data to compress
 		// \param raw Skips header if true
 		static std::shared_ptr<DataBuffer> decompress(const std::shared_ptr<DataBuffer> &data, bool raw = true);
 	};
+
+	/// \brief Incremental inflate decompressor
+	///
+	/// Decompresses a stream that arrives in blocks, without keeping all of the compressed or decompressed data in memory.
+	class ZLibDecompressor
+	{
+	public:
+		// \brief Constructs a decompressor
+		// \param raw Skips header if true
+		static std::shared_ptr<ZLibDecompressor> create(bool raw = true);
+
+		virtual ~ZLibDecompressor() { }
+
+		// \brief Sets the next block of compressed data
+		//
+		// The data must stay valid until needs_input() returns true.
+		virtual void set_input(const void *data, int size) = 0;
+
+		// \brief Returns true when all data passed to set_input has been consumed
+		virtual bool needs_input() const = 0;
+
+		// \brief Returns true when the end of the compressed stream has been reached
+		virtual bool is_stream_end() const = 0;
+
+		// \brief Decompresses as much as possible into the output buffer
+		// \return Number of bytes written. Zero if more input is needed or the stream has ended.
+		virtual int decompress(void *output, int size) = 0;
+	};
 }
@@ -37,6 +37,7 @@ namespace uicore
 {
 	class Texture2D;
 	class GraphicContext;
+	class PixelBuffer;
 
 	/// \brief Image position in a TextureGroup
 	class TextureGroupImage
@@ -105,5 +106,23 @@ namespace uicore
 		/// \param texture = Texture to insert
 		/// \param texture_rect = Free space within the texture that the texture group can use
 		virtual void insert_texture(const std::shared_ptr<Texture2D> &texture, const Rect &texture_rect) = 0;
+
+		/// \brief Copies an image into a sub texture allocated by this group
+		///
+		/// The image is kept in system memory until flush_uploads() is called, which uploads all pending
+		/// images of a texture in as few transfers as possible. Textures added with insert_texture are updated immediately.
+		virtual void set_subimage(const std::shared_ptr<GraphicContext> &context, const TextureGroupImage &subtexture, const std::shared_ptr<PixelBuffer> &image) = 0;
+
+		/// \brief Returns true if set_subimage has images waiting for flush_uploads()
+		virtual bool has_pending_uploads() const = 0;
+
+		/// \brief Uploads the pending images to the textures
+		virtual void flush_uploads(const std::shared_ptr<GraphicContext> &context) = 0;
+
+		/// \brief Returns the amount of texture uploads performed by flush_uploads()
+		virtual int upload_count() const = 0;
+
+		/// \brief Returns the amount of images passed to set_subimage
+		virtual int uploaded_image_count() const = 0;
 	};
 }
@@ -134,6 +134,21 @@ namespace uicore
 		// Finds the offset for the first visible character when clipping the tail
 		size_t clip_from_right(const std::shared_ptr<Canvas> &canvas, const std::string &text, float width);
 
+		/// \brief Renders the glyphs for the characters on a background thread
+		///
+		/// The glyphs are added to the glyph atlas when first drawn, without rasterizing them on the calling thread.
+		virtual void prepare_glyphs(const std::shared_ptr<Canvas> &canvas, const std::string &characters) = 0;
+
+		/// \brief Saves the glyphs rendered so far to a cache file in the directory
+		///
+		/// The file name is derived from a hash of the font file, the font size and the pixel ratio of the canvas.
+		virtual void save_glyph_cache(const std::shared_ptr<Canvas> &canvas, const std::string &directory) = 0;
+
+		/// \brief Loads glyphs previously stored with save_glyph_cache
+		///
+		/// \return False if the directory had no cache file matching the font
+		virtual bool load_glyph_cache(const std::shared_ptr<Canvas> &canvas, const std::string &directory) = 0;
+
 		/// \brief Get the font handle interface
 		///
 		/// For example, use auto handle = dynamic_cast<FontHandle_Win32>(font.handle()); if (handle) {...} to obtain a specific interface
@@ -60,6 +60,12 @@ namespace uicore
 		/// \brief Returns if this image should be cached
 		bool is_cached() const;
 
+		/// \brief Returns the decode scale denominator
+		int decode_scale() const;
+
+		/// \brief Returns if a mipmap chain should be generated
+		bool mipmaps() const;
+
 		/// \brief Process the pixel buffers depending of the chosen settings
 		///
 		/// Note, the output may point to a different pixel buffer than the input\n
@@ -86,6 +92,19 @@ namespace uicore
 		/// (This defaults to true)
 		void set_cached(bool enable);
 
+		/// \brief Lets the image decoder produce a reduced size image directly
+		///
+		/// The image is decoded at 1/denominator of its size, rounded up. Valid values are 1, 2, 4 and 8.
+		/// Only JPEG images support this, other formats are loaded at full size.
+		/// (This defaults to 1)
+		void set_decode_scale(int denominator);
+
+		/// \brief Controls if textures created from the image get a full mipmap chain
+		///
+		/// The levels are downsampled on the CPU and uploaded together with the image.
+		/// (This defaults to off)
+		void set_mipmaps(bool enable);
+
 		/// \brief User defined fine control of the pixel buffer
 		///
 		/// Note, the output maybe different to the input, if desired
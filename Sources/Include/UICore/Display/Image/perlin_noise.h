@@ -84,6 +84,46 @@ namespace uicore
 		/// \param w_position = The w position of the noise
 		virtual std::shared_ptr<PixelBuffer> create_noise4d(float start_x, float end_x, float start_y, float end_y, float z_position, float w_position) = 0;
 
+		/// \brief Write the perlin noise into an existing pixelbuffer
+		///
+		/// The size and format of the target are used instead of size() and format().
+		/// Rows are generated in parallel, which makes this suitable for regenerating an animated noise texture every frame.
+		///
+		/// \param target = Pixelbuffer to write to (tf_rgba8, tf_rgb8, tf_r8 or tf_r32f)
+		/// \param start_x = Start x position of the noise
+		/// \param end_x = End x position of the noise
+		virtual void write_noise1d(const std::shared_ptr<PixelBuffer> &target, float start_x, float end_x) = 0;
+
+		/// \brief Write the perlin noise into an existing pixelbuffer
+		///
+		/// \param target = Pixelbuffer to write to (tf_rgba8, tf_rgb8, tf_r8 or tf_r32f)
+		/// \param start_x = Start x position of the noise
+		/// \param end_x = End x position of the noise
+		/// \param start_y = Start y position of the noise
+		/// \param end_y = End y position of the noise
+		virtual void write_noise2d(const std::shared_ptr<PixelBuffer> &target, float start_x, float end_x, float start_y, float end_y) = 0;
+
+		/// \brief Write the perlin noise into an existing pixelbuffer
+		///
+		/// \param target = Pixelbuffer to write to (tf_rgba8, tf_rgb8, tf_r8 or tf_r32f)
+		/// \param start_x = Start x position of the noise
+		/// \param end_x = End x position of the noise
+		/// \param start_y = Start y position of the noise
+		/// \param end_y = End y position of the noise
+		/// \param z_position = The z position of the noise
+		virtual void write_noise3d(const std::shared_ptr<PixelBuffer> &target, float start_x, float end_x, float start_y, float end_y, float z_position) = 0;
+
+		/// \brief Write the perlin noise into an existing pixelbuffer
+		///
+		/// \param target = Pixelbuffer to write to (tf_rgba8, tf_rgb8, tf_r8 or tf_r32f)
+		/// \param start_x = Start x position of the noise
+		/// \param end_x = End x position of the noise
+		/// \param start_y = Start y position of the noise
+		/// \param end_y = End y position of the noise
+		/// \param z_position = The z position of the noise
+		/// \param w_position = The w position of the noise
+		virtual void write_noise4d(const std::shared_ptr<PixelBuffer> &target, float start_x, float end_x, float start_y, float end_y, float z_position, float w_position) = 0;
+
 		/// \brief Get the size of the output pixelbuffer
 		virtual Size size() const = 0;
 
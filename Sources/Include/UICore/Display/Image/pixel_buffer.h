@@ -31,6 +31,7 @@
 #pragma once
 
 #include <memory>
+#include <cstdint>
 #include "../../Core/Math/rect.h"
 #include "texture_format.h"
 
@@ -46,6 +47,24 @@ namespace uicore
 	class GraphicContext;
 	class PixelConverter;
 
+	/// \brief Filters available when resampling a pixel buffer
+	enum ResampleFilter
+	{
+		resample_box,
+		resample_bilinear,
+		resample_mitchell,
+		resample_lanczos3
+	};
+
+	/// \brief Counters for the memory pool used by pixel buffers
+	struct PixelBufferPoolStatistics
+	{
+		int64_t allocations = 0;         // Pixel buffers allocated
+		int64_t reused = 0;              // Allocations served from the pool
+		int64_t system_allocations = 0;  // Allocations that needed new memory
+		int64_t pooled_bytes = 0;        // Memory kept for reuse
+	};
+
 	/// \brief Pixel data container.
 	class PixelBuffer
 	{
@@ -195,11 +214,19 @@ namespace uicore
 		void set_subimage(const std::shared_ptr<PixelBuffer> &source, const Point &dest_pos, const Rect &src_rect, const std::shared_ptr<PixelConverter> &converter);
 
 		/// \brief Converts current buffer to a new pixel format and returns the result.
+		///
+		/// Converting to or from the S3TC (DXT1, DXT3 and DXT5) formats encodes or decodes the image on the CPU.
 		std::shared_ptr<PixelBuffer> to_format(TextureFormat texture_format) const;
 
 		/// \brief Converts current buffer to a new pixel format and returns the result.
 		std::shared_ptr<PixelBuffer> to_format(TextureFormat texture_format, const std::shared_ptr<PixelConverter> &converter) const;
 
+		/// \brief Returns a copy of the image scaled to a new size
+		///
+		/// The image is filtered with premultiplied alpha, and sRGB formats are filtered in linear space.
+		/// Formats other than 8 bit RGBA, BGRA and 32 bit float RGBA are converted to float for the duration of the scaling.
+		std::shared_ptr<PixelBuffer> scaled(int width, int height, ResampleFilter filter = resample_mitchell) const;
+
 		/// \brief Flip the entire image vertically (turn it upside down)
 		void flip_vertical();
 
@@ -217,6 +244,17 @@ namespace uicore
 		/// Sets the display pixel ratio for this image.
 		virtual void set_pixel_ratio(float ratio) = 0;
 
+		/// \brief Returns the counters for the pixel buffer memory pool
+		///
+		/// Memory of released pixel buffers is kept by size class and reused by later allocations of similar size.
+		static PixelBufferPoolStatistics pool_statistics();
+
+		/// \brief Releases the memory kept by the pixel buffer pool
+		///
+		/// The shared pool and the cache of the calling thread are released immediately.
+		/// The caches of other threads are released the next time those threads allocate or free a pixel buffer.
+		static void purge_pool();
+
 		/// \brief Add a border around a pixelbuffer, duplicating the edge pixels
 		static std::shared_ptr<PixelBuffer> add_border(const std::shared_ptr<PixelBuffer> &pb, int border_size, const Rect &rect);
 	};
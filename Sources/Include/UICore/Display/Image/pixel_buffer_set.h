@@ -29,14 +29,14 @@
 #pragma once
 
 #include <memory>
+#include <future>
 #include "../../Core/Math/rect.h"
 #include "UICore/Display/Render/texture.h"
 #include "texture_format.h"
+#include "pixel_buffer.h"
 
 namespace uicore
 {
-	class PixelBuffer;
-
 	/// \brief Set of images that combined form a complete texture
 	class PixelBufferSet
 	{
@@ -47,6 +47,16 @@ namespace uicore
 		/// \brief Constructs an image set with a single image using the dimensions and internal format of the pixel buffer
 		static std::shared_ptr<PixelBufferSet> create(const std::shared_ptr<PixelBuffer> &image);
 
+		/// \brief Constructs an image set with the image as level 0, followed by downsampled levels down to 1x1
+		///
+		/// Each level is filtered from the previous one with premultiplied alpha. sRGB formats are filtered in linear space.
+		static std::shared_ptr<PixelBufferSet> create_mipmaps(const std::shared_ptr<PixelBuffer> &image, ResampleFilter filter = resample_box);
+
+		/// \brief Generates the mipmap chain on a worker thread
+		///
+		/// The image must not be modified until the future is ready.
+		static std::future<std::shared_ptr<PixelBufferSet>> create_mipmaps_async(const std::shared_ptr<PixelBuffer> &image, ResampleFilter filter = resample_box);
+
 		/// \brief Returns the texture dimensions used by the image set
 		virtual TextureDimensions dimensions() const = 0;
 
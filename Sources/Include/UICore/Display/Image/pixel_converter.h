@@ -60,6 +60,9 @@ namespace uicore
 		/// \brief Returns the JPEG JFIF YCrCb output setting
 		virtual bool output_is_ycrcb() const = 0;
 
+		/// \brief Returns the maximum number of threads used by convert
+		virtual int max_threads() const = 0;
+
 		/// \brief Set the premultiply alpha setting
 		///
 		/// This defaults to off.
@@ -87,6 +90,12 @@ namespace uicore
 		/// \brief Converts to JPEG JFIF YCrCb
 		virtual void set_output_is_ycrcb(bool enable) = 0;
 
+		/// \brief Set the maximum number of threads used by convert
+		///
+		/// Large images are split into row ranges converted in parallel. This defaults to 0, using one thread per CPU core.
+		/// Set to 1 to always convert on the calling thread.
+		virtual void set_max_threads(int max_threads) = 0;
+
 		/// \brief Convert some pixel data
 		virtual void convert(void *output, int output_pitch, TextureFormat output_format, const void *input, int input_pitch, TextureFormat input_format, int width, int height) = 0;
 	};
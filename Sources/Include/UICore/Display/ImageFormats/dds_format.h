@@ -29,6 +29,7 @@
 #pragma once
 
 #include "../Image/pixel_buffer_set.h"
+#include "image_file_info.h"
 
 namespace uicore
 {
@@ -38,7 +39,14 @@ namespace uicore
 	class DDSFormat
 	{
 	public:
-		static std::shared_ptr<PixelBufferSet> load(const std::string &filename);
-		static std::shared_ptr<PixelBufferSet> load(const std::shared_ptr<IODevice> &file);
+		/// \brief Loads the file
+		///
+		/// \param decompress Decode DXT1, DXT3 and DXT5 images to tf_rgba8, for contexts without S3TC support
+		static std::shared_ptr<PixelBufferSet> load(const std::string &filename, bool decompress = false);
+		static std::shared_ptr<PixelBufferSet> load(const std::shared_ptr<IODevice> &file, bool decompress = false);
+
+		/// \brief Reads the size and format of the top mipmap level from the file header
+		static ImageFileInfo probe(const std::string &filename, bool decompress = false);
+		static ImageFileInfo probe(const std::shared_ptr<IODevice> &file, bool decompress = false);
 	};
 }
@@ -29,13 +29,16 @@
 
 #pragma once
 
+#include "image_file_info.h"
 #include <map>
+#include <vector>
 
 namespace uicore
 {
 	class IODevice;
 	class PixelBuffer;
 	class ImageFileType;
+	class ImageImportDescription;
 
 	/// \brief Load or save an image
 	class ImageFile
@@ -46,6 +49,23 @@ namespace uicore
 		static std::shared_ptr<PixelBuffer> load(const std::string &filename, const std::string &type = std::string(), bool srgb = false);
 		static std::shared_ptr<PixelBuffer> load(const std::shared_ptr<IODevice> &file, const std::string &type, bool srgb = false);
 
+		/// \brief Loads an image using the decoding settings of an import description, such as sRGB and decode scale
+		///
+		/// The import description is not used to process the loaded image.
+		static std::shared_ptr<PixelBuffer> load(const std::string &filename, const ImageImportDescription &import_desc, const std::string &type = std::string());
+		static std::shared_ptr<PixelBuffer> load(const std::shared_ptr<IODevice> &file, const std::string &type, const ImageImportDescription &import_desc);
+
+		/// \brief Reads the dimensions and format of an image without decoding it
+		///
+		/// Only the headers at the start of the file are read. DDS files are recognized in addition to the registered image types.
+		static ImageFileInfo probe(const std::string &filename, const std::string &type = std::string(), bool srgb = false);
+		static ImageFileInfo probe(const std::shared_ptr<IODevice> &file, const std::string &type, bool srgb = false);
+
+		/// \brief Probes all image files in a directory on the shared thread pool
+		///
+		/// Files with an unknown extension or a header that could not be read are left out. The result is sorted by pathname.
+		static std::vector<std::pair<std::string, ImageFileInfo>> probe_directory(const std::string &path, bool srgb = false);
+
 		static void save(std::shared_ptr<PixelBuffer> buffer, const std::string &filename, const std::string &type = std::string());
 		static void save(std::shared_ptr<PixelBuffer> buffer, const std::shared_ptr<IODevice> &file, const std::string &type);
 	};
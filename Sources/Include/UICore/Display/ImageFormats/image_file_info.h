@@ -0,0 +1,56 @@
+/*
+**  UICore
+**  Copyright (c) 1997-2015 The UICore Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries UICore may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include "../Image/texture_format.h"
+
+namespace uicore
+{
+	/// \brief Image properties read from the header of an image file
+	class ImageFileInfo
+	{
+	public:
+		ImageFileInfo() { }
+		ImageFileInfo(int width, int height, TextureFormat format, float pixel_ratio = 0.0f) : width(width), height(height), format(format), pixel_ratio(pixel_ratio) { }
+
+		/// \brief Width of the image in pixels
+		int width = 0;
+
+		/// \brief Height of the image in pixels
+		int height = 0;
+
+		/// \brief Format of the pixel buffer returned when the image is loaded
+		TextureFormat format = tf_rgba8;
+
+		/// \brief Pixel ratio stored in the file
+		///
+		/// A zero value implies that the file does not specify a pixel ratio, as with PixelBuffer::pixel_ratio().
+		float pixel_ratio = 0.0f;
+	};
+}
@@ -29,6 +29,8 @@
 #pragma once
 
 #include "../Image/pixel_buffer.h"
+#include "../Image/image_import_description.h"
+#include "image_file_info.h"
 
 namespace uicore
 {
@@ -48,6 +50,14 @@ namespace uicore
 		virtual std::shared_ptr<PixelBuffer> load(const std::string &filename, bool srgb) = 0;
 		virtual std::shared_ptr<PixelBuffer> load(const std::shared_ptr<IODevice> &file, bool srgb) = 0;
 
+		/// \brief Called to load an image using the decoding settings of an import description.
+		virtual std::shared_ptr<PixelBuffer> load(const std::shared_ptr<IODevice> &file, const ImageImportDescription &import_desc);
+
+		/// \brief Called to read the image properties from the header of a file.
+		///
+		/// The default implementation loads the whole image. Providers able to read the header alone should override it.
+		virtual ImageFileInfo probe(const std::shared_ptr<IODevice> &file, bool srgb);
+
 		/// \brief Called to save a given PixelBuffer to a file
 		virtual void save(std::shared_ptr<PixelBuffer> buffer, const std::string &filename) = 0;
 		virtual void save(std::shared_ptr<PixelBuffer> buffer, const std::shared_ptr<IODevice> &file) = 0;
@@ -52,6 +52,16 @@ namespace uicore
 			return ProviderClass::load(file, srgb);
 		}
 
+		virtual std::shared_ptr<PixelBuffer> load(const std::shared_ptr<IODevice> &file, const ImageImportDescription &import_desc) override
+		{
+			return ProviderClass::load(file, import_desc);
+		}
+
+		virtual ImageFileInfo probe(const std::shared_ptr<IODevice> &file, bool srgb) override
+		{
+			return probe_provider<ProviderClass>(file, srgb, 0);
+		}
+
 		virtual void save(std::shared_ptr<PixelBuffer> buffer, const std::string &filename) override
 		{
 			ProviderClass::save(buffer, filename);
@@ -61,5 +71,19 @@ namespace uicore
 		{
 			ProviderClass::save(buffer, file);
 		}
+
+	private:
+		// Providers without a static probe function fall back to the ImageFileType implementation
+		template<class T>
+		auto probe_provider(const std::shared_ptr<IODevice> &file, bool srgb, int) -> decltype(T::probe(file, srgb))
+		{
+			return T::probe(file, srgb);
+		}
+
+		template<class T>
+		ImageFileInfo probe_provider(const std::shared_ptr<IODevice> &file, bool srgb, long)
+		{
+			return ImageFileType::probe(file, srgb);
+		}
 	};
 }
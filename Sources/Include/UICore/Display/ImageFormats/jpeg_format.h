@@ -29,11 +29,32 @@
 #pragma once
 
 #include "../Image/pixel_buffer.h"
+#include "../Image/image_import_description.h"
+#include "image_file_info.h"
+#include <functional>
 
 namespace uicore
 {
 	class IODevice;
 
+	/// \brief JPEG encoder settings. Used with JPEGFormat::save().
+	class JPEGSaveSettings
+	{
+	public:
+		explicit JPEGSaveSettings(int quality = 85) : quality(quality) { }
+
+		/// \brief Quality from 1 to 100
+		int quality;
+
+		/// \brief Number of MCU rows (8 or 16 pixel rows) between restart markers
+		///
+		/// When nonzero, the restart intervals are encoded in parallel and concatenated. 0 encodes the image as a single interval.
+		int restart_rows = 0;
+
+		/// \brief Gather symbol statistics in a first pass and write optimized Huffman tables
+		bool optimize_huffman = false;
+	};
+
 	/// \brief Image provider that can load JPEG (.jpg) files.
 	class JPEGFormat
 	{
@@ -41,7 +62,24 @@ namespace uicore
 		static std::shared_ptr<PixelBuffer> load(const std::string &filename, bool srgb = false);
 		static std::shared_ptr<PixelBuffer> load(const std::shared_ptr<IODevice> &file, bool srgb = false);
 
+		/// \brief Loads the image using the decoding settings of the import description
+		///
+		/// A decode scale of 2, 4 or 8 performs a reduced size IDCT and returns the image at 1/2, 1/4 or 1/8 size.
+		static std::shared_ptr<PixelBuffer> load(const std::shared_ptr<IODevice> &file, const ImageImportDescription &import_desc);
+
+		/// \brief Loads the image and reports the partially decoded image after each progressive scan
+		///
+		/// The callback receives the same pixel buffer after every scan, allowing a coarse preview to be shown while the rest of the file is decoded.
+		/// It is not invoked for baseline (sequential) images.
+		static std::shared_ptr<PixelBuffer> load(const std::shared_ptr<IODevice> &file, const ImageImportDescription &import_desc, const std::function<void(const std::shared_ptr<PixelBuffer> &image)> &scan_callback);
+
+		/// \brief Reads the image size and format from the file header without decoding the image
+		static ImageFileInfo probe(const std::string &filename, bool srgb = false);
+		static ImageFileInfo probe(const std::shared_ptr<IODevice> &file, bool srgb = false);
+
 		static void save(std::shared_ptr<PixelBuffer> buffer, const std::string &filename, int quality = 85);
 		static void save(std::shared_ptr<PixelBuffer> buffer, const std::shared_ptr<IODevice> &file, int quality = 85);
+		static void save(std::shared_ptr<PixelBuffer> buffer, const std::string &filename, const JPEGSaveSettings &settings);
+		static void save(std::shared_ptr<PixelBuffer> buffer, const std::shared_ptr<IODevice> &file, const JPEGSaveSettings &settings);
 	};
 }
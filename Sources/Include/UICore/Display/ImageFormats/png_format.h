@@ -29,6 +29,9 @@
 #pragma once
 
 #include "../Image/pixel_buffer.h"
+#include "../Image/image_import_description.h"
+#include "image_file_info.h"
+#include <functional>
 
 namespace uicore
 {
@@ -38,8 +41,23 @@ namespace uicore
 	public:
 		static std::shared_ptr<PixelBuffer> load(const std::string &filename, bool srgb = false);
 		static std::shared_ptr<PixelBuffer> load(const std::shared_ptr<IODevice> &device, bool srgb = false);
+		static std::shared_ptr<PixelBuffer> load(const std::shared_ptr<IODevice> &device, const ImageImportDescription &import_desc);
 
-		static void save(std::shared_ptr<PixelBuffer> buffer, const std::string &filename);
-		static void save(std::shared_ptr<PixelBuffer> buffer, const std::shared_ptr<IODevice> &iodev);
+		/// \brief Decodes the image one row at a time without keeping the whole image in memory
+		///
+		/// The callback is invoked once for each row, top to bottom, with a pixel buffer containing only that row.
+		/// The scanline buffer is reused between calls. Interlaced images are decoded fully before the rows are delivered.
+		static void load_scanlines(const std::shared_ptr<IODevice> &device, const std::function<void(const Size &image_size, int y, const std::shared_ptr<PixelBuffer> &scanline)> &callback, bool srgb = false);
+
+		/// \brief Reads the image size and format from the file header without decoding the image
+		static ImageFileInfo probe(const std::string &filename, bool srgb = false);
+		static ImageFileInfo probe(const std::shared_ptr<IODevice> &file, bool srgb = false);
+
+		/// \brief Saves the image as PNG
+		///
+		/// When multithreaded is true the image data is deflated in blocks on the shared thread pool. The output is still a valid PNG,
+		/// but it is not byte identical to a single threaded save and can be slightly larger.
+		static void save(std::shared_ptr<PixelBuffer> buffer, const std::string &filename, bool multithreaded = false);
+		static void save(std::shared_ptr<PixelBuffer> buffer, const std::shared_ptr<IODevice> &iodev, bool multithreaded = false);
 	};
 }
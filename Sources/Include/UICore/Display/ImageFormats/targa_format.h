@@ -29,6 +29,8 @@
 #pragma once
 
 #include "../Image/pixel_buffer.h"
+#include "../Image/image_import_description.h"
+#include "image_file_info.h"
 
 namespace uicore
 {
@@ -38,6 +40,11 @@ namespace uicore
 	public:
 		static std::shared_ptr<PixelBuffer> load(const std::string &filename, bool srgb = false);
 		static std::shared_ptr<PixelBuffer> load(const std::shared_ptr<IODevice> &file, bool srgb = false);
+		static std::shared_ptr<PixelBuffer> load(const std::shared_ptr<IODevice> &file, const ImageImportDescription &import_desc);
+
+		/// \brief Reads the image size and format from the file header without decoding the image
+		static ImageFileInfo probe(const std::string &filename, bool srgb = false);
+		static ImageFileInfo probe(const std::shared_ptr<IODevice> &file, bool srgb = false);
 
 		static void save(std::shared_ptr<PixelBuffer> buffer, const std::string &filename);
 		static void save(std::shared_ptr<PixelBuffer> buffer, const std::shared_ptr<IODevice> &file);
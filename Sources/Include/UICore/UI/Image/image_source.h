@@ -30,6 +30,7 @@
 
 #include <memory>
 #include <functional>
+#include "../../Core/Signals/signal.h"
 
 namespace uicore
 {
@@ -44,7 +45,18 @@ namespace uicore
 		static std::shared_ptr<ImageSource> from_callback(const std::function<std::shared_ptr<Image>(const std::shared_ptr<Canvas> &)> &get_image_callback);
 		static std::shared_ptr<ImageSource> from_image(const std::shared_ptr<Image> &image);
 
+		/// \brief Loads the resource on a worker thread, returning the placeholder image until it is ready
+		///
+		/// Loading begins the first time image() is called and is cancelled if the source is destroyed before it completes.
+		static std::shared_ptr<ImageSource> from_resource_async(const std::string &resource_name, const std::shared_ptr<Image> &placeholder = nullptr);
+
+		/// \brief Emitted when image() starts returning a different image
+		Signal<void()> &sig_image_changed() { return image_changed; }
+
 	protected:
 		virtual ~ImageSource() { }
+
+	private:
+		Signal<void()> image_changed;
 	};
 }
@@ -29,6 +29,8 @@
 #pragma once
 
 #include <functional>
+#include <cstdint>
+#include "../../Core/Signals/signal.h"
 
 namespace uicore
 {
@@ -37,6 +39,16 @@ namespace uicore
 	class FontDescription;
 	class Canvas;
 
+	/// \brief Usage statistics for the UIThread image cache
+	struct ImageCacheStatistics
+	{
+		int64_t hits = 0;
+		int64_t misses = 0;
+		int64_t evictions = 0;
+		int64_t size = 0;  // Estimated texture memory in bytes
+		int count = 0;
+	};
+
 	class UIThread
 	{
 	public:
@@ -46,6 +58,28 @@ namespace uicore
 		static void set_resource_path(const std::string &path);
 
 		static std::shared_ptr<Image> image(const std::shared_ptr<Canvas> &canvas, const std::string &name);
+
+		/// \brief Loads an image without blocking the UI thread
+		///
+		/// The file is read, decoded and converted on the thread pool. The texture is then uploaded on the UI thread
+		/// in slices spread over several message loop iterations, after which the callback is invoked.
+		/// If the image is already cached the callback is invoked immediately.
+		/// If the image could not be loaded the callback is invoked with a null image, after which the error is passed to the exception handler.
+		///
+		/// The load is cancelled when all slots returned for the image have been destroyed.
+		static Slot image_async(const std::shared_ptr<Canvas> &canvas, const std::string &name, const std::function<void(const std::shared_ptr<Image> &)> &loaded);
+		/// \brief Maximum estimated texture memory kept by the image cache
+		///
+		/// When the budget is exceeded the least recently used images not referenced outside the cache are evicted.
+		/// (This defaults to 128 MB)
+		static int64_t image_cache_budget();
+		static void set_image_cache_budget(int64_t bytes);
+
+		static ImageCacheStatistics image_cache_statistics();
+
+		/// \brief Removes all cached images not referenced outside the cache
+		static void purge_image_cache();
+
 		static std::shared_ptr<Font> font(const std::string &family, const FontDescription &desc);
 
 		static void set_exception_handler(const std::function<void(const std::exception_ptr &)> &exception_handler);
@@ -46,6 +46,7 @@
 #include "Core/IOData/endian.h"
 #include "Core/IOData/iodevice.h"
 #include "Core/IOData/memory_device.h"
+#include "Core/IOData/mapped_file.h"
 #include "Core/IOData/file.h"
 #include "Core/IOData/path_help.h"
 #include "Core/IOData/directory.h"
@@ -56,6 +56,7 @@
 #include "Display/ImageFormats/jpeg_format.h"
 #include "Display/ImageFormats/png_format.h"
 #include "Display/ImageFormats/image_file.h"
+#include "Display/ImageFormats/image_file_info.h"
 #include "Display/ImageFormats/image_file_type.h"
 #include "Display/ImageFormats/image_file_type_register.h"
 #include "Display/ImageFormats/targa_format.h"
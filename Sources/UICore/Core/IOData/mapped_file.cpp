@@ -0,0 +1,211 @@
+/*
+**  UICore
+**  Copyright (c) 1997-2015 The UICore Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries UICore may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "UICore/precomp.h"
+#include "UICore/Core/IOData/mapped_file.h"
+#include "UICore/Core/IOData/file.h"
+#include "UICore/Core/System/exception.h"
+#include "UICore/Core/Text/text.h"
+#if !defined(WIN32)
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#include <string.h>
+#include <vector>
+
+namespace uicore
+{
+	class MappedFileImpl : public MappedFile
+	{
+	public:
+		MappedFileImpl() { }
+		~MappedFileImpl() { unmap(); }
+
+		char *data() override { return mapped_data ? mapped_data : heap.data(); }
+		const char *data() const override { return mapped_data ? mapped_data : heap.data(); }
+		size_t size() const override { return data_size; }
+		size_t capacity() const override { return mapped_data ? mapped_size : heap.capacity(); }
+		bool is_mapped() const override { return mapped_data != nullptr; }
+
+		void set_size(size_t size) override
+		{
+			if (size > capacity())
+				set_capacity(size);
+
+			if (!mapped_data)
+				heap.resize(size);
+			data_size = size;
+		}
+
+		void set_capacity(size_t capacity) override
+		{
+			if (mapped_data)
+			{
+				if (capacity <= mapped_size)
+					return;
+
+				std::vector<char> buffer;
+				buffer.reserve(capacity);
+				buffer.insert(buffer.end(), mapped_data, mapped_data + data_size);
+				unmap();
+				heap.swap(buffer);
+			}
+			else
+			{
+				heap.reserve(capacity);
+			}
+		}
+
+		std::shared_ptr<DataBuffer> copy(size_t pos, size_t size) override { return DataBuffer::create(data() + pos, size); }
+
+		void map(const std::string &filename);
+		void unmap();
+
+		MappedFileImpl(const MappedFileImpl &) = delete;
+		MappedFileImpl &operator=(const MappedFileImpl &) = delete;
+
+	private:
+		char *mapped_data = nullptr;
+		size_t mapped_size = 0;
+		size_t data_size = 0;
+		std::vector<char> heap;
+	};
+
+#if defined(WIN32)
+
+	void MappedFileImpl::map(const std::string &filename)
+	{
+		HANDLE file = CreateFile(Text::to_utf16(filename).c_str(), FILE_READ_ACCESS, FILE_SHARE_READ, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+		if (file == INVALID_HANDLE_VALUE)
+			throw Exception("Could not open existing file: " + filename);
+
+		LARGE_INTEGER size;
+		size.QuadPart = 0;
+		if (GetFileSizeEx(file, &size) == FALSE || (unsigned long long)size.QuadPart >= (unsigned long long)(((size_t)-1) / 2))
+		{
+			CloseHandle(file);
+			throw Exception("Could not map file: " + filename);
+		}
+
+		if (size.QuadPart == 0) // Empty files cannot be mapped
+		{
+			CloseHandle(file);
+			return;
+		}
+
+		HANDLE mapping = CreateFileMapping(file, 0, PAGE_WRITECOPY, 0, 0, 0);
+		CloseHandle(file);
+		if (mapping == 0)
+			throw Exception("Could not map file: " + filename);
+
+		void *view = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+		CloseHandle(mapping);
+		if (view == nullptr)
+			throw Exception("Could not map file: " + filename);
+
+		mapped_data = static_cast<char*>(view);
+		mapped_size = (size_t)size.QuadPart;
+		data_size = mapped_size;
+	}
+
+	void MappedFileImpl::unmap()
+	{
+		if (mapped_data)
+		{
+			UnmapViewOfFile(mapped_data);
+			mapped_data = nullptr;
+			mapped_size = 0;
+		}
+	}
+
+#else
+
+	void MappedFileImpl::map(const std::string &filename)
+	{
+		int handle = ::open(filename.c_str(), O_RDONLY, 0);
+		if (handle == -1)
+			throw Exception("Could not open existing file: " + filename);
+
+		struct stat file_stat;
+		if (fstat(handle, &file_stat) == -1 || (unsigned long long)file_stat.st_size >= (unsigned long long)(((size_t)-1) / 2))
+		{
+			::close(handle);
+			throw Exception("Could not map file: " + filename);
+		}
+
+		if (file_stat.st_size == 0) // Empty files cannot be mapped
+		{
+			::close(handle);
+			return;
+		}
+
+		void *view = mmap(nullptr, (size_t)file_stat.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, handle, 0);
+		::close(handle);
+		if (view == MAP_FAILED)
+			throw Exception("Could not map file: " + filename);
+
+		mapped_data = static_cast<char*>(view);
+		mapped_size = (size_t)file_stat.st_size;
+		data_size = mapped_size;
+	}
+
+	void MappedFileImpl::unmap()
+	{
+		if (mapped_data)
+		{
+			munmap(mapped_data, mapped_size);
+			mapped_data = nullptr;
+			mapped_size = 0;
+		}
+	}
+
+#endif
+
+	std::shared_ptr<MappedFile> MappedFile::open(const std::string &filename)
+	{
+		auto file = std::make_shared<MappedFileImpl>();
+		file->map(filename);
+		return file;
+	}
+
+	std::shared_ptr<DataBuffer> MappedFile::open_or_read(const std::string &filename, size_t min_mapped_size)
+	{
+		auto file = File::open_existing(filename);
+		long long size = file->size();
+		if (size >= (long long)min_mapped_size)
+			return open(filename);
+
+		auto buffer = DataBuffer::create((size_t)size);
+		if (buffer->size() > 0)
+			file->read(buffer->data(), buffer->size());
+		return buffer;
+	}
+}
@@ -64,6 +64,16 @@ namespace uicore
 			return size;
 		}
 
+		const void *try_read_in_place(int size) override
+		{
+			if (size < 0 || size > (long long)_buffer->size() - _pos)
+				return nullptr;
+
+			const char *data = _buffer->data() + _pos;
+			_pos += size;
+			return data;
+		}
+
 		void write(const void *data, int size) override
 		{
 			if (size < 0)
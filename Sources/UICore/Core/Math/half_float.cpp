@@ -28,6 +28,11 @@
 
 #include "UICore/precomp.h"
 #include "UICore/Core/Math/half_float.h"
+#include "UICore/Core/System/system.h"
+
+#if !defined __ANDROID__ && ! defined CL_DISABLE_SSE2
+#include <immintrin.h>
+#endif
 
 namespace uicore
 {
@@ -2186,37 +2191,37 @@ namespace uicore
 		1024,
 		1024,
 		0,
-		0,
-		0,
-		0,
-		0,
-		0,
-		0,
-		0,
-		0,
-		0,
-		0,
-		0,
-		0,
-		0,
-		0,
-		0,
-		0,
-		0,
-		0,
-		0,
-		0,
-		0,
-		0,
-		0,
-		0,
-		0,
-		0,
-		0,
-		0,
-		0,
-		0,
-		0,
+		1024,
+		1024,
+		1024,
+		1024,
+		1024,
+		1024,
+		1024,
+		1024,
+		1024,
+		1024,
+		1024,
+		1024,
+		1024,
+		1024,
+		1024,
+		1024,
+		1024,
+		1024,
+		1024,
+		1024,
+		1024,
+		1024,
+		1024,
+		1024,
+		1024,
+		1024,
+		1024,
+		1024,
+		1024,
+		1024,
+		1024,
 	};
 
 	unsigned short HalfFloat::base_table[512] =
@@ -3251,6 +3256,111 @@ namespace uicore
 		13,
 	};
 
+#if !defined __ANDROID__ && ! defined CL_DISABLE_SSE2 && (defined(_MSC_VER) || defined(__F16C__) || defined(__GNUC__))
+#define USE_F16C
+#if defined(_MSC_VER) || defined(__F16C__)
+#define F16C_TARGET
+#else
+#define F16C_TARGET __attribute__((target("f16c")))
+#endif
+
+	namespace
+	{
+		F16C_TARGET void half_to_float_array_f16c(const HalfFloat *input, float *output, int count)
+		{
+			int avx_length = (count / 8) * 8;
+			for (int i = 0; i < avx_length; i += 8)
+			{
+				__m128i half8 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i));
+				_mm256_storeu_ps(output + i, _mm256_cvtph_ps(half8));
+
+				// The hardware quiets signaling NaNs, while the lookup tables keep the payload unchanged
+				__m128i nan_mask = _mm_cmpgt_epi16(_mm_and_si128(half8, _mm_set1_epi16(0x7fff)), _mm_set1_epi16(0x7c00));
+				if (_mm_movemask_epi8(nan_mask) != 0)
+				{
+					for (int j = i; j < i + 8; j++)
+						output[j] = input[j].to_float();
+				}
+			}
+			for (int i = avx_length; i < count; i++)
+				output[i] = input[i].to_float();
+		}
+
+		// Lanes that the lookup tables map to infinity: magnitudes of 65536 and above, and NaN.
+		// Returns the table result for those lanes as sign-extended 32-bit values, and the lane mask in out_mask
+		F16C_TARGET __m128i float_to_half_overflow(__m128i bits, __m128i &out_mask)
+		{
+			__m128i abs_bits = _mm_and_si128(bits, _mm_set1_epi32(0x7fffffff));
+			out_mask = _mm_cmpgt_epi32(abs_bits, _mm_set1_epi32(0x477fffff));
+			__m128i nan_mask = _mm_cmpgt_epi32(abs_bits, _mm_set1_epi32(0x7f800000));
+
+			__m128i sign = _mm_and_si128(_mm_srli_epi32(bits, 16), _mm_set1_epi32(0x8000));
+			__m128i nan_mantissa = _mm_and_si128(_mm_and_si128(_mm_srli_epi32(abs_bits, 13), _mm_set1_epi32(0x03ff)), nan_mask);
+			__m128i half = _mm_or_si128(_mm_or_si128(sign, _mm_set1_epi32(0x7c00)), nan_mantissa);
+			return _mm_srai_epi32(_mm_slli_epi32(half, 16), 16);
+		}
+
+		// Rounds towards zero like the lookup tables do. The hardware saturates finite values that are too large
+		// to 65504 and quiets NaNs, so those lanes are replaced with the table results
+		F16C_TARGET void float_to_half_array_f16c(const float *input, HalfFloat *output, int count)
+		{
+			int avx_length = (count / 8) * 8;
+			for (int i = 0; i < avx_length; i += 8)
+			{
+				__m256 values = _mm256_loadu_ps(input + i);
+				__m128i half8 = _mm256_cvtps_ph(values, _MM_FROUND_TO_ZERO);
+
+				__m128i mask_lo, mask_hi;
+				__m128i overflow_lo = float_to_half_overflow(_mm_castps_si128(_mm256_castps256_ps128(values)), mask_lo);
+				__m128i overflow_hi = float_to_half_overflow(_mm_castps_si128(_mm256_extractf128_ps(values, 1)), mask_hi);
+				__m128i mask = _mm_packs_epi32(mask_lo, mask_hi);
+				if (_mm_movemask_epi8(mask) != 0)
+				{
+					__m128i overflow = _mm_packs_epi32(overflow_lo, overflow_hi);
+					half8 = _mm_or_si128(_mm_andnot_si128(mask, half8), _mm_and_si128(mask, overflow));
+				}
+
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(output + i), half8);
+			}
+			for (int i = avx_length; i < count; i++)
+				output[i].from_float(input[i]);
+		}
+
+		bool use_f16c()
+		{
+			static bool f16c = System::detect_cpu_extension(System::f16c);
+			return f16c;
+		}
+	}
+#endif
+
+	void HalfFloat::to_float_array(const HalfFloat *input, float *output, int count)
+	{
+#ifdef USE_F16C
+		if (use_f16c())
+		{
+			half_to_float_array_f16c(input, output, count);
+			return;
+		}
+#endif
+		for (int i = 0; i < count; i++)
+			output[i] = input[i].to_float();
+	}
+
+	void HalfFloat::from_float_array(const float *input, HalfFloat *output, int count)
+	{
+#ifdef USE_F16C
+		if (use_f16c())
+		{
+			float_to_half_array_f16c(input, output, count);
+			return;
+		}
+#endif
+		for (int i = 0; i < count; i++)
+			output[i].from_float(input[i]);
+	}
+
+
 	/*
 
 	void generate_tables()
@@ -3294,7 +3404,10 @@ namespace uicore
 		offset_table[0] = 0;
 		offset_table[32] = 0;
 		for (int i = 1; i < 32; i++)
+		{
 			offset_table[i] = 1024;
+			offset_table[i + 32] = 1024;
+		}
 
 		for(unsigned int i=0; i<256; ++i)
 		{
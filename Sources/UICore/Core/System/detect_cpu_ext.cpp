@@ -54,6 +54,8 @@ namespace uicore
 
 #define __cpuid(out, infoType)\
 	asm("cpuid": "=a" ((out)[0]), "=b" ((out)[1]), "=c" ((out)[2]), "=d" ((out)[3]): "a" (infoType));
+#define __cpuidex(out, infoType, subLeaf)\
+	asm("cpuid": "=a" ((out)[0]), "=b" ((out)[1]), "=c" ((out)[2]), "=d" ((out)[3]): "a" (infoType), "c" (subLeaf));
 #else
 
 #define __cpuid(out, infoType) \
@@ -62,10 +64,37 @@ namespace uicore
 			"movl %%ebx, %1 \n" \
 			"popl %%ebx" \
 		: "=a" ((out)[0]), "=r" ((out)[1]), "=c" ((out)[2]), "=d" ((out)[3]): "a" (infoType));
+#define __cpuidex(out, infoType, subLeaf) \
+	asm volatile(	"pushl %%ebx \n" \
+			"cpuid \n" \
+			"movl %%ebx, %1 \n" \
+			"popl %%ebx" \
+		: "=a" ((out)[0]), "=r" ((out)[1]), "=c" ((out)[2]), "=d" ((out)[3]): "a" (infoType), "c" (subLeaf));
+
+#endif
 
 #endif
 
+	namespace
+	{
+		// AVX encoded instructions raise #UD unless the OS saves the YMM registers on context switches (XCR0 bits 1 and 2)
+		bool os_saves_ymm_state()
+		{
+			unsigned int cpuinfo[4] = { 0 };
+			__cpuid((int*)cpuinfo, 0x1);
+			if ((cpuinfo[2] & (1 << 27)) == 0) // OSXSAVE
+				return false;
+
+#ifdef __GNUC__
+			unsigned int xcr0_low, xcr0_high;
+			asm volatile("xgetbv" : "=a" (xcr0_low), "=d" (xcr0_high) : "c" (0));
+			unsigned long long xcr0 = ((unsigned long long)xcr0_high << 32) | xcr0_low;
+#else
+			unsigned long long xcr0 = _xgetbv(0);
 #endif
+			return (xcr0 & 6) == 6;
+		}
+	}
 
 	bool System::detect_cpu_extension(CPU_ExtensionPPC ext)
 	{
@@ -160,7 +189,7 @@ namespace uicore
 		else if (ext == avx)
 		{
 			__cpuid((int*)cpuinfo, 0x1);
-			return ((cpuinfo[2] & (1 << 28)) != 0);
+			return ((cpuinfo[2] & (1 << 28)) != 0) && os_saves_ymm_state();
 		}
 		else if (ext == aes)
 		{
@@ -181,6 +210,20 @@ namespace uicore
 			__cpuid((int*)cpuinfo, 0x80000001);
 			return ((cpuinfo[2] & (1 << 16)) != 0);
 		}
+		else if (ext == avx2)
+		{
+			__cpuid((int*)cpuinfo, 0x0);
+			if (cpuinfo[0] < 0x7)
+				return false;
+
+			__cpuidex((int*)cpuinfo, 0x7, 0x0);
+			return ((cpuinfo[1] & (1 << 5)) != 0) && os_saves_ymm_state();
+		}
+		else if (ext == f16c)
+		{
+			__cpuid((int*)cpuinfo, 0x1);
+			return ((cpuinfo[2] & (1 << 29)) != 0) && os_saves_ymm_state();
+		}
 		return false;
 	}
 
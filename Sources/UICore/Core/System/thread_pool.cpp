@@ -0,0 +1,161 @@
+/*
+**  UICore
+**  Copyright (c) 1997-2015 The UICore Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries UICore may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "UICore/precomp.h"
+#include "UICore/Core/System/system.h"
+#include "thread_pool.h"
+#include <atomic>
+#include <exception>
+#include <algorithm>
+
+namespace uicore
+{
+	ThreadPool::ThreadPool(int num_threads)
+	{
+		for (int i = 0; i < num_threads; i++)
+			threads.push_back(std::thread(&ThreadPool::worker_main, this));
+	}
+
+	ThreadPool::~ThreadPool()
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		stop_flag = true;
+		lock.unlock();
+		worker_event.notify_all();
+
+		for (auto &thread : threads)
+			thread.join();
+	}
+
+	ThreadPool &ThreadPool::shared()
+	{
+		static ThreadPool pool(std::max(System::num_cores() - 1, 1));
+		return pool;
+	}
+
+	void ThreadPool::queue(std::function<void()> task)
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		tasks.push_back(std::move(task));
+		lock.unlock();
+		worker_event.notify_one();
+	}
+
+	void ThreadPool::worker_main()
+	{
+		while (true)
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			worker_event.wait(lock, [&]() { return stop_flag || !tasks.empty(); });
+			if (stop_flag)
+				break;
+
+			std::function<void()> task = std::move(tasks.front());
+			tasks.pop_front();
+			lock.unlock();
+
+			task();
+		}
+	}
+
+	void ThreadPool::parallel_for(int count, int min_batch_size, const std::function<void(int begin, int end)> &func, int max_threads)
+	{
+		if (count <= 0)
+			return;
+
+		int num_threads = thread_count() + 1;
+		if (max_threads > 0)
+			num_threads = std::min(num_threads, max_threads);
+
+		int batch_size = std::max(min_batch_size, 1);
+		int num_batches = (count + batch_size - 1) / batch_size;
+		if (num_threads <= 1 || num_batches <= 1)
+		{
+			func(0, count);
+			return;
+		}
+
+		// Spread the work evenly over up to four batches per thread, so a slow thread does not delay the rest
+		num_batches = std::min(num_batches, num_threads * 4);
+		batch_size = (count + num_batches - 1) / num_batches;
+		num_batches = (count + batch_size - 1) / batch_size;
+
+		struct Work
+		{
+			std::function<void(int, int)> func;
+			int count, batch_size, num_batches;
+			std::atomic<int> next_batch;
+			std::mutex mutex;
+			std::condition_variable finished_event;
+			int finished_batches = 0;
+			std::exception_ptr exception;
+
+			void run()
+			{
+				while (true)
+				{
+					int batch = next_batch++;
+					if (batch >= num_batches)
+						break;
+
+					try
+					{
+						func(batch * batch_size, std::min((batch + 1) * batch_size, count));
+					}
+					catch (...)
+					{
+						std::unique_lock<std::mutex> lock(mutex);
+						if (!exception)
+							exception = std::current_exception();
+					}
+
+					std::unique_lock<std::mutex> lock(mutex);
+					if (++finished_batches == num_batches)
+						finished_event.notify_all();
+				}
+			}
+		};
+
+		auto work = std::make_shared<Work>();
+		work->func = func;
+		work->count = count;
+		work->batch_size = batch_size;
+		work->num_batches = num_batches;
+		work->next_batch = 0;
+
+		for (int i = 1; i < std::min(num_threads, num_batches); i++)
+			queue([work]() { work->run(); });
+
+		work->run();
+
+		std::unique_lock<std::mutex> lock(work->mutex);
+		work->finished_event.wait(lock, [&]() { return work->finished_batches == work->num_batches; });
+		if (work->exception)
+			std::rethrow_exception(work->exception);
+	}
+}
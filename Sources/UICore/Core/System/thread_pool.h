@@ -0,0 +1,74 @@
+/*
+**  UICore
+**  Copyright (c) 1997-2015 The UICore Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries UICore may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include <functional>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+
+namespace uicore
+{
+	/// \brief Worker threads for splitting up CPU heavy work
+	class ThreadPool
+	{
+	public:
+		ThreadPool(int num_threads);
+		~ThreadPool();
+
+		/// \brief Pool with one worker per CPU core, shared by the library
+		static ThreadPool &shared();
+
+		/// \brief Number of worker threads
+		int thread_count() const { return (int)threads.size(); }
+
+		/// \brief Runs a task on one of the worker threads
+		void queue(std::function<void()> task);
+
+		/// \brief Calls func(begin, end) for ranges covering [0, count) and waits for all of them to finish
+		///
+		/// The calling thread processes ranges too, which makes it safe to call from a task running in the pool.
+		/// Exceptions thrown by func are rethrown on the calling thread.
+		void parallel_for(int count, int min_batch_size, const std::function<void(int begin, int end)> &func, int max_threads = 0);
+
+	private:
+		ThreadPool(const ThreadPool &) = delete;
+		ThreadPool &operator=(const ThreadPool &) = delete;
+
+		void worker_main();
+
+		std::vector<std::thread> threads;
+		std::mutex mutex;
+		std::condition_variable worker_event;
+		std::deque<std::function<void()>> tasks;
+		bool stop_flag = false;
+	};
+}
@@ -30,12 +30,104 @@
 #include "UICore/Core/Zip/zlib_compression.h"
 #include "UICore/Core/System/databuffer.h"
 #include "UICore/Core/IOData/memory_device.h"
+#include "UICore/Core/System/thread_pool.h"
 
 #define INCLUDED_FROM_ZLIB_COMPRESSION_CPP
 #include "miniz.h"
 
 namespace uicore
 {
+	namespace
+	{
+		int to_miniz_strategy(ZLibCompression::CompressionMode mode)
+		{
+			switch (mode)
+			{
+			default:
+			case ZLibCompression::default_strategy: return MZ_DEFAULT_STRATEGY;
+			case ZLibCompression::filtered: return MZ_FILTERED;
+			case ZLibCompression::huffman_only: return MZ_HUFFMAN_ONLY;
+			case ZLibCompression::rle: return MZ_RLE;
+			case ZLibCompression::fixed: return MZ_FIXED;
+			}
+		}
+
+		// Raw deflate of one block. All blocks but the last end with a sync flush, which byte aligns the output so the blocks can be concatenated.
+		// The block is primed with the data preceding it, like deflateSetDictionary does in pigz, so matches may reach back into the previous block.
+		std::shared_ptr<DataBuffer> deflate_block(const unsigned char *dictionary, int dictionary_size, const unsigned char *data, int size, int compression_level, int strategy, bool last_block)
+		{
+			const int window_bits = 15;
+
+			auto output = DataBuffer::create(0);
+			output->set_capacity(mz_deflateBound(nullptr, std::max(size, dictionary_size)) + 16);
+
+			mz_stream zs;
+			memset(&zs, 0, sizeof(zs));
+			int result = mz_deflateInit2(&zs, compression_level, MZ_DEFLATED, -window_bits, 8, strategy);
+			if (result != MZ_OK)
+				throw Exception("Zlib deflateInit failed");
+
+			auto deflate_input = [&](const unsigned char *input, int input_size, int flush)
+			{
+				zs.next_in = input;
+				zs.avail_in = input_size;
+				while (true)
+				{
+					size_t pos = output->size();
+					output->set_size(output->capacity());
+					zs.next_out = output->data<unsigned char>() + pos;
+					zs.avail_out = (unsigned int)(output->size() - pos);
+
+					int result = mz_deflate(&zs, flush);
+					if (result == MZ_STREAM_ERROR) throw Exception("Zip stream structure was inconsistent!");
+					if (result == MZ_MEM_ERROR) throw Exception("Zlib did not have enough memory to compress file!");
+					if (result != MZ_OK && result != MZ_STREAM_END && result != MZ_BUF_ERROR) throw Exception("Zlib deflate failed while compressing zip file!");
+
+					output->set_size(output->size() - zs.avail_out);
+					if (result == MZ_STREAM_END || (flush != MZ_FINISH && zs.avail_in == 0 && zs.avail_out != 0))
+						break;
+					output->set_capacity(output->capacity() * 2);
+				}
+			};
+
+			try
+			{
+				// miniz has no deflateSetDictionary. Compressing the dictionary up to a sync flush and discarding the output leaves the same window behind.
+				if (dictionary_size > 0)
+				{
+					deflate_input(dictionary, dictionary_size, MZ_SYNC_FLUSH);
+					output->set_size(0);
+				}
+
+				deflate_input(data, size, last_block ? MZ_FINISH : MZ_SYNC_FLUSH);
+				mz_deflateEnd(&zs);
+			}
+			catch (...)
+			{
+				mz_deflateEnd(&zs);
+				throw;
+			}
+
+			return output;
+		}
+
+		// Checksum of two concatenated blocks, as done by adler32_combine in zlib
+		unsigned int adler32_combine(unsigned int adler1, unsigned int adler2, unsigned int length2)
+		{
+			const unsigned int base = 65521;
+			unsigned int rem = length2 % base;
+			unsigned int sum1 = adler1 & 0xffff;
+			unsigned int sum2 = (unsigned int)(((unsigned long long)rem * sum1) % base);
+			sum1 += (adler2 & 0xffff) + base - 1;
+			sum2 += ((adler1 >> 16) & 0xffff) + ((adler2 >> 16) & 0xffff) + base - rem;
+			if (sum1 >= base) sum1 -= base;
+			if (sum1 >= base) sum1 -= base;
+			if (sum2 >= (base << 1)) sum2 -= (base << 1);
+			if (sum2 >= base) sum2 -= base;
+			return sum1 | (sum2 << 16);
+		}
+	}
+
 	std::shared_ptr<DataBuffer> ZLibCompression::compress(const std::shared_ptr<DataBuffer> &data, bool raw, int compression_level, CompressionMode mode)
 	{
 		const int window_bits = 15;
@@ -43,15 +135,7 @@ namespace uicore
 		auto zbuffer = DataBuffer::create(1024 * 1024);
 		auto output = MemoryDevice::create();
 
-		int strategy = MZ_DEFAULT_STRATEGY;
-		switch (mode)
-		{
-		case default_strategy: strategy = MZ_DEFAULT_STRATEGY; break;
-		case filtered: strategy = MZ_FILTERED; break;
-		case huffman_only: strategy = MZ_HUFFMAN_ONLY; break;
-		case rle: strategy = MZ_RLE; break;
-		case fixed: strategy = MZ_FIXED; break;
-		}
+		int strategy = to_miniz_strategy(mode);
 
 		mz_stream zs = { nullptr };
 		int result = mz_deflateInit2(&zs, compression_level, MZ_DEFLATED, raw ? -window_bits : window_bits, 8, strategy); // Undocumented: if wbits is negative, zlib skips header check
@@ -92,6 +176,71 @@ namespace uicore
 		return output->buffer();
 	}
 
+	std::shared_ptr<DataBuffer> ZLibCompression::compress_parallel(const std::shared_ptr<DataBuffer> &data, bool raw, int compression_level, CompressionMode mode, int block_size)
+	{
+		block_size = std::max(block_size, 1);
+		int data_size = (int)data->size();
+		int num_blocks = (data_size + block_size - 1) / block_size;
+		if (num_blocks <= 1)
+			return compress(data, raw, compression_level, mode);
+
+		const int max_dictionary_size = 32 * 1024;
+
+		int strategy = to_miniz_strategy(mode);
+		std::vector<std::shared_ptr<DataBuffer>> blocks(num_blocks);
+		std::vector<unsigned int> checksums(num_blocks);
+
+		ThreadPool::shared().parallel_for(num_blocks, 1, [&](int begin, int end)
+		{
+			for (int i = begin; i < end; i++)
+			{
+				const unsigned char *block_data = data->data<unsigned char>() + i * block_size;
+				int size = std::min(block_size, data_size - i * block_size);
+				int dictionary_size = std::min(i * block_size, max_dictionary_size);
+				blocks[i] = deflate_block(block_data - dictionary_size, dictionary_size, block_data, size, compression_level, strategy, i + 1 == num_blocks);
+				if (!raw)
+					checksums[i] = (unsigned int)mz_adler32(MZ_ADLER32_INIT, block_data, size);
+			}
+		});
+
+		int total_size = raw ? 0 : 6;
+		for (const auto &block : blocks)
+			total_size += (int)block->size();
+
+		auto output = DataBuffer::create(total_size);
+		unsigned char *dest = output->data<unsigned char>();
+
+		if (!raw)
+		{
+			// zlib header: deflate with a 32K window and the compression level hint
+			unsigned int cmf = 0x78;
+			unsigned int level_flags = compression_level < 2 ? 0 : compression_level < 6 ? 1 : compression_level == 6 ? 2 : 3;
+			unsigned int flg = level_flags << 6;
+			flg += 31 - (cmf * 256 + flg) % 31;
+			*(dest++) = cmf;
+			*(dest++) = flg;
+		}
+
+		unsigned int adler = MZ_ADLER32_INIT;
+		for (int i = 0; i < num_blocks; i++)
+		{
+			memcpy(dest, blocks[i]->data(), blocks[i]->size());
+			dest += blocks[i]->size();
+			if (!raw)
+				adler = adler32_combine(adler, checksums[i], std::min(block_size, data_size - i * block_size));
+		}
+
+		if (!raw)
+		{
+			*(dest++) = (adler >> 24) & 0xff;
+			*(dest++) = (adler >> 16) & 0xff;
+			*(dest++) = (adler >> 8) & 0xff;
+			*(dest++) = adler & 0xff;
+		}
+
+		return output;
+	}
+
 	std::shared_ptr<DataBuffer> ZLibCompression::decompress(const std::shared_ptr<DataBuffer> &data, bool raw)
 	{
 		const int window_bits = 15;
@@ -132,4 +281,62 @@ namespace uicore
 
 		return output->buffer();
 	}
+
+	class ZLibDecompressorImpl : public ZLibDecompressor
+	{
+	public:
+		ZLibDecompressorImpl(bool raw)
+		{
+			const int window_bits = 15;
+			memset(&zs, 0, sizeof(zs));
+			int result = mz_inflateInit2(&zs, raw ? -window_bits : window_bits);
+			if (result != MZ_OK)
+				throw Exception("Zlib inflateInit failed");
+		}
+
+		~ZLibDecompressorImpl()
+		{
+			mz_inflateEnd(&zs);
+		}
+
+		void set_input(const void *data, int size) override
+		{
+			zs.next_in = (const unsigned char *)data;
+			zs.avail_in = size;
+		}
+
+		bool needs_input() const override { return zs.avail_in == 0; }
+		bool is_stream_end() const override { return stream_end; }
+
+		int decompress(void *output, int size) override
+		{
+			if (stream_end || size <= 0)
+				return 0;
+
+			zs.next_out = (unsigned char *)output;
+			zs.avail_out = size;
+
+			int result = mz_inflate(&zs, MZ_NO_FLUSH);
+			if (result == MZ_NEED_DICT) throw Exception("Zlib inflate wants a dictionary!");
+			if (result == MZ_DATA_ERROR) throw Exception("Zip data stream is corrupted");
+			if (result == MZ_STREAM_ERROR) throw Exception("Zip stream structure was inconsistent!");
+			if (result == MZ_MEM_ERROR) throw Exception("Zlib did not have enough memory to decompress file!");
+			if (result != MZ_OK && result != MZ_STREAM_END && result != MZ_BUF_ERROR) throw Exception("Zlib inflate failed while decompressing zip file!");
+			// MZ_BUF_ERROR only means no progress was possible until more input arrives
+
+			if (result == MZ_STREAM_END)
+				stream_end = true;
+
+			return size - zs.avail_out;
+		}
+
+	private:
+		mz_stream zs;
+		bool stream_end = false;
+	};
+
+	std::shared_ptr<ZLibDecompressor> ZLibDecompressor::create(bool raw)
+	{
+		return std::make_shared<ZLibDecompressorImpl>(raw);
+	}
 }
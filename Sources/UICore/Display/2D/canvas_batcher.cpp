@@ -31,6 +31,7 @@
 #include "canvas_batcher.h"
 #include "UICore/Display/2D/render_batcher.h"
 #include "UICore/Display/Render/graphic_context_impl.h"
+#include <algorithm>
 
 namespace uicore
 {
@@ -43,8 +44,10 @@ namespace uicore
 		void flush();
 		bool set_batcher(const std::shared_ptr<GraphicContext> &gc, RenderBatcher *batcher);
 		void update_batcher_matrix(const std::shared_ptr<GraphicContext> &gc, const Mat4f &modelview, const Mat4f &projection, TextureImageYAxis image_yaxis);
+		void add_pending_uploads(const std::shared_ptr<TextureGroup> &texture_group);
 
 		std::shared_ptr<GraphicContext> current_gc;
+		std::vector<std::shared_ptr<TextureGroup>> pending_uploads;
 
 		RenderBatcher *active_batcher;
 		RenderBatchBuffer render_batcher_buffer;
@@ -114,6 +117,11 @@ namespace uicore
 		{
 			RenderBatcher *batcher = active_batcher;
 			active_batcher = nullptr;
+
+			for (auto &texture_group : pending_uploads)
+				texture_group->flush_uploads(current_gc);
+			pending_uploads.clear();
+
 			batcher->flush(current_gc);
 		}
 	}
@@ -132,6 +140,12 @@ namespace uicore
 		}
 	}
 
+	void CanvasBatcher_Impl::add_pending_uploads(const std::shared_ptr<TextureGroup> &texture_group)
+	{
+		if (std::find(pending_uploads.begin(), pending_uploads.end(), texture_group) == pending_uploads.end())
+			pending_uploads.push_back(texture_group);
+	}
+
 	bool CanvasBatcher_Impl::set_batcher(const std::shared_ptr<GraphicContext> &gc, RenderBatcher *batcher)
 	{
 		if ((active_batcher != batcher) || (gc != current_gc))
@@ -154,6 +168,11 @@ namespace uicore
 		impl->update_batcher_matrix(gc, modelview, projection, image_yaxis);
 	}
 
+	void CanvasBatcher::add_pending_uploads(const std::shared_ptr<TextureGroup> &texture_group)
+	{
+		impl->add_pending_uploads(texture_group);
+	}
+
 	bool CanvasBatcher::set_batcher(const std::shared_ptr<GraphicContext> &gc, RenderBatcher *batcher)
 	{
 		return impl->set_batcher(gc, batcher);
@@ -37,6 +37,7 @@
 #include "UICore/Display/2D/render_batch_point.h"
 #include "UICore/Display/2D/render_batch_path.h"
 #include "UICore/Display/2D/canvas.h"
+#include "UICore/Display/2D/texture_group.h"
 #include "UICore/Display/Window/display_window.h"
 
 namespace uicore
@@ -57,6 +58,9 @@ namespace uicore
 		bool set_batcher(const std::shared_ptr<GraphicContext> &gc, RenderBatcher *batcher);
 		void update_batcher_matrix(const std::shared_ptr<GraphicContext> &gc, const Mat4f &modelview, const Mat4f &projection, TextureImageYAxis image_yaxis);
 
+		/// \brief Flushes the pending uploads of the texture group before the next batch is drawn
+		void add_pending_uploads(const std::shared_ptr<TextureGroup> &texture_group);
+
 		RenderBatchTriangle *get_triangle_batcher();
 		RenderBatchLine *get_line_batcher();
 		RenderBatchLineTexture *get_line_texture_batcher();
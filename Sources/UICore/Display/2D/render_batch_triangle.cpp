@@ -33,6 +33,12 @@
 #include "UICore/Display/Render/blend_state_description.h"
 #include "UICore/Display/2D/canvas.h"
 #include "UICore/Core/Math/quad.h"
+#include <algorithm>
+
+#if !defined __ANDROID__ && ! defined CL_DISABLE_SSE2
+#include <xmmintrin.h>
+#include <emmintrin.h>
+#endif
 
 namespace uicore
 {
@@ -213,6 +219,125 @@ namespace uicore
 		position += 6;
 	}
 
+	void RenderBatchTriangle::draw_glyph_run(const std::shared_ptr<Canvas> &canvas, const Pointf &origin, const Rectf *src, const Rectf *dest, int num_glyphs, const Colorf &color, const std::shared_ptr<Texture2D> &texture)
+	{
+		while (num_glyphs > 0)
+		{
+			int texindex = set_batcher_active(canvas, texture);
+			int count = std::min(num_glyphs, (max_vertices - position) / 6);
+			write_glyph_run(origin, src, dest, count, Vec4f(color.x, color.y, color.z, color.w), texindex);
+			src += count;
+			dest += count;
+			num_glyphs -= count;
+		}
+	}
+
+	void RenderBatchTriangle::draw_glyph_run_subpixel(const std::shared_ptr<Canvas> &canvas, const Pointf &origin, const Rectf *src, const Rectf *dest, int num_glyphs, const Colorf &color, const std::shared_ptr<Texture2D> &texture)
+	{
+		while (num_glyphs > 0)
+		{
+			int texindex = set_batcher_active(canvas, texture, true, color);
+			int count = std::min(num_glyphs, (max_vertices - position) / 6);
+			write_glyph_run(origin, src, dest, count, Vec4f(1.0f, 1.0f, 1.0f, 1.0f), texindex);
+			src += count;
+			dest += count;
+			num_glyphs -= count;
+		}
+	}
+
+	void RenderBatchTriangle::write_glyph_run(const Pointf &origin, const Rectf *src, const Rectf *dest, int num_glyphs, const Vec4f &color, int texindex)
+	{
+		// to_position is linear in x and y, so each corner is the transformed origin plus offsets along the x and y axis of the matrix
+		const float *m = modelview_projection_matrix.matrix;
+		Vec4f base = to_position(origin.x, origin.y);
+		float tex_scale_x = 1.0f / tex_sizes[texindex].width;
+		float tex_scale_y = 1.0f / tex_sizes[texindex].height;
+		SpriteVertex *v = vertices + position;
+
+#if !defined __ANDROID__ && ! defined CL_DISABLE_SSE2
+		__m128 axis_x = _mm_loadu_ps(m);
+		__m128 axis_y = _mm_loadu_ps(m + 4);
+		__m128 mbase = _mm_loadu_ps(&base.x);
+		__m128 mcolor = _mm_loadu_ps(&color.x);
+		__m128 tex_scale = _mm_setr_ps(tex_scale_x, tex_scale_y, tex_scale_x, tex_scale_y);
+
+		for (int i = 0; i < num_glyphs; i++, v += 6)
+		{
+			__m128 x_left = _mm_mul_ps(axis_x, _mm_set1_ps(dest[i].left));
+			__m128 x_right = _mm_mul_ps(axis_x, _mm_set1_ps(dest[i].right));
+			__m128 y_top = _mm_add_ps(mbase, _mm_mul_ps(axis_y, _mm_set1_ps(dest[i].top)));
+			__m128 y_bottom = _mm_add_ps(mbase, _mm_mul_ps(axis_y, _mm_set1_ps(dest[i].bottom)));
+			__m128 left_top = _mm_add_ps(x_left, y_top);
+			__m128 right_top = _mm_add_ps(x_right, y_top);
+			__m128 left_bottom = _mm_add_ps(x_left, y_bottom);
+			__m128 right_bottom = _mm_add_ps(x_right, y_bottom);
+
+			// texcoord rectangle as (left, top, right, bottom)
+			__m128 uv = _mm_mul_ps(_mm_loadu_ps(&src[i].left), tex_scale);
+			__m128 uv_right_top = _mm_shuffle_ps(uv, uv, _MM_SHUFFLE(3, 1, 1, 2));
+			__m128 uv_left_bottom = _mm_shuffle_ps(uv, uv, _MM_SHUFFLE(3, 1, 3, 0));
+			__m128 uv_right_bottom = _mm_shuffle_ps(uv, uv, _MM_SHUFFLE(3, 1, 3, 2));
+
+			_mm_storeu_ps(&v[0].position.x, left_top);
+			_mm_storeu_ps(&v[1].position.x, right_top);
+			_mm_storeu_ps(&v[2].position.x, left_bottom);
+			_mm_storeu_ps(&v[3].position.x, right_top);
+			_mm_storeu_ps(&v[4].position.x, right_bottom);
+			_mm_storeu_ps(&v[5].position.x, left_bottom);
+
+			_mm_storel_pi((__m64*)&v[0].texcoord.x, uv);
+			_mm_storel_pi((__m64*)&v[1].texcoord.x, uv_right_top);
+			_mm_storel_pi((__m64*)&v[2].texcoord.x, uv_left_bottom);
+			_mm_storel_pi((__m64*)&v[3].texcoord.x, uv_right_top);
+			_mm_storel_pi((__m64*)&v[4].texcoord.x, uv_right_bottom);
+			_mm_storel_pi((__m64*)&v[5].texcoord.x, uv_left_bottom);
+
+			for (int j = 0; j < 6; j++)
+			{
+				_mm_storeu_ps(&v[j].color.x, mcolor);
+				v[j].texindex = texindex;
+			}
+		}
+#else
+		Vec4f axis_x(m[0], m[1], m[2], m[3]);
+		Vec4f axis_y(m[4], m[5], m[6], m[7]);
+
+		for (int i = 0; i < num_glyphs; i++, v += 6)
+		{
+			Vec4f x_left = axis_x * dest[i].left;
+			Vec4f x_right = axis_x * dest[i].right;
+			Vec4f y_top = base + axis_y * dest[i].top;
+			Vec4f y_bottom = base + axis_y * dest[i].bottom;
+
+			v[0].position = x_left + y_top;
+			v[1].position = x_right + y_top;
+			v[2].position = x_left + y_bottom;
+			v[3].position = v[1].position;
+			v[4].position = x_right + y_bottom;
+			v[5].position = v[2].position;
+
+			float src_left = src[i].left * tex_scale_x;
+			float src_top = src[i].top * tex_scale_y;
+			float src_right = src[i].right * tex_scale_x;
+			float src_bottom = src[i].bottom * tex_scale_y;
+			v[0].texcoord = Vec2f(src_left, src_top);
+			v[1].texcoord = Vec2f(src_right, src_top);
+			v[2].texcoord = Vec2f(src_left, src_bottom);
+			v[3].texcoord = Vec2f(src_right, src_top);
+			v[4].texcoord = Vec2f(src_right, src_bottom);
+			v[5].texcoord = Vec2f(src_left, src_bottom);
+
+			for (int j = 0; j < 6; j++)
+			{
+				v[j].color = color;
+				v[j].texindex = texindex;
+			}
+		}
+#endif
+
+		position += num_glyphs * 6;
+	}
+
 	void RenderBatchTriangle::fill(const std::shared_ptr<Canvas> &canvas, float x1, float y1, float x2, float y2, const Colorf &color)
 	{
 		int texindex = set_batcher_active(canvas);
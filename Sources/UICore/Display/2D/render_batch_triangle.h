@@ -50,6 +50,12 @@ namespace uicore
 		void draw_image(const std::shared_ptr<Canvas> &canvas, const Rectf &src, const Rectf &dest, const Colorf &color, const std::shared_ptr<Texture2D> &texture);
 		void draw_image(const std::shared_ptr<Canvas> &canvas, const Rectf &src, const Quadf &dest, const Colorf &color, const std::shared_ptr<Texture2D> &texture);
 		void draw_glyph_subpixel(const std::shared_ptr<Canvas> &canvas, const Rectf &src, const Rectf &dest, const Colorf &color, const std::shared_ptr<Texture2D> &texture);
+
+		/// \brief Draws a run of glyphs sharing the same atlas texture
+		///
+		/// Destination rectangles are relative to origin. Only the origin is transformed by the matrix, the glyph corners are offset from it using the matrix axes.
+		void draw_glyph_run(const std::shared_ptr<Canvas> &canvas, const Pointf &origin, const Rectf *src, const Rectf *dest, int num_glyphs, const Colorf &color, const std::shared_ptr<Texture2D> &texture);
+		void draw_glyph_run_subpixel(const std::shared_ptr<Canvas> &canvas, const Pointf &origin, const Rectf *src, const Rectf *dest, int num_glyphs, const Colorf &color, const std::shared_ptr<Texture2D> &texture);
 		void fill_triangle(const std::shared_ptr<Canvas> &canvas, const Vec2f *triangle_positions, const Vec4f *triangle_colors, int num_vertices);
 		void fill_triangle(const std::shared_ptr<Canvas> &canvas, const Vec2f *triangle_positions, const Colorf &color, int num_vertices);
 		void fill_triangles(const std::shared_ptr<Canvas> &canvas, const Vec2f *positions, const Vec2f *texture_positions, int num_vertices, const std::shared_ptr<Texture2D> &texture, const Colorf &color);
@@ -74,6 +80,7 @@ namespace uicore
 		void flush(const std::shared_ptr<GraphicContext> &gc) override;
 		void matrix_changed(const Mat4f &modelview, const Mat4f &projection, TextureImageYAxis image_yaxis, float pixel_ratio) override;
 
+		void write_glyph_run(const Pointf &origin, const Rectf *src, const Rectf *dest, int num_glyphs, const Vec4f &color, int texindex);
 		inline void to_sprite_vertex(const Pointf &texture_position, const Pointf &dest_position, RenderBatchTriangle::SpriteVertex &v, int texindex, const Colorf &color) const;
 		inline Vec4f to_position(float x, float y) const;
 
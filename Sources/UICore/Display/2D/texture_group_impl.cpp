@@ -31,6 +31,7 @@
 #include "UICore/Core/Math/point.h"
 #include "UICore/Core/Math/rect.h"
 #include "texture_group_impl.h"
+#include <algorithm>
 
 namespace uicore
 {
@@ -146,6 +147,7 @@ namespace uicore
 		active_root = new RootNode();
 		active_root->texture = Texture2D::create(context, texture_size);
 		active_root->node = node;
+		active_root->owns_texture = true;
 
 		root_nodes.push_back(active_root);
 
@@ -163,6 +165,83 @@ namespace uicore
 		root_nodes.push_back(active_root);
 	}
 
+	void TextureGroupImpl::set_subimage(const std::shared_ptr<GraphicContext> &context, const TextureGroupImage &subtexture, const std::shared_ptr<PixelBuffer> &image)
+	{
+		const Rect &rect = subtexture.geometry();
+		num_uploaded_images++;
+
+		// Only textures created by the group can be mirrored in system memory, as the contents of inserted textures are unknown
+		RootNode *root = find_root(subtexture.texture());
+		if (!root || !root->owns_texture)
+		{
+			subtexture.texture()->set_subimage(context, rect.left, rect.top, image, image->size());
+			num_uploads++;
+			return;
+		}
+
+		if (!root->shadow)
+			root->shadow = PixelBuffer::create(root->texture->width(), root->texture->height(), tf_rgba8);
+
+		root->shadow->set_subimage(image, rect.position(), image->size());
+		add_dirty_rows(root->dirty_rows, rect.top, rect.top + image->height());
+		pending_uploads = true;
+	}
+
+	void TextureGroupImpl::flush_uploads(const std::shared_ptr<GraphicContext> &context)
+	{
+		if (!pending_uploads)
+			return;
+		pending_uploads = false;
+
+		for (auto root : root_nodes)
+		{
+			if (root->dirty_rows.empty())
+				continue;
+
+			// The staging texture only supports uploading full rows, which is why the dirty regions are tracked as row spans
+			int width = root->shadow->width();
+			if (!root->staging)
+				root->staging = StagingTexture::create(context, width, root->shadow->height(), StagingDirection::to_gpu, tf_rgba8);
+
+			for (const auto &span : root->dirty_rows)
+			{
+				Rect rows(0, span.top, width, span.bottom);
+				root->staging->upload_data(context, rows, root->shadow->line(span.top));
+				root->texture->set_subimage(context, 0, span.top, root->staging, rows);
+				num_uploads++;
+			}
+			root->dirty_rows.clear();
+		}
+	}
+
+	void TextureGroupImpl::add_dirty_rows(std::vector<RowSpan> &spans, int top, int bottom)
+	{
+		spans.push_back(RowSpan(top, bottom));
+		std::sort(spans.begin(), spans.end(), [](const RowSpan &a, const RowSpan &b) { return a.top < b.top; });
+
+		// Join spans that overlap or are close enough that one larger upload is cheaper than two
+		size_t count = 1;
+		for (size_t i = 1; i < spans.size(); i++)
+		{
+			RowSpan &last = spans[count - 1];
+			if (spans[i].top <= last.bottom + max_row_span_gap)
+				last.bottom = std::max(last.bottom, spans[i].bottom);
+			else
+				spans[count++] = spans[i];
+		}
+		spans.resize(count, RowSpan(0, 0));
+	}
+
+	TextureGroupImpl::RootNode *TextureGroupImpl::find_root(const std::shared_ptr<Texture2D> &texture)
+	{
+		for (auto root : root_nodes)
+		{
+			if (root->texture == texture)
+				return root;
+		}
+		return nullptr;
+	}
+
 	void TextureGroupImpl::remove(const TextureGroupImage &subtexture)
 	{
 		// Find the texture
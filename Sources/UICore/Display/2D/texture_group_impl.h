@@ -30,6 +30,8 @@
 
 #include <list>
 #include "UICore/Display/Render/texture_2d.h"
+#include "UICore/Display/Render/staging_texture.h"
+#include "UICore/Display/Image/pixel_buffer.h"
 #include "UICore/Display/2D/texture_group.h"
 
 namespace uicore
@@ -52,6 +54,11 @@ namespace uicore
 		void remove(const TextureGroupImage &subtexture) override;
 		void set_allocation_policy(TextureGroupAllocationPolicy policy) override { texture_allocation_policy = policy; }
 		void insert_texture(const std::shared_ptr<Texture2D> &texture, const Rect &texture_rect) override;
+		void set_subimage(const std::shared_ptr<GraphicContext> &context, const TextureGroupImage &subtexture, const std::shared_ptr<PixelBuffer> &image) override;
+		bool has_pending_uploads() const override { return pending_uploads; }
+		void flush_uploads(const std::shared_ptr<GraphicContext> &context) override;
+		int upload_count() const override { return num_uploads; }
+		int uploaded_image_count() const override { return num_uploaded_images; }
 
 	private:
 		class Node
@@ -75,15 +82,29 @@ namespace uicore
 			Rect image_rect;
 		};
 
+		struct RowSpan
+		{
+			RowSpan(int top, int bottom) : top(top), bottom(bottom) { }
+			int top;
+			int bottom;
+		};
+
 		struct RootNode
 		{
 		public:
 			std::shared_ptr<Texture2D> texture;
 			Node node;
+
+			bool owns_texture = false;
+			std::shared_ptr<PixelBuffer> shadow;	// System memory copy of the texture contents
+			std::shared_ptr<StagingTexture> staging;
+			std::vector<RowSpan> dirty_rows;
 		};
 
 		TextureGroupImage add_new_node(const std::shared_ptr<GraphicContext> &context, const Size &texture_size);
 		RootNode *add_new_root(const std::shared_ptr<GraphicContext> &context, const Size &texture_size);
+		RootNode *find_root(const std::shared_ptr<Texture2D> &texture);
+		static void add_dirty_rows(std::vector<RowSpan> &spans, int top, int bottom);
 
 		std::vector<RootNode *> root_nodes;
 
@@ -92,5 +113,11 @@ namespace uicore
 
 		RootNode *active_root;
 		int next_id;
+
+		bool pending_uploads = false;
+		int num_uploads = 0;
+		int num_uploaded_images = 0;
+
+		static const int max_row_span_gap = 16;
 	};
 }
@@ -29,6 +29,7 @@
 #pragma once
 
 #include "font_draw.h"
+#include "font_draw_glyph_run.h"
 
 namespace uicore
 {
@@ -45,5 +46,6 @@ namespace uicore
 	private:
 		GlyphCache *glyph_cache = nullptr;
 		FontEngine *font_engine = nullptr;
+		Font_GlyphRun glyph_run;
 	};
 }
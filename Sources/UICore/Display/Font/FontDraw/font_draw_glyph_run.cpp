@@ -0,0 +1,115 @@
+/*
+**  UICore
+**  Copyright (c) 1997-2015 The UICore Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries UICore may link to may have additional
+**  requirements or restrictions.
+**
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "UICore/precomp.h"
+#include "UICore/Display/Font/font.h"
+#include "UICore/Core/Text/utf8_reader.h"
+#include "UICore/Display/2D/canvas.h"
+#include "UICore/Display/2D/canvas_impl.h"
+#include "UICore/Display/Font/FontEngine/font_engine.h"
+#include "UICore/Display/Font/glyph_cache.h"
+#include "font_draw_glyph_run.h"
+
+namespace uicore
+{
+	void Font_GlyphRun::draw_text(const std::shared_ptr<Canvas> &canvas, GlyphCache *glyph_cache, FontEngine *font_engine, const Pointf &position, const std::string &text, const Colorf &color, float line_spacing, bool subpixel)
+	{
+		// When the canvas transform is a pure translation grid fitting can be done without the matrix round trip
+		Mat4f transform = canvas->transform();
+		Vec3f translate = transform.get_translate();
+		transform.set_translate(0.0f, 0.0f, 0.0f);
+		bool translate_only = transform == Mat4f::identity();
+		float pixel_ratio = canvas->pixel_ratio();
+
+		float offset_x = 0;
+		float offset_y = 0;
+		UTF8_Reader reader(text.data(), text.length());
+
+		while (!reader.is_end())
+		{
+			unsigned int glyph = reader.character();
+			reader.next();
+
+			if (glyph == '\n')
+			{
+				offset_x = 0;
+				offset_y += line_spacing;
+				continue;
+			}
+
+			Font_TextureGlyph *gptr = glyph_cache->get_glyph(canvas, font_engine, glyph);
+			if (gptr)
+			{
+				if (gptr->texture)
+				{
+					if (gptr->texture != texture)
+					{
+						flush(canvas, position, color, subpixel);
+						texture = gptr->texture;
+					}
+
+					float xp = offset_x + position.x + gptr->offset.x;
+					float yp = offset_y + position.y + gptr->offset.y;
+					Pointf pos;
+					if (translate_only)
+					{
+						pos.x = std::round((xp + translate.x) * pixel_ratio) / pixel_ratio - translate.x;
+						pos.y = std::round((yp + translate.y) * pixel_ratio) / pixel_ratio - translate.y;
+					}
+					else
+					{
+						pos = canvas->grid_fit(Pointf(xp, yp));
+					}
+
+					src.push_back(Rectf(gptr->geometry));
+					dest.push_back(Rectf(pos.x - position.x, pos.y - position.y, gptr->size));
+				}
+				offset_x += gptr->metrics.advance.width;
+				offset_y += gptr->metrics.advance.height;
+			}
+		}
+
+		flush(canvas, position, color, subpixel);
+		texture.reset();
+	}
+
+	void Font_GlyphRun::flush(const std::shared_ptr<Canvas> &canvas, const Pointf &position, const Colorf &color, bool subpixel)
+	{
+		if (!src.empty())
+		{
+			RenderBatchTriangle *batcher = static_cast<CanvasImpl*>(canvas.get())->batcher.get_triangle_batcher();
+			if (subpixel)
+				batcher->draw_glyph_run_subpixel(canvas, position, src.data(), dest.data(), (int)src.size(), color, texture);
+			else
+				batcher->draw_glyph_run(canvas, position, src.data(), dest.data(), (int)src.size(), color, texture);
+			src.clear();
+			dest.clear();
+		}
+	}
+}
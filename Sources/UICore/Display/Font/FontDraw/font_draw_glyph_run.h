@@ -0,0 +1,52 @@
+/*
+**  UICore
+**  Copyright (c) 1997-2015 The UICore Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries UICore may link to may have additional
+**  requirements or restrictions.
+**
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include "font_draw.h"
+
+namespace uicore
+{
+	class GlyphCache;
+	class FontEngine;
+
+	/// \brief Groups consecutive glyphs sharing an atlas texture into runs submitted to the triangle batcher in one call
+	class Font_GlyphRun
+	{
+	public:
+		void draw_text(const std::shared_ptr<Canvas> &canvas, GlyphCache *glyph_cache, FontEngine *font_engine, const Pointf &position, const std::string &text, const Colorf &color, float line_spacing, bool subpixel);
+
+	private:
+		void flush(const std::shared_ptr<Canvas> &canvas, const Pointf &position, const Colorf &color, bool subpixel);
+
+		std::shared_ptr<Texture2D> texture;
+		std::vector<Rectf> src;
+		std::vector<Rectf> dest;
+	};
+}
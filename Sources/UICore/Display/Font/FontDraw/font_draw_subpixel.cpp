@@ -57,38 +57,6 @@ namespace uicore
 
 	void Font_DrawSubPixel::draw_text(const std::shared_ptr<Canvas> &canvas, const Pointf &position, const std::string &text, const Colorf &color, float line_spacing)
 	{
-		float offset_x = 0;
-		float offset_y = 0;
-		UTF8_Reader reader(text.data(), text.length());
-		RenderBatchTriangle *batcher = static_cast<CanvasImpl*>(canvas.get())->batcher.get_triangle_batcher();
-
-		while (!reader.is_end())
-		{
-			unsigned int glyph = reader.character();
-			reader.next();
-
-			if (glyph == '\n')
-			{
-				offset_x = 0;
-				offset_y += line_spacing;
-				continue;
-			}
-
-			Font_TextureGlyph *gptr = glyph_cache->get_glyph(canvas, font_engine, glyph);
-			if (gptr)
-			{
-				if (gptr->texture)
-				{
-					float xp = offset_x + position.x + gptr->offset.x;
-					float yp = offset_y + position.y + gptr->offset.y;
-					Pointf pos = canvas->grid_fit(Pointf(xp, yp));
-
-					Rectf dest_size(pos, gptr->size);
-					batcher->draw_glyph_subpixel(canvas, gptr->geometry, dest_size, color, gptr->texture);
-				}
-				offset_x += gptr->metrics.advance.width;
-				offset_y += gptr->metrics.advance.height;
-			}
-		}
+		glyph_run.draw_text(canvas, glyph_cache, font_engine, position, text, color, line_spacing, true);
 	}
 }
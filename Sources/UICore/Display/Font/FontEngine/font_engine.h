@@ -82,5 +82,9 @@ namespace uicore
 		virtual const FontDescription &get_desc() const = 0;
 		virtual void load_glyph_path(unsigned int glyph_index, const std::shared_ptr<Path> &out_path, GlyphMetrics &out_metrics) = 0;
 		virtual FontHandle *get_handle() { return nullptr; }
+		virtual bool get_glyph_metrics(unsigned int /*glyph*/, GlyphMetrics &/*out_metrics*/) { return false; }	// false if the engine has no precomputed metrics (the glyph has to be rendered to find them)
+		virtual float get_kerning(unsigned int /*left_glyph*/, unsigned int /*right_glyph*/) { return 0.0f; }
+		virtual std::shared_ptr<FontEngine> create_worker_engine() { return nullptr; }	// Engine for rendering glyphs on another thread, null if not supported
+		virtual std::string get_cache_key() { return std::string(); }	// Identifies the rendered glyphs in a glyph cache file, empty if not supported
 	};
 }
@@ -35,6 +35,9 @@
 #include "font_engine_freetype.h"
 #include "UICore/Core/IOData/iodevice.h"
 #include "UICore/Display/2D/path.h"
+#include "UICore/Core/Crypto/hash_functions.h"
+#include "UICore/Core/Text/string_format.h"
+#include <mutex>
 
 namespace uicore
 {
@@ -50,6 +53,7 @@ public:
 
 public:
 	FT_Library library;
+	std::mutex mutex;	// FT_New_Face and FT_Done_Face are not thread safe
 };
 
 FontEngine_Freetype_Library::FontEngine_Freetype_Library()
@@ -96,7 +100,11 @@ FontEngine_Freetype::FontEngine_Freetype(const FontDescription &description, std
 
 	FontEngine_Freetype_Library &library = FontEngine_Freetype_Library::instance();
 
-	FT_Error error = FT_New_Memory_Face( library.library, (FT_Byte*)data_buffer->data(), data_buffer->size(), 0, &face);
+	FT_Error error;
+	{
+		std::unique_lock<std::mutex> lock(library.mutex);
+		error = FT_New_Memory_Face( library.library, (FT_Byte*)data_buffer->data(), data_buffer->size(), 0, &face);
+	}
 
 	if ( error == FT_Err_Unknown_File_Format )
 	{
@@ -119,6 +127,7 @@ FontEngine_Freetype::~FontEngine_Freetype()
 {
 	if (face)
 	{
+		std::unique_lock<std::mutex> lock(FontEngine_Freetype_Library::instance().mutex);
 		FT_Done_Face(face);
 	}
 }
@@ -138,6 +147,60 @@ FontPixelBuffer FontEngine_Freetype::get_font_glyph(int glyph)
 	}
 }
 
+bool FontEngine_Freetype::get_glyph_metrics(unsigned int glyph, GlyphMetrics &out_metrics)
+{
+	const GlyphMetricsPage *page = get_metrics_page(glyph >> 8);
+	if (!page)
+		return false;
+
+	out_metrics = page->metrics[glyph & 0xff];
+	return true;
+}
+
+float FontEngine_Freetype::get_kerning(unsigned int left_glyph, unsigned int right_glyph)
+{
+	if (!FT_HAS_KERNING(face))
+		return 0.0f;
+
+	unsigned int left_table_index = left_glyph - kerning_table_first;
+	unsigned int right_table_index = right_glyph - kerning_table_first;
+	if (left_table_index < kerning_table_size && right_table_index < kerning_table_size)
+	{
+		if (kerning_table.empty())
+			calculate_kerning_table();
+		return kerning_table[left_table_index * kerning_table_size + right_table_index];
+	}
+
+	uint64_t key = (((uint64_t)left_glyph) << 32) | right_glyph;
+	auto it = kerning_pairs.find(key);
+	if (it != kerning_pairs.end())
+		return it->second;
+
+	float kerning = 0.0f;
+	FT_Vector delta;
+	if (FT_Get_Kerning(face, get_glyph_index(left_glyph), get_glyph_index(right_glyph), FT_KERNING_DEFAULT, &delta) == 0)
+		kerning = delta.x / 64.0f / pixel_ratio;
+
+	kerning_pairs[key] = kerning;
+	return kerning;
+}
+
+std::shared_ptr<FontEngine> FontEngine_Freetype::create_worker_engine()
+{
+	// Each engine has its own FT_Face, which makes it safe to use from another thread
+	return std::make_shared<FontEngine_Freetype>(font_description, data_buffer, pixel_ratio);
+}
+
+std::string FontEngine_Freetype::get_cache_key()
+{
+	if (data_hash.empty())
+		data_hash = HashFunctions::sha1(data_buffer);
+
+	std::string key = string_format("freetype-%1-%2-%3", data_hash, font_description.height(), pixel_ratio);
+	key += string_format("-%1-%2-%3-%4-%5", font_description.average_width(), (int)font_description.weight(), (int)font_description.style(), font_description.subpixel() ? 1 : 0, font_description.anti_alias() ? 1 : 0);
+	return key;
+}
+
 /////////////////////////////////////////////////////////////////////////////
 // FontEngine_Freetype Operations:
 
@@ -240,36 +303,14 @@ FontPixelBuffer FontEngine_Freetype::get_font_glyph_standard(int glyph, bool ant
 	FT_Error error;
 
 	// Use FT_RENDER_MODE_NORMAL for 8bit anti-aliased bitmaps. Use FT_RENDER_MODE_MONO for 1-bit bitmaps
-	if (anti_alias)
-	{
-		error = FT_Load_Glyph(face, glyph_index, FT_LOAD_TARGET_LIGHT );
-		if (error) return font_buffer;
-
-		error = FT_Render_Glyph( face->glyph, FT_RENDER_MODE_NORMAL);
-	}
-	else
-	{
-		error = FT_Load_Glyph(face, glyph_index, FT_LOAD_TARGET_MONO);
-		if (error) return font_buffer;
+	error = FT_Load_Glyph(face, glyph_index, anti_alias ? FT_LOAD_TARGET_LIGHT : FT_LOAD_TARGET_MONO);
+	if (error) return font_buffer;
 
-		error = FT_Render_Glyph( face->glyph, FT_RENDER_MODE_MONO);
-	}
+	error = FT_Render_Glyph(face->glyph, anti_alias ? FT_RENDER_MODE_NORMAL : FT_RENDER_MODE_MONO);
 
 	font_buffer.glyph = glyph;
 	// Set Increment pen position
-	font_buffer.metrics.bbox_offset.x = slot->metrics.horiBearingX / 64.0f;
-	font_buffer.metrics.bbox_offset.y = -slot->metrics.horiBearingY / 64.0f;
-	font_buffer.metrics.bbox_size.width = slot->metrics.width / 64.0f;
-	font_buffer.metrics.bbox_size.height = slot->metrics.height / 64.0f;
-	font_buffer.metrics.advance.width = slot->advance.x / 64.0f;
-	font_buffer.metrics.advance.height = slot->advance.y / 64.0f;
-
-	font_buffer.metrics.advance.width /= pixel_ratio;
-	font_buffer.metrics.advance.height /= pixel_ratio;
-	font_buffer.metrics.bbox_offset.x /= pixel_ratio;
-	font_buffer.metrics.bbox_offset.y /= pixel_ratio;
-	font_buffer.metrics.bbox_size.width /= pixel_ratio;
-	font_buffer.metrics.bbox_size.height /= pixel_ratio;
+	font_buffer.metrics = get_slot_metrics(slot);
 
 	if (error || slot->bitmap.rows == 0 || slot->bitmap.width == 0)
 		return font_buffer;
@@ -368,19 +409,7 @@ FontPixelBuffer FontEngine_Freetype::get_font_glyph_subpixel(int glyph)
 
 	font_buffer.glyph = glyph;
 	// Set Increment pen position
-	font_buffer.metrics.bbox_offset.x = slot->metrics.horiBearingX / 64.0f;
-	font_buffer.metrics.bbox_offset.y = -slot->metrics.horiBearingY / 64.0f;
-	font_buffer.metrics.bbox_size.width = slot->metrics.width / 64.0f;
-	font_buffer.metrics.bbox_size.height = slot->metrics.height / 64.0f;
-	font_buffer.metrics.advance.width = slot->advance.x / 64.0f;
-	font_buffer.metrics.advance.height = slot->advance.y / 64.0f;
-
-	font_buffer.metrics.advance.width /= pixel_ratio;
-	font_buffer.metrics.advance.height /= pixel_ratio;
-	font_buffer.metrics.bbox_offset.x /= pixel_ratio;
-	font_buffer.metrics.bbox_offset.y /= pixel_ratio;
-	font_buffer.metrics.bbox_size.width /= pixel_ratio;
-	font_buffer.metrics.bbox_size.height /= pixel_ratio;
+	font_buffer.metrics = get_slot_metrics(slot);
 
 	if (error || slot->bitmap.rows == 0 || slot->bitmap.width == 0)
 		return font_buffer;
@@ -528,6 +557,112 @@ std::vector<TaggedPoint> FontEngine_Freetype::get_contour_points(int cont, FT_Ou
 	return points;
 }
 
+FT_Int32 FontEngine_Freetype::get_load_flags() const
+{
+	// Must match the flags used by get_font_glyph, as hinting affects the advance
+	if (font_description.subpixel())
+		return FT_LOAD_TARGET_LCD;
+	else if (font_description.anti_alias())
+		return FT_LOAD_TARGET_LIGHT;
+	else
+		return FT_LOAD_TARGET_MONO;
+}
+
+GlyphMetrics FontEngine_Freetype::get_slot_metrics(FT_GlyphSlot slot) const
+{
+	GlyphMetrics metrics;
+	metrics.bbox_offset.x = slot->metrics.horiBearingX / 64.0f;
+	metrics.bbox_offset.y = -slot->metrics.horiBearingY / 64.0f;
+	metrics.bbox_size.width = slot->metrics.width / 64.0f;
+	metrics.bbox_size.height = slot->metrics.height / 64.0f;
+	metrics.advance.width = slot->advance.x / 64.0f;
+	metrics.advance.height = slot->advance.y / 64.0f;
+
+	metrics.advance.width /= pixel_ratio;
+	metrics.advance.height /= pixel_ratio;
+	metrics.bbox_offset.x /= pixel_ratio;
+	metrics.bbox_offset.y /= pixel_ratio;
+	metrics.bbox_size.width /= pixel_ratio;
+	metrics.bbox_size.height /= pixel_ratio;
+	return metrics;
+}
+
+const FontEngine_Freetype::GlyphMetricsPage *FontEngine_Freetype::get_metrics_page(unsigned int page)
+{
+	if (page > 0x10ff)	// Outside the unicode range
+		return nullptr;
+
+	if (page >= metrics_pages.size())
+		metrics_pages.resize(page + 1);
+
+	if (!metrics_pages[page])
+	{
+		auto metrics_page = std::unique_ptr<GlyphMetricsPage>(new GlyphMetricsPage());
+		FT_Int32 load_flags = get_load_flags();
+
+		bool notdef_loaded = false;
+		GlyphMetrics notdef_metrics;
+
+		for (unsigned int i = 0; i < 256; i++)
+		{
+			unsigned int glyph = (page << 8) + i;
+			FT_UInt glyph_index = FT_Get_Char_Index(face, glyph);
+			metrics_page->glyph_index[i] = glyph_index;
+
+			if (glyph == 0)	// Treated as an invalid glyph by get_font_glyph
+				continue;
+
+			if (glyph_index == 0)
+			{
+				// All missing characters share the metrics of the .notdef glyph
+				if (!notdef_loaded)
+				{
+					if (FT_Load_Glyph(face, 0, load_flags) == 0)
+						notdef_metrics = get_slot_metrics(face->glyph);
+					notdef_loaded = true;
+				}
+				metrics_page->metrics[i] = notdef_metrics;
+			}
+			else if (FT_Load_Glyph(face, glyph_index, load_flags) == 0)
+			{
+				metrics_page->metrics[i] = get_slot_metrics(face->glyph);
+			}
+		}
+
+		metrics_pages[page] = std::move(metrics_page);
+	}
+
+	return metrics_pages[page].get();
+}
+
+FT_UInt FontEngine_Freetype::get_glyph_index(unsigned int glyph)
+{
+	const GlyphMetricsPage *page = get_metrics_page(glyph >> 8);
+	return page ? page->glyph_index[glyph & 0xff] : 0;
+}
+
+void FontEngine_Freetype::calculate_kerning_table()
+{
+	if (!FT_HAS_KERNING(face))
+		return;
+
+	kerning_table.resize(kerning_table_size * kerning_table_size);
+
+	const GlyphMetricsPage *page = get_metrics_page(0);
+	for (unsigned int left = 0; left < kerning_table_size; left++)
+	{
+		FT_UInt left_index = page->glyph_index[kerning_table_first + left];
+		for (unsigned int right = 0; right < kerning_table_size; right++)
+		{
+			FT_UInt right_index = page->glyph_index[kerning_table_first + right];
+
+			FT_Vector delta;
+			if (left_index != 0 && right_index != 0 && FT_Get_Kerning(face, left_index, right_index, FT_KERNING_DEFAULT, &delta) == 0)
+				kerning_table[left * kerning_table_size + right] = delta.x / 64.0f / pixel_ratio;
+		}
+	}
+}
+
 void FontEngine_Freetype::calculate_font_metrics()
 {
 	// A glyph has to be loaded to be able to get the scaled metrics information.
@@ -35,6 +35,7 @@
 #include "UICore/Display/Font/font_description.h"
 #include "UICore/Display/Font/font_metrics.h"
 #include "UICore/Core/System/databuffer.h"
+#include <unordered_map>
 
 extern "C"
 {
@@ -82,6 +83,11 @@ public:
 
 	FontPixelBuffer get_font_glyph_subpixel(int glyph);
 	const FontDescription &get_desc() const override { return font_description; }
+
+	bool get_glyph_metrics(unsigned int glyph, GlyphMetrics &out_metrics) override;
+	float get_kerning(unsigned int left_glyph, unsigned int right_glyph) override;
+	std::shared_ptr<FontEngine> create_worker_engine() override;
+	std::string get_cache_key() override;
 	
 /// \}
 /// \name Operations
@@ -95,7 +101,18 @@ public:
 /// \{
 
 private:
+	struct GlyphMetricsPage
+	{
+		FT_UInt glyph_index[256];
+		GlyphMetrics metrics[256];
+	};
+
 	void calculate_font_metrics();
+	const GlyphMetricsPage *get_metrics_page(unsigned int page);
+	FT_UInt get_glyph_index(unsigned int glyph);
+	void calculate_kerning_table();
+	FT_Int32 get_load_flags() const;
+	GlyphMetrics get_slot_metrics(FT_GlyphSlot slot) const;
 	TagStruct get_tag_struct(int cont, int index, FT_Outline *outline);
 	int get_index_of_next_contour_point(int cont, int index, FT_Outline *outline);
 	int get_index_of_prev_contour_point(int cont, int index, FT_Outline *outline);
@@ -110,6 +127,15 @@ private:
 	FontMetrics font_metrics;
 	float pixel_ratio;
 
+	std::vector<std::unique_ptr<GlyphMetricsPage>> metrics_pages;	// Indexed by glyph / 256, created on first use
+
+	static const unsigned int kerning_table_first = 0x20;	// Printable ASCII
+	static const unsigned int kerning_table_size = 0x7f - kerning_table_first;
+	std::vector<float> kerning_table;	// Built on the first kerning lookup of a printable ASCII pair
+	std::unordered_map<uint64_t, float> kerning_pairs;
+
+	std::string data_hash;
+
 /// \}
 
 };
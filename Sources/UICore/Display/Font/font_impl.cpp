@@ -39,8 +39,10 @@
 #include "UICore/Core/Text/string_format.h"
 #include "UICore/Core/Text/utf8_reader.h"
 #include "UICore/Core/IOData/path_help.h"
+#include "UICore/Core/Crypto/hash_functions.h"
 #include "UICore/Display/2D/canvas_impl.h"
 #include "UICore/Display/Font/FontEngine/font_engine.h"
+#include <algorithm>
 
 namespace uicore
 {
@@ -72,7 +74,7 @@ namespace uicore
 				font_cache = font_family->copy_font(new_selected, pixel_ratio);
 
 			font_engine = font_cache.engine.get();
-			GlyphCache *glyph_cache = font_cache.glyph_cache.get();
+			glyph_cache = font_cache.glyph_cache.get();
 			PathCache *path_cache = font_cache.path_cache.get();
 
 			const FontMetrics &metrics = font_engine->get_metrics();
@@ -95,6 +97,7 @@ namespace uicore
 			{
 				font_draw_path.init(path_cache, font_engine, scaled_height);
 				font_draw = &font_draw_path;
+				glyph_cache = nullptr;
 			}
 			else if (scaled_height == 1.0f)
 			{
@@ -131,33 +134,33 @@ namespace uicore
 	{
 	}
 
-	int Font_Impl::character_index(const std::shared_ptr<Canvas> &canvas, const std::string &text, const Pointf &point)
+	const Font_Impl::HitTestText &Font_Impl::hit_test_text(const std::shared_ptr<Canvas> &canvas, const std::string &text)
 	{
-		select_font_family(canvas);
-
-		float dest_x = 0;
-		float dest_y = 0;
+		float line_spacing = std::round(selected_line_height); // TBD: do we want to round this?
 
-		int character_counter = 0;
+		if (hit_test.font_engine == font_engine && hit_test.line_spacing == line_spacing && hit_test.text == text)
+			return hit_test;
 
-		float font_height = selected_metrics.height();
-		float font_ascent = selected_metrics.ascent();
-		float line_spacing = std::round(selected_line_height); // TBD: do we want to round this?
+		hit_test.text = text;
+		hit_test.font_engine = font_engine;
+		hit_test.line_spacing = line_spacing;
+		hit_test.lines.clear();
 
-		//TODO: Fix me, so we do not need to line split
+		float dest_y = 0;
 
-		std::vector<std::string> lines = Text::split(text, "\n", false);
-		for (std::vector<std::string>::size_type i = 0; i < lines.size(); i++)
+		std::string::size_type line_start = 0;
+		while (line_start < text.length())
 		{
-			float xpos = dest_x;
-			float ypos = dest_y;
-
-			std::string &textline = lines[i];
-			std::string::size_type string_length = textline.length();
+			std::string::size_type line_end = text.find('\n', line_start);
+			if (line_end == std::string::npos)
+				line_end = text.length();
 
-			// Scan the string
+			hit_test.lines.push_back(HitTestLine());
+			HitTestLine &line = hit_test.lines.back();
+			line.y = dest_y;
 
-			UTF8_Reader reader(textline.data(), textline.length());
+			float xpos = 0;
+			UTF8_Reader reader(text.data() + line_start, line_end - line_start);
 			while (!reader.is_end())
 			{
 				unsigned int glyph = reader.character();
@@ -165,20 +168,40 @@ namespace uicore
 				reader.next();
 
 				GlyphMetrics metrics = font_draw->get_metrics(canvas, glyph);
-
-				Rectf position(xpos, ypos - font_ascent, Sizef(metrics.advance.width, metrics.advance.height + font_height));
-				if (position.contains(point))
-				{
-					return glyph_pos + character_counter;
-				}
-
+				line.offsets.push_back(line_start + glyph_pos);
+				line.positions.push_back(xpos);
+				line.advances.push_back(metrics.advance);
 				xpos += metrics.advance.width;
-				ypos += metrics.advance.height;
 			}
 
 			dest_y += line_spacing;
+			line_start = line_end + 1;
+		}
 
-			character_counter += string_length + 1;		// (Including the '\n')
+		return hit_test;
+	}
+
+	int Font_Impl::character_index(const std::shared_ptr<Canvas> &canvas, const std::string &text, const Pointf &point)
+	{
+		select_font_family(canvas);
+
+		float font_height = selected_metrics.height();
+		float font_ascent = selected_metrics.ascent();
+
+		for (const HitTestLine &line : hit_test_text(canvas, text).lines)
+		{
+			if (line.positions.empty() || point.y < line.y - font_ascent)
+				continue;
+
+			// Last glyph starting at or before the point
+			auto it = std::upper_bound(line.positions.begin(), line.positions.end(), point.x);
+			if (it == line.positions.begin())
+				continue;
+			size_t index = it - line.positions.begin() - 1;
+
+			Rectf position(line.positions[index], line.y - font_ascent, Sizef(line.advances[index].width, line.advances[index].height + font_height));
+			if (position.contains(point))
+				return line.offsets[index];
 		}
 		return -1;	// Not found
 	}
@@ -188,42 +211,23 @@ namespace uicore
 		select_font_family(canvas);
 		std::vector<Rectf> index_store;
 
-		float dest_x = 0;
-		float dest_y = 0;
-
 		float font_height = selected_metrics.height();
 		float font_ascent = selected_metrics.ascent();
-		float line_spacing = std::round(selected_line_height); // TBD: do we want to round this?
 
-		//TODO: Fix me, so we do not need to line split
-
-		std::vector<std::string> lines = Text::split(text, "\n", false);
-		for (std::vector<std::string>::size_type i = 0; i < lines.size(); i++)
+		const HitTestText &shaped = hit_test_text(canvas, text);
+		for (size_t i = 0; i < shaped.lines.size(); i++)
 		{
-			float xpos = dest_x;
-			float ypos = dest_y;
-
-			std::string &textline = lines[i];
+			const HitTestLine &line = shaped.lines[i];
 
-			// Scan the string
-
-			UTF8_Reader reader(textline.data(), textline.length());
-			while (!reader.is_end())
+			float ypos = line.y;
+			for (size_t j = 0; j < line.positions.size(); j++)
 			{
-				unsigned int glyph = reader.character();
-				reader.next();
-
-				GlyphMetrics metrics = font_draw->get_metrics(canvas, glyph);
-
-				Rectf position(xpos, ypos - font_ascent, Sizef(metrics.advance.width, metrics.advance.height + font_height));
+				Rectf position(line.positions[j], ypos - font_ascent, Sizef(line.advances[j].width, line.advances[j].height + font_height));
 				index_store.push_back(position);
-				xpos += metrics.advance.width;
-				ypos += metrics.advance.height;
+				ypos += line.advances[j].height;
 			}
 
-			dest_y += line_spacing;
-
-			if (i != lines.size() - 1)
+			if (i != shaped.lines.size() - 1)
 				index_store.push_back(Rect());	// Store the '\n' as a empty rect
 		}
 		return index_store;
@@ -249,6 +253,38 @@ namespace uicore
 		return nullptr;
 	}
 
+	void Font_Impl::prepare_glyphs(const std::shared_ptr<Canvas> &canvas, const std::string &characters)
+	{
+		select_font_family(canvas);
+		if (glyph_cache)
+			glyph_cache->prepare_glyphs(font_engine, characters);
+	}
+
+	void Font_Impl::save_glyph_cache(const std::shared_ptr<Canvas> &canvas, const std::string &directory)
+	{
+		select_font_family(canvas);
+		std::string filename = glyph_cache_filename(directory);
+		if (glyph_cache && !filename.empty())
+			glyph_cache->save(canvas, filename, font_engine->get_cache_key());
+	}
+
+	bool Font_Impl::load_glyph_cache(const std::shared_ptr<Canvas> &canvas, const std::string &directory)
+	{
+		select_font_family(canvas);
+		std::string filename = glyph_cache_filename(directory);
+		if (glyph_cache && !filename.empty())
+			return glyph_cache->load(canvas, filename, font_engine->get_cache_key());
+		return false;
+	}
+
+	std::string Font_Impl::glyph_cache_filename(const std::string &directory)
+	{
+		std::string cache_key = font_engine->get_cache_key();
+		if (cache_key.empty())
+			return std::string();
+		return FilePath::combine(directory, HashFunctions::sha1(cache_key) + ".glyphcache");
+	}
+
 	void Font_Impl::draw_text(const std::shared_ptr<Canvas> &canvas, const Pointf &position, const std::string &text, const Colorf &color)
 	{
 		select_font_family(canvas);
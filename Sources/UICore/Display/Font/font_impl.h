@@ -70,11 +70,33 @@ namespace uicore
 		int character_index(const std::shared_ptr<Canvas> &canvas, const std::string &text, const Pointf &point) override;
 		std::vector<Rectf> character_indices(const std::shared_ptr<Canvas> &canvas, const std::string &text) override;
 		FontHandle *handle(const std::shared_ptr<Canvas> &canvas) override;
+		void prepare_glyphs(const std::shared_ptr<Canvas> &canvas, const std::string &characters) override;
+		void save_glyph_cache(const std::shared_ptr<Canvas> &canvas, const std::string &directory) override;
+		bool load_glyph_cache(const std::shared_ptr<Canvas> &canvas, const std::string &directory) override;
 
 		void glyph_path(const std::shared_ptr<Canvas> &canvas, unsigned int glyph_index, const std::shared_ptr<Path> &out_path, GlyphMetrics &out_metrics);
 
 	private:
+		/// \brief Pen positions for one line of the text last passed to character_index or character_indices
+		struct HitTestLine
+		{
+			float y = 0.0f;
+			std::vector<std::string::size_type> offsets;	// Byte offset of each glyph in the text
+			std::vector<float> positions;	// Pen position of each glyph, in ascending order
+			std::vector<Sizef> advances;
+		};
+
+		struct HitTestText
+		{
+			std::string text;
+			FontEngine *font_engine = nullptr;
+			float line_spacing = 0.0f;
+			std::vector<HitTestLine> lines;
+		};
+
 		void select_font_family(const std::shared_ptr<Canvas> &canvas);
+		std::string glyph_cache_filename(const std::string &directory);
+		const HitTestText &hit_test_text(const std::shared_ptr<Canvas> &canvas, const std::string &text);
 
 		FontDescription selected_description;
 		float selected_line_height = 0.0f;
@@ -86,6 +108,7 @@ namespace uicore
 		FontMetrics selected_metrics;
 
 		FontEngine *font_engine = nullptr;	// If null, use select_font_family() to update
+		GlyphCache *glyph_cache = nullptr;	// Null if the font is drawn using paths
 		std::shared_ptr<FontFamily_Impl> font_family;
 
 		Font_Draw *font_draw = nullptr;
@@ -94,5 +117,7 @@ namespace uicore
 		Font_DrawFlat font_draw_flat;
 		Font_DrawScaled font_draw_scaled;
 		Font_DrawPath font_draw_path;
+
+		HitTestText hit_test;	// Reused while the text and font stays the same
 	};
 }
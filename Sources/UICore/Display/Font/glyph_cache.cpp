@@ -42,6 +42,8 @@
 #include "UICore/Core/Text/text.h"
 #include "UICore/Core/Text/utf8_reader.h"
 #include "UICore/Display/2D/render_batch_triangle.h"
+#include "UICore/Display/2D/canvas_impl.h"
+#include "UICore/Core/IOData/file.h"
 
 namespace uicore
 {
@@ -52,31 +54,42 @@ namespace uicore
 
 	GlyphCache::~GlyphCache()
 	{
+		std::unique_lock<std::mutex> lock(prepare_mutex);
+		prepare_stop = true;
+		lock.unlock();
+
+		if (prepare_thread.joinable())
+			prepare_thread.join();
 	}
 
 	Font_TextureGlyph *GlyphCache::get_glyph(const std::shared_ptr<Canvas> &canvas, FontEngine *font_engine, unsigned int glyph)
 	{
-		auto size = glyph_list.size();
-		for (int cnt = 0; cnt < size; cnt++)
+		Font_TextureGlyph *gptr = find_glyph(glyph);
+		if (!gptr)
 		{
-			if (glyph_list[cnt]->glyph == glyph)
-				return &(*glyph_list[cnt]);
+			// If glyph does not exist, create one automatically
+			FontPixelBuffer pb;
+			if (!take_prepared_glyph(glyph, pb))
+				pb = font_engine->get_font_glyph(glyph);
+			if (pb.glyph)	// Ignore invalid glyphs
+				insert_glyph(canvas, pb);
+
+			// Search for the glyph again
+			gptr = find_glyph(glyph);
 		}
 
-		// If glyph does not exist, create one automatically
-		FontPixelBuffer pb = font_engine->get_font_glyph(glyph);
-		if (pb.glyph)	// Ignore invalid glyphs
-			insert_glyph(canvas, pb);
+		// The texture group is shared by every canvas using the font family. Glyphs inserted through another
+		// canvas may still be waiting for their upload, so the canvas drawing them must flush the group too
+		if (gptr && gptr->texture && texture_group->has_pending_uploads())
+			static_cast<CanvasImpl*>(canvas.get())->batcher.add_pending_uploads(texture_group);
 
-		// Search for the glyph again
-		size = glyph_list.size();
-		for (int cnt = 0; cnt < size; cnt++)
-		{
-			if (glyph_list[cnt]->glyph == glyph)
-				return &(*glyph_list[cnt]);
-		}
+		return gptr;
+	}
 
-		return nullptr;
+	Font_TextureGlyph *GlyphCache::find_glyph(unsigned int glyph)
+	{
+		auto it = glyph_lookup.find(glyph);
+		return it != glyph_lookup.end() ? it->second : nullptr;
 	}
 
 	void GlyphCache::set_texture_group(const std::shared_ptr<TextureGroup> &new_texture_group)
@@ -86,6 +99,11 @@ namespace uicore
 
 	GlyphMetrics GlyphCache::get_metrics(FontEngine *font_engine, const std::shared_ptr<Canvas> &canvas, unsigned int glyph)
 	{
+		// Use the metrics tables of the engine when available, so measuring text does not need to render the glyphs
+		GlyphMetrics metrics;
+		if (font_engine->get_glyph_metrics(glyph, metrics))
+			return metrics;
+
 		Font_TextureGlyph *gptr = get_glyph(canvas, font_engine, glyph);
 		if (gptr)
 		{
@@ -110,9 +128,12 @@ namespace uicore
 			font_glyph->texture = sub_texture.texture();
 			font_glyph->geometry = Rect(sub_texture.geometry().left + glyph_border_size, sub_texture.geometry().top + glyph_border_size, pb.buffer_rect.size());
 			font_glyph->size = pb.size;
-			sub_texture.texture()->set_subimage(gc, sub_texture.geometry().left, sub_texture.geometry().top, buffer_with_border, buffer_with_border->size());
+
+			// The upload is batched with the other glyphs added before the canvas draws the next batch
+			texture_group->set_subimage(gc, sub_texture, buffer_with_border);
 		}
 
+		glyph_lookup[font_glyph->glyph] = font_glyph.get();
 		glyph_list.push_back(std::move(font_glyph));
 	}
 
@@ -131,6 +152,266 @@ namespace uicore
 			font_glyph->geometry = sub_texture.geometry();
 		}
 
+		glyph_lookup[font_glyph->glyph] = font_glyph.get();
 		glyph_list.push_back(std::move(font_glyph));
 	}
+
+	void GlyphCache::prepare_glyphs(FontEngine *font_engine, const std::string &characters)
+	{
+		std::vector<unsigned int> glyphs;
+		UTF8_Reader reader(characters.data(), characters.length());
+		while (!reader.is_end())
+		{
+			unsigned int glyph = reader.character();
+			reader.next();
+			if (!find_glyph(glyph))
+				glyphs.push_back(glyph);
+		}
+
+		if (glyphs.empty())
+			return;
+
+		std::unique_lock<std::mutex> lock(prepare_mutex);
+		prepare_queue.insert(prepare_queue.end(), glyphs.rbegin(), glyphs.rend());	// The thread takes glyphs from the back
+		if (!prepare_thread_running)
+		{
+			if (prepare_thread.joinable())	// Finished with the previous queue
+				prepare_thread.join();
+			prepare_thread_running = true;
+			prepare_thread = std::thread(&GlyphCache::prepare_main, this, font_engine);
+		}
+	}
+
+	void GlyphCache::prepare_main(FontEngine *font_engine)
+	{
+		if (!prepare_engine)
+			prepare_engine = font_engine->create_worker_engine();
+
+		while (true)
+		{
+			std::unique_lock<std::mutex> lock(prepare_mutex);
+			if (prepare_stop || prepare_queue.empty() || !prepare_engine)
+			{
+				prepare_queue.clear();
+				prepare_thread_running = false;
+				break;
+			}
+
+			unsigned int glyph = prepare_queue.back();
+			prepare_queue.pop_back();
+			if (prepared_glyphs.find(glyph) != prepared_glyphs.end())
+				continue;
+			lock.unlock();
+
+			FontPixelBuffer pb = prepare_engine->get_font_glyph(glyph);
+
+			lock.lock();
+			prepared_glyphs[glyph] = pb;
+		}
+	}
+
+	bool GlyphCache::take_prepared_glyph(unsigned int glyph, FontPixelBuffer &out_pb)
+	{
+		std::unique_lock<std::mutex> lock(prepare_mutex);
+		auto it = prepared_glyphs.find(glyph);
+		if (it == prepared_glyphs.end())
+			return false;
+
+		out_pb = it->second;
+		prepared_glyphs.erase(it);
+		return true;
+	}
+
+	void GlyphCache::save(const std::shared_ptr<Canvas> &canvas, const std::string &filename, const std::string &cache_key)
+	{
+		struct SavedGlyph
+		{
+			Font_TextureGlyph *glyph;
+			int page;
+			Rect geometry;
+		};
+
+		std::shared_ptr<GraphicContext> gc = canvas->gc();
+		std::map<Texture2D *, std::shared_ptr<PixelBuffer>> atlas_images;
+		std::vector<std::shared_ptr<PixelBuffer>> pages;
+		std::vector<SavedGlyph> saved_glyphs;
+
+		if (texture_group)
+			texture_group->flush_uploads(gc);
+
+		// Pack the glyphs into new pages, row by row
+		int x = 0, y = 0, row_height = 0;
+		for (auto &font_glyph : glyph_list)
+		{
+			SavedGlyph saved = { font_glyph.get(), -1, Rect() };
+
+			if (font_glyph->texture)
+			{
+				Rect src_rect = font_glyph->geometry;
+				src_rect.expand(glyph_border_size);
+				if (src_rect.width() > cache_page_size || src_rect.height() > cache_page_size)
+					continue;
+
+				std::shared_ptr<PixelBuffer> &atlas_image = atlas_images[font_glyph->texture.get()];
+				if (!atlas_image)
+					atlas_image = font_glyph->texture->pixeldata(gc, tf_rgba8);
+
+				if (x + src_rect.width() > cache_page_size)
+				{
+					x = 0;
+					y += row_height;
+					row_height = 0;
+				}
+
+				if (pages.empty() || y + src_rect.height() > cache_page_size)
+				{
+					pages.push_back(PixelBuffer::create(cache_page_size, cache_page_size, tf_rgba8));
+					memset(pages.back()->data(), 0, pages.back()->data_size());
+					x = 0;
+					y = 0;
+					row_height = 0;
+				}
+
+				pages.back()->set_subimage(atlas_image, Point(x, y), src_rect);
+				saved.page = (int)pages.size() - 1;
+				saved.geometry = Rect(x + glyph_border_size, y + glyph_border_size, font_glyph->geometry.size());
+
+				x += src_rect.width();
+				row_height = std::max(row_height, src_rect.height());
+			}
+
+			saved_glyphs.push_back(saved);
+		}
+
+		if (pages.size() > max_cache_pages)
+			return;
+
+		auto file = File::create_always(filename);
+		file->write("UIGC", 4);
+		file->write_uint32(file_version);
+		file->write_uint32(cache_key.length());
+		file->write(cache_key.data(), cache_key.length());
+
+		file->write_uint32(cache_page_size);
+		file->write_uint32(pages.size());
+		for (auto &page : pages)
+		{
+			for (int row = 0; row < cache_page_size; row++)
+				file->write(page->line(row), cache_page_size * 4);
+		}
+
+		file->write_uint32(saved_glyphs.size());
+		for (auto &saved : saved_glyphs)
+		{
+			file->write_uint32(saved.glyph->glyph);
+			file->write_int32(saved.page);
+			file->write_int32(saved.geometry.left);
+			file->write_int32(saved.geometry.top);
+			file->write_int32(saved.geometry.right);
+			file->write_int32(saved.geometry.bottom);
+			file->write_float(saved.glyph->offset.x);
+			file->write_float(saved.glyph->offset.y);
+			file->write_float(saved.glyph->size.width);
+			file->write_float(saved.glyph->size.height);
+			file->write_float(saved.glyph->metrics.bbox_offset.x);
+			file->write_float(saved.glyph->metrics.bbox_offset.y);
+			file->write_float(saved.glyph->metrics.bbox_size.width);
+			file->write_float(saved.glyph->metrics.bbox_size.height);
+			file->write_float(saved.glyph->metrics.advance.width);
+			file->write_float(saved.glyph->metrics.advance.height);
+		}
+	}
+
+	bool GlyphCache::load(const std::shared_ptr<Canvas> &canvas, const std::string &filename, const std::string &cache_key)
+	{
+		if (!File::exists(filename))
+			return false;
+
+		try
+		{
+			auto file = File::open_existing(filename);
+
+			char magic[4];
+			file->read(magic, 4);
+			if (memcmp(magic, "UIGC", 4) != 0 || file->read_uint32() != file_version)
+				return false;
+
+			uint32_t key_length = file->read_uint32();
+			if (key_length != cache_key.length())
+				return false;
+			std::string key;
+			key.resize(key_length);
+			file->read(&key[0], key.length());
+			if (key != cache_key)
+				return false;
+
+			// Counts are checked against the file size, so a corrupt file cannot request huge allocations
+			if (file->read_uint32() != (uint32_t)cache_page_size)
+				throw Exception("Glyph cache page size mismatch");
+
+			long long page_bytes = (long long)cache_page_size * cache_page_size * 4;
+			uint32_t num_pages = file->read_uint32();
+			if (num_pages > max_cache_pages || num_pages * page_bytes > file->size() - file->position())
+				throw Exception("Invalid glyph cache page count");
+
+			std::shared_ptr<GraphicContext> gc = canvas->gc();
+
+			// Each page becomes one texture, uploaded in a single call
+			std::vector<std::shared_ptr<Texture2D>> page_textures(num_pages);
+			auto page = PixelBuffer::create(cache_page_size, cache_page_size, tf_rgba8);
+			for (auto &texture : page_textures)
+			{
+				for (int row = 0; row < cache_page_size; row++)
+					file->read(page->line(row), cache_page_size * 4);
+				texture = Texture2D::create(gc, page);
+			}
+
+			const long long glyph_record_size = 16 * 4;
+			uint32_t num_glyphs = file->read_uint32();
+			if (num_glyphs * glyph_record_size > file->size() - file->position())
+				throw Exception("Invalid glyph cache glyph count");
+
+			for (uint32_t i = 0; i < num_glyphs; i++)
+			{
+				unsigned int glyph = file->read_uint32();
+				int page_index = file->read_int32();
+				Rect geometry;
+				geometry.left = file->read_int32();
+				geometry.top = file->read_int32();
+				geometry.right = file->read_int32();
+				geometry.bottom = file->read_int32();
+				Pointf offset;
+				offset.x = file->read_float();
+				offset.y = file->read_float();
+				Sizef size;
+				size.width = file->read_float();
+				size.height = file->read_float();
+				GlyphMetrics metrics;
+				metrics.bbox_offset.x = file->read_float();
+				metrics.bbox_offset.y = file->read_float();
+				metrics.bbox_size.width = file->read_float();
+				metrics.bbox_size.height = file->read_float();
+				metrics.advance.width = file->read_float();
+				metrics.advance.height = file->read_float();
+
+				if (find_glyph(glyph))
+					continue;
+
+				TextureGroupImage sub_texture;
+				if (page_index >= 0 && page_index < (int)page_textures.size())
+				{
+					if (geometry.left < 0 || geometry.top < 0 || geometry.right > cache_page_size || geometry.bottom > cache_page_size || geometry.left > geometry.right || geometry.top > geometry.bottom)
+						throw Exception("Invalid glyph cache glyph geometry");
+					sub_texture = TextureGroupImage(page_textures[page_index], geometry);
+				}
+				insert_glyph(canvas, glyph, sub_texture, offset, size, metrics);
+			}
+		}
+		catch (const Exception &)
+		{
+			return false;
+		}
+
+		return true;
+	}
 }
@@ -34,8 +34,12 @@
 #include "UICore/Display/Render/texture.h"
 #include "UICore/Display/2D/texture_group.h"
 #include "UICore/Display/Render/texture_2d.h"
+#include "FontEngine/font_engine.h"
 #include <list>
 #include <map>
+#include <unordered_map>
+#include <thread>
+#include <mutex>
 
 namespace uicore
 {
@@ -93,10 +97,36 @@ namespace uicore
 
 		void set_texture_group(const std::shared_ptr<TextureGroup> &new_texture_group);
 
+		/// \brief Renders the glyphs on a background thread. They are added to the cache when first requested
+		void prepare_glyphs(FontEngine *font_engine, const std::string &characters);
+
+		/// \brief Saves the cached glyphs as atlas pages and glyph metadata
+		void save(const std::shared_ptr<Canvas> &canvas, const std::string &filename, const std::string &cache_key);
+
+		/// \brief Loads glyphs saved by save(). Returns false if the file is missing or was saved for another cache key
+		bool load(const std::shared_ptr<Canvas> &canvas, const std::string &filename, const std::string &cache_key);
+
 	private:
+		Font_TextureGlyph *find_glyph(unsigned int glyph);
+		bool take_prepared_glyph(unsigned int glyph, FontPixelBuffer &out_pb);
+		void prepare_main(FontEngine *font_engine);
+
 		std::vector<std::unique_ptr<Font_TextureGlyph>> glyph_list;
+		std::unordered_map<unsigned int, Font_TextureGlyph *> glyph_lookup;
 		std::shared_ptr<TextureGroup> texture_group;
 
+		std::thread prepare_thread;
+		std::mutex prepare_mutex;
+		bool prepare_thread_running = false;
+		bool prepare_stop = false;
+		std::vector<unsigned int> prepare_queue;
+		std::unordered_map<unsigned int, FontPixelBuffer> prepared_glyphs;
+		std::shared_ptr<FontEngine> prepare_engine;	// Only accessed by the prepare thread
+
+		static const int cache_page_size = 512;
+		static const unsigned int file_version = 2;
+		static const unsigned int max_cache_pages = 256;
+
 		static const int glyph_border_size = 1;
 	};
 }
@@ -30,6 +30,7 @@
 #include "UICore/precomp.h"
 #include "cpu_pixel_buffer_provider.h"
 #include "UICore/Core/System/system.h"
+#include "pixel_buffer_pool.h"
 
 namespace uicore
 {
@@ -51,23 +52,16 @@ namespace uicore
 		}
 		else
 		{
+			delete_data = true;
+			_data = (unsigned char *)PixelBufferPool::alloc(alloc_size, _capacity);
 			if (data_ptr)
-			{
-				delete_data = true;
-				_data = (unsigned char *)System::aligned_alloc(alloc_size, 16);
 				memcpy(_data, data_ptr, alloc_size);
-			}
-			else
-			{
-				delete_data = true;
-				_data = (unsigned char *)System::aligned_alloc(alloc_size, 16);
-			}
 		}
 	}
 
 	CPUPixelBufferProvider::~CPUPixelBufferProvider()
 	{
 		if (delete_data)
-			System::aligned_free(_data);
+			PixelBufferPool::free(_data, _capacity);
 	}
 }
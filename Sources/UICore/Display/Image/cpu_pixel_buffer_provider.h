@@ -54,6 +54,7 @@ namespace uicore
 	private:
 		bool delete_data = true;
 		unsigned char *_data = nullptr;
+		size_t _capacity = 0;
 
 		int _width = 0;
 		int _height = 0;
@@ -62,6 +62,16 @@ namespace uicore
 		return impl->cached;
 	}
 
+	int ImageImportDescription::decode_scale() const
+	{
+		return impl->decode_scale;
+	}
+
+	bool ImageImportDescription::mipmaps() const
+	{
+		return impl->mipmaps;
+	}
+
 	void ImageImportDescription::set_premultiply_alpha(bool enable)
 	{
 		impl->premultiply_alpha = enable;
@@ -82,6 +92,18 @@ namespace uicore
 		impl->cached = enable;
 	}
 
+	void ImageImportDescription::set_mipmaps(bool enable)
+	{
+		impl->mipmaps = enable;
+	}
+
+	void ImageImportDescription::set_decode_scale(int denominator)
+	{
+		if (denominator != 1 && denominator != 2 && denominator != 4 && denominator != 8)
+			throw Exception("Decode scale must be 1, 2, 4 or 8");
+		impl->decode_scale = denominator;
+	}
+
 	std::shared_ptr<PixelBuffer> ImageImportDescription::process(std::shared_ptr<PixelBuffer> image) const
 	{
 		if (impl->premultiply_alpha)
@@ -39,6 +39,8 @@ namespace uicore
 		bool flip_vertical = false;
 		bool srgb = false;
 		bool cached = false;
+		int decode_scale = 1;
+		bool mipmaps = false;
 
 		std::function<std::shared_ptr<PixelBuffer>(std::shared_ptr<PixelBuffer>)> func_process;
 	};
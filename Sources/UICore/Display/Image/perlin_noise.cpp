@@ -28,7 +28,20 @@
 
 #include "UICore/precomp.h"
 #include "UICore/Display/Image/perlin_noise.h"
+#include "UICore/Core/System/system.h"
+#include "UICore/Core/System/thread_pool.h"
+#include <algorithm>
 #include <cstdlib>
+#include <vector>
+
+#if !defined __ANDROID__ && ! defined CL_DISABLE_SSE2
+#define USE_SSE2
+#include <emmintrin.h>
+#if defined(_MSC_VER) || defined(__AVX2__) || defined(__GNUC__)
+#define USE_AVX2
+#include <immintrin.h>
+#endif
+#endif
 
 // This perlin noise code is based from ideas from numerious sources, including
 // The original perlin noise example code
@@ -53,136 +66,233 @@
 
 namespace uicore
 {
-	class PerlinNoise_PixelWriter
+	struct PerlinNoiseRowParams
 	{
-	public:
-		virtual void line_end() = 0;
-		virtual void write_pixel(float value) = 0;
+		const unsigned char *permutations;
+		int width;
+		int height;
+		int octaves;
+		float amplitude;
+		float start_x;
+		float size_x;
+		float start_y;
+		float size_y;
+		float z_position;
+		float w_position;
 	};
+}
 
-	class PerlinNoise_PixelWriter_RGBA8 : public PerlinNoise_PixelWriter
+#ifdef USE_SSE2
+namespace uicore
+{
+	namespace perlin_sse2
 	{
-	public:
-		PerlinNoise_PixelWriter_RGBA8(const std::shared_ptr<PixelBuffer> &pbuff)
-			: pitch(pbuff->pitch() / pbuff->bytes_per_pixel()),
-			current_ptr((uint32_t *)pbuff->data()),
-			line_start_ptr(current_ptr)
+		typedef __m128 F;
+		typedef __m128i I;
+		const int lanes = 4;
+
+		inline F set1(float v) { return _mm_set1_ps(v); }
+		inline I set1i(int v) { return _mm_set1_epi32(v); }
+		inline I lane_indices() { return _mm_setr_epi32(0, 1, 2, 3); }
+		inline F add(F a, F b) { return _mm_add_ps(a, b); }
+		inline F sub(F a, F b) { return _mm_sub_ps(a, b); }
+		inline F mul(F a, F b) { return _mm_mul_ps(a, b); }
+		inline F div(F a, F b) { return _mm_div_ps(a, b); }
+		inline I addi(I a, I b) { return _mm_add_epi32(a, b); }
+		inline I andi(I a, I b) { return _mm_and_si128(a, b); }
+		inline I cmpeqi(I a, I b) { return _mm_cmpeq_epi32(a, b); }
+		inline I cmplti(I a, I b) { return _mm_cmplt_epi32(a, b); }
+		inline F to_float(I v) { return _mm_cvtepi32_ps(v); }
+		inline void store(float *dest, F v) { _mm_storeu_ps(dest, v); }
+
+		inline F select(I mask, F a, F b)
 		{
+			F m = _mm_castsi128_ps(mask);
+			return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b));
 		}
 
-		void line_end() override
+		inline F negate_if(I mask, F v)
 		{
-			line_start_ptr += pitch;
-			current_ptr = line_start_ptr;
+			return _mm_xor_ps(v, _mm_and_ps(_mm_castsi128_ps(mask), _mm_set1_ps(-0.0f)));
 		}
 
-		void write_pixel(float value) override
+		// Same rounding as cl_floor_to_int: truncate, then subtract one unless the value is positive
+		inline I floor_to_int(F v)
 		{
-			int color = (int)((value*128.0f) + 128.0f);
-			if (color > 255)
-				color = 255;
-			if (color < 0)
-				color = 0;
+			I positive = _mm_castps_si128(_mm_cmpgt_ps(v, _mm_setzero_ps()));
+			return _mm_sub_epi32(_mm_sub_epi32(_mm_cvttps_epi32(v), positive), _mm_set1_epi32(1));
+		}
 
-			*(current_ptr++) = color << 24 | color << 16 | color << 8 | color;
+		inline I permute(const unsigned char *perm, I index)
+		{
+			alignas(16) int i[4];
+			_mm_store_si128((__m128i*)i, index);
+			return _mm_setr_epi32(perm[i[0]], perm[i[1]], perm[i[2]], perm[i[3]]);
 		}
-	private:
-		int pitch;
-		uint32_t *current_ptr;
-		uint32_t *line_start_ptr;
-	};
 
-	class PerlinNoise_PixelWriter_RGB8 : public PerlinNoise_PixelWriter
+#include "perlin_noise_simd.h"
+	}
+}
+#endif
+
+#ifdef USE_AVX2
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("avx2"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#endif
+namespace uicore
+{
+	namespace perlin_avx2
 	{
-	public:
-		PerlinNoise_PixelWriter_RGB8(const std::shared_ptr<PixelBuffer> &pbuff)
-			: pitch(pbuff->pitch()),
-			current_ptr((uint8_t *)pbuff->data()),
-			line_start_ptr(current_ptr)
+		typedef __m256 F;
+		typedef __m256i I;
+		const int lanes = 8;
+
+		inline F set1(float v) { return _mm256_set1_ps(v); }
+		inline I set1i(int v) { return _mm256_set1_epi32(v); }
+		inline I lane_indices() { return _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7); }
+		inline F add(F a, F b) { return _mm256_add_ps(a, b); }
+		inline F sub(F a, F b) { return _mm256_sub_ps(a, b); }
+		inline F mul(F a, F b) { return _mm256_mul_ps(a, b); }
+		inline F div(F a, F b) { return _mm256_div_ps(a, b); }
+		inline I addi(I a, I b) { return _mm256_add_epi32(a, b); }
+		inline I andi(I a, I b) { return _mm256_and_si256(a, b); }
+		inline I cmpeqi(I a, I b) { return _mm256_cmpeq_epi32(a, b); }
+		inline I cmplti(I a, I b) { return _mm256_cmpgt_epi32(b, a); }
+		inline F to_float(I v) { return _mm256_cvtepi32_ps(v); }
+		inline void store(float *dest, F v) { _mm256_storeu_ps(dest, v); }
+
+		inline F select(I mask, F a, F b)
 		{
+			return _mm256_blendv_ps(b, a, _mm256_castsi256_ps(mask));
 		}
 
-		void line_end() override
+		inline F negate_if(I mask, F v)
 		{
-			line_start_ptr += pitch;
-			current_ptr = line_start_ptr;
+			return _mm256_xor_ps(v, _mm256_and_ps(_mm256_castsi256_ps(mask), _mm256_set1_ps(-0.0f)));
 		}
 
-		void write_pixel(float value) override
+		inline I floor_to_int(F v)
+		{
+			I positive = _mm256_castps_si256(_mm256_cmp_ps(v, _mm256_setzero_ps(), _CMP_GT_OQ));
+			return _mm256_sub_epi32(_mm256_sub_epi32(_mm256_cvttps_epi32(v), positive), _mm256_set1_epi32(1));
+		}
+
+		// Gathers 32 bits at each byte offset and keeps the low byte. The table is padded to make the over-read safe.
+		inline I permute(const unsigned char *perm, I index)
+		{
+			return _mm256_and_si256(_mm256_i32gather_epi32((const int *)perm, index, 1), _mm256_set1_epi32(0xff));
+		}
+
+#include "perlin_noise_simd.h"
+	}
+}
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+#endif
+
+namespace uicore
+{
+	class PerlinNoise_PixelWriter
+	{
+	public:
+		PerlinNoise_PixelWriter(const std::shared_ptr<PixelBuffer> &pbuff) : pbuff(pbuff) { }
+		virtual ~PerlinNoise_PixelWriter() { }
+		virtual void write_line(int y, const float *values) = 0;
+
+		static std::unique_ptr<PerlinNoise_PixelWriter> create(const std::shared_ptr<PixelBuffer> &pbuff);
+
+	protected:
+		static int to_color(float value)
 		{
 			int color = (int)((value*128.0f) + 128.0f);
 			if (color > 255)
 				color = 255;
 			if (color < 0)
 				color = 0;
-
-			*(current_ptr++) = color;
-			*(current_ptr++) = color;
-			*(current_ptr++) = color;
+			return color;
 		}
-	private:
-		int pitch;
-		uint8_t *current_ptr;
-		uint8_t *line_start_ptr;
+
+		std::shared_ptr<PixelBuffer> pbuff;
 	};
 
-	class PerlinNoise_PixelWriter_R8 : public PerlinNoise_PixelWriter
+	class PerlinNoise_PixelWriter_RGBA8 : public PerlinNoise_PixelWriter
 	{
 	public:
-		PerlinNoise_PixelWriter_R8(const std::shared_ptr<PixelBuffer> &pbuff)
-			: pitch(pbuff->pitch()),
-			current_ptr((uint8_t *)pbuff->data()),
-			line_start_ptr(current_ptr)
+		using PerlinNoise_PixelWriter::PerlinNoise_PixelWriter;
+
+		void write_line(int y, const float *values) override
 		{
+			uint32_t *dest = pbuff->line<uint32_t>(y);
+			int width = pbuff->width();
+			for (int x = 0; x < width; x++)
+			{
+				uint32_t color = to_color(values[x]);
+				dest[x] = color << 24 | color << 16 | color << 8 | color;
+			}
 		}
+	};
 
-		void line_end() override
+	class PerlinNoise_PixelWriter_RGB8 : public PerlinNoise_PixelWriter
+	{
+	public:
+		using PerlinNoise_PixelWriter::PerlinNoise_PixelWriter;
+
+		void write_line(int y, const float *values) override
 		{
-			line_start_ptr += pitch;
-			current_ptr = line_start_ptr;
+			uint8_t *dest = pbuff->line_uint8(y);
+			int width = pbuff->width();
+			for (int x = 0; x < width; x++)
+			{
+				uint8_t color = to_color(values[x]);
+				*(dest++) = color;
+				*(dest++) = color;
+				*(dest++) = color;
+			}
 		}
+	};
 
-		void write_pixel(float value) override
-		{
-			int color = (int)((value*128.0f) + 128.0f);
-			if (color > 255)
-				color = 255;
-			if (color < 0)
-				color = 0;
+	class PerlinNoise_PixelWriter_R8 : public PerlinNoise_PixelWriter
+	{
+	public:
+		using PerlinNoise_PixelWriter::PerlinNoise_PixelWriter;
 
-			*(current_ptr++) = color;
+		void write_line(int y, const float *values) override
+		{
+			uint8_t *dest = pbuff->line_uint8(y);
+			int width = pbuff->width();
+			for (int x = 0; x < width; x++)
+				dest[x] = to_color(values[x]);
 		}
-	private:
-		int pitch;
-		uint8_t *current_ptr;
-		uint8_t *line_start_ptr;
 	};
 
 	class PerlinNoise_PixelWriter_R32f : public PerlinNoise_PixelWriter
 	{
 	public:
-		PerlinNoise_PixelWriter_R32f(const std::shared_ptr<PixelBuffer> &pbuff)
-			: pitch(pbuff->pitch() / sizeof(float)),
-			current_ptr((float *)pbuff->data()),
-			line_start_ptr(current_ptr)
-		{
-		}
+		using PerlinNoise_PixelWriter::PerlinNoise_PixelWriter;
 
-		void line_end() override
+		void write_line(int y, const float *values) override
 		{
-			line_start_ptr += pitch;
-			current_ptr = line_start_ptr;
+			memcpy(pbuff->line(y), values, pbuff->width() * sizeof(float));
 		}
+	};
 
-		void write_pixel(float value) override
+	std::unique_ptr<PerlinNoise_PixelWriter> PerlinNoise_PixelWriter::create(const std::shared_ptr<PixelBuffer> &pbuff)
+	{
+		switch (pbuff->format())
 		{
-			*(current_ptr++) = value;
+		case tf_rgba8: return std::unique_ptr<PerlinNoise_PixelWriter>(new PerlinNoise_PixelWriter_RGBA8(pbuff));
+		case tf_rgb8: return std::unique_ptr<PerlinNoise_PixelWriter>(new PerlinNoise_PixelWriter_RGB8(pbuff));
+		case tf_r8: return std::unique_ptr<PerlinNoise_PixelWriter>(new PerlinNoise_PixelWriter_R8(pbuff));
+		case tf_r32f: return std::unique_ptr<PerlinNoise_PixelWriter>(new PerlinNoise_PixelWriter_R32f(pbuff));
+		default: throw Exception("texture format is not supported");
 		}
-	private:
-		int pitch;
-		float *current_ptr;
-		float *line_start_ptr;
-	};
+	}
 
 	class PerlinNoise_Impl : public PerlinNoise
 	{
@@ -194,6 +304,11 @@ namespace uicore
 		std::shared_ptr<PixelBuffer> create_noise2d(float start_x, float end_x, float start_y, float end_y) override;
 		std::shared_ptr<PixelBuffer> create_noise1d(float start_x, float end_x) override;
 
+		void write_noise4d(const std::shared_ptr<PixelBuffer> &target, float start_x, float end_x, float start_y, float end_y, float z_position, float w_position) override;
+		void write_noise3d(const std::shared_ptr<PixelBuffer> &target, float start_x, float end_x, float start_y, float end_y, float z_position) override;
+		void write_noise2d(const std::shared_ptr<PixelBuffer> &target, float start_x, float end_x, float start_y, float end_y) override;
+		void write_noise1d(const std::shared_ptr<PixelBuffer> &target, float start_x, float end_x) override;
+
 		Size size() const override { return Size(_width, _height); }
 		TextureFormat format() const override { return _texture_format; }
 		float amplitude() const override { return _amplitude; }
@@ -211,10 +326,9 @@ namespace uicore
 		int _octaves = 1;
 
 	private:
-		void create_noise4d(PerlinNoise_PixelWriter &writer, float start_x, float end_x, float start_y, float end_y, float z_position, float w_position);
-		void create_noise3d(PerlinNoise_PixelWriter &writer, float start_x, float end_x, float start_y, float end_y, float z_position);
-		void create_noise2d(PerlinNoise_PixelWriter &writer, float start_x, float end_x, float start_y, float end_y);
-		void create_noise1d(PerlinNoise_PixelWriter &writer, float start_x, float end_x);
+		std::shared_ptr<PixelBuffer> create_target();
+		void write_noise(const std::shared_ptr<PixelBuffer> &target, int dimensions, float start_x, float end_x, float start_y, float end_y, float z_position, float w_position);
+		void noise_row(const PerlinNoiseRowParams &params, int dimensions, int y, float *output);
 
 		inline float gradient_1d(int permutation_value, float x);
 		inline float gradient_2d(int permutation_value, float x, float y);
@@ -230,7 +344,7 @@ namespace uicore
 
 		bool permutation_table_set = false;
 
-		unsigned char permutation_table[permutation_table_size * 2];	// Table duplicated at permutation_table_size
+		unsigned char permutation_table[permutation_table_size * 2 + 4] = { 0 };	// Table duplicated at permutation_table_size, padded for 32-bit gathers
 	};
 
 	std::shared_ptr<PerlinNoise> PerlinNoise::create()
@@ -576,6 +690,7 @@ namespace uicore
 
 			memcpy(dest, table, size_to_copy);
 			dest += size_to_copy;
+			dest_size -= size_to_copy;
 		}
 
 		// Mirror the table
@@ -599,269 +714,149 @@ namespace uicore
 		}
 	}
 
-	std::shared_ptr<PixelBuffer> PerlinNoise_Impl::create_noise2d(float start_x, float end_x, float start_y, float end_y)
+	std::shared_ptr<PixelBuffer> PerlinNoise_Impl::create_target()
 	{
-		setup();
-
-		if (_texture_format == tf_rgba8)
-		{
-			auto pbuff = PixelBuffer::create(_width, _height, _texture_format);
-			PerlinNoise_PixelWriter_RGBA8 writer(pbuff);
-			create_noise2d(writer, start_x, end_x, start_y, end_y);
-			return pbuff;
-		}
-		if (_texture_format == tf_rgb8)
-		{
-			auto pbuff = PixelBuffer::create(_width, _height, _texture_format);
-			PerlinNoise_PixelWriter_RGB8 writer(pbuff);
-			create_noise2d(writer, start_x, end_x, start_y, end_y);
-			return pbuff;
-		}
-		if (_texture_format == tf_r8)
-		{
-			auto pbuff = PixelBuffer::create(_width, _height, _texture_format);
-			PerlinNoise_PixelWriter_R8 writer(pbuff);
-			create_noise2d(writer, start_x, end_x, start_y, end_y);
-			return pbuff;
-		}
-		if (_texture_format == tf_r32f)
-		{
-			auto pbuff = PixelBuffer::create(_width, _height, _texture_format);
-			PerlinNoise_PixelWriter_R32f writer(pbuff);
-			create_noise2d(writer, start_x, end_x, start_y, end_y);
-			return pbuff;
-		}
-
-		throw Exception("texture format is not supported");
-	}
-
-	void PerlinNoise_Impl::create_noise2d(PerlinNoise_PixelWriter &writer, float start_x, float end_x, float start_y, float end_y)
-	{
-		float size_x = end_x - start_x;
-		float size_y = end_y - start_y;
-		float fheight = (float)_height;
-		float fwidth = (float)_width;
-
-		for (int y = 0; y < _height; y++)
-		{
-			for (int x = 0; x < _width; x++)
-			{
-				float result = 0.0f;
-				float current_amplitude = _amplitude;
-				float value_x = start_x + (((float)x) * size_x) / fwidth;
-				float value_y = start_y + (((float)y) * size_y) / fheight;
-
-				for (int i = 0; i < _octaves; i++)
-				{
-					result += current_amplitude * noise_2d(value_x, value_y);
-					value_x *= 2.0f;
-					value_y *= 2.0f;
-					current_amplitude *= 0.5f;
-				}
-
-				writer.write_pixel(result);
-			}
-			writer.line_end();
-		}
+		if (_texture_format != tf_rgba8 && _texture_format != tf_rgb8 && _texture_format != tf_r8 && _texture_format != tf_r32f)
+			throw Exception("texture format is not supported");
+		return PixelBuffer::create(_width, _height, _texture_format);
 	}
 
 	std::shared_ptr<PixelBuffer> PerlinNoise_Impl::create_noise1d(float start_x, float end_x)
 	{
-		setup();
-
-		if (_texture_format == tf_rgba8)
-		{
-			auto pbuff = PixelBuffer::create(_width, _height, _texture_format);
-			PerlinNoise_PixelWriter_RGBA8 writer(pbuff);
-			create_noise1d(writer, start_x, end_x);
-			return pbuff;
-		}
-		if (_texture_format == tf_rgb8)
-		{
-			auto pbuff = PixelBuffer::create(_width, _height, _texture_format);
-			PerlinNoise_PixelWriter_RGB8 writer(pbuff);
-			create_noise1d(writer, start_x, end_x);
-			return pbuff;
-		}
-		if (_texture_format == tf_r8)
-		{
-			auto pbuff = PixelBuffer::create(_width, _height, _texture_format);
-			PerlinNoise_PixelWriter_R8 writer(pbuff);
-			create_noise1d(writer, start_x, end_x);
-			return pbuff;
-		}
-		if (_texture_format == tf_r32f)
-		{
-			auto pbuff = PixelBuffer::create(_width, _height, _texture_format);
-			PerlinNoise_PixelWriter_R32f writer(pbuff);
-			create_noise1d(writer, start_x, end_x);
-			return pbuff;
-		}
-
-		throw Exception("texture format is not supported");
+		auto pbuff = create_target();
+		write_noise1d(pbuff, start_x, end_x);
+		return pbuff;
 	}
 
-	void PerlinNoise_Impl::create_noise1d(PerlinNoise_PixelWriter &writer, float start_x, float end_x)
+	std::shared_ptr<PixelBuffer> PerlinNoise_Impl::create_noise2d(float start_x, float end_x, float start_y, float end_y)
 	{
-		float size_x = end_x - start_x;
-		float fwidth = (float)_width;
-
-		for (int y = 0; y < _height; y++)
-		{
-			for (int x = 0; x < _width; x++)
-			{
-				float result = 0.0f;
-				float current_amplitude = _amplitude;
-				float value_x = start_x + (((float)x) * size_x) / fwidth;
-
-				for (int i = 0; i < _octaves; i++)
-				{
-					result += current_amplitude * noise_1d(value_x);
-					value_x *= 2.0f;
-					current_amplitude *= 0.5f;
-				}
-
-				writer.write_pixel(result);
-			}
-			writer.line_end();
-		}
+		auto pbuff = create_target();
+		write_noise2d(pbuff, start_x, end_x, start_y, end_y);
+		return pbuff;
 	}
 
 	std::shared_ptr<PixelBuffer> PerlinNoise_Impl::create_noise3d(float start_x, float end_x, float start_y, float end_y, float z_position)
 	{
-		setup();
-
-		if (_texture_format == tf_rgba8)
-		{
-			auto pbuff = PixelBuffer::create(_width, _height, _texture_format);
-			PerlinNoise_PixelWriter_RGBA8 writer(pbuff);
-			create_noise3d(writer, start_x, end_x, start_y, end_y, z_position);
-			return pbuff;
-		}
-		if (_texture_format == tf_rgb8)
-		{
-			auto pbuff = PixelBuffer::create(_width, _height, _texture_format);
-			PerlinNoise_PixelWriter_RGB8 writer(pbuff);
-			create_noise3d(writer, start_x, end_x, start_y, end_y, z_position);
-			return pbuff;
-		}
-		if (_texture_format == tf_r8)
-		{
-			auto pbuff = PixelBuffer::create(_width, _height, _texture_format);
-			PerlinNoise_PixelWriter_R8 writer(pbuff);
-			create_noise3d(writer, start_x, end_x, start_y, end_y, z_position);
-			return pbuff;
-		}
-		if (_texture_format == tf_r32f)
-		{
-			auto pbuff = PixelBuffer::create(_width, _height, _texture_format);
-			PerlinNoise_PixelWriter_R32f writer(pbuff);
-			create_noise3d(writer, start_x, end_x, start_y, end_y, z_position);
-			return pbuff;
-		}
+		auto pbuff = create_target();
+		write_noise3d(pbuff, start_x, end_x, start_y, end_y, z_position);
+		return pbuff;
+	}
 
-		throw Exception("sized format is not supported");
+	std::shared_ptr<PixelBuffer> PerlinNoise_Impl::create_noise4d(float start_x, float end_x, float start_y, float end_y, float z_position, float w_position)
+	{
+		auto pbuff = create_target();
+		write_noise4d(pbuff, start_x, end_x, start_y, end_y, z_position, w_position);
+		return pbuff;
 	}
 
-	void PerlinNoise_Impl::create_noise3d(PerlinNoise_PixelWriter &writer, float start_x, float end_x, float start_y, float end_y, float z_position)
+	void PerlinNoise_Impl::write_noise1d(const std::shared_ptr<PixelBuffer> &target, float start_x, float end_x)
 	{
-		float size_x = end_x - start_x;
-		float size_y = end_y - start_y;
-		float fheight = (float)_height;
-		float fwidth = (float)_width;
+		write_noise(target, 1, start_x, end_x, 0.0f, 0.0f, 0.0f, 0.0f);
+	}
 
-		for (int y = 0; y < _height; y++)
-		{
-			for (int x = 0; x < _width; x++)
-			{
-				float result = 0.0f;
-				float current_amplitude = _amplitude;
-				float value_x = start_x + (((float)x) * size_x) / fwidth;
-				float value_y = start_y + (((float)y) * size_y) / fheight;
-				float value_z = z_position;
+	void PerlinNoise_Impl::write_noise2d(const std::shared_ptr<PixelBuffer> &target, float start_x, float end_x, float start_y, float end_y)
+	{
+		write_noise(target, 2, start_x, end_x, start_y, end_y, 0.0f, 0.0f);
+	}
 
-				for (int i = 0; i < _octaves; i++)
-				{
-					result += current_amplitude * noise_3d(value_x, value_y, value_z);
-					value_x *= 2.0f;
-					value_y *= 2.0f;
-					value_z *= 2.0f;
-					current_amplitude *= 0.5f;
-				}
+	void PerlinNoise_Impl::write_noise3d(const std::shared_ptr<PixelBuffer> &target, float start_x, float end_x, float start_y, float end_y, float z_position)
+	{
+		write_noise(target, 3, start_x, end_x, start_y, end_y, z_position, 0.0f);
+	}
 
-				writer.write_pixel(result);
-			}
-			writer.line_end();
-		}
+	void PerlinNoise_Impl::write_noise4d(const std::shared_ptr<PixelBuffer> &target, float start_x, float end_x, float start_y, float end_y, float z_position, float w_position)
+	{
+		write_noise(target, 4, start_x, end_x, start_y, end_y, z_position, w_position);
 	}
 
-	std::shared_ptr<PixelBuffer> PerlinNoise_Impl::create_noise4d(float start_x, float end_x, float start_y, float end_y, float z_position, float w_position)
+	void PerlinNoise_Impl::write_noise(const std::shared_ptr<PixelBuffer> &target, int dimensions, float start_x, float end_x, float start_y, float end_y, float z_position, float w_position)
 	{
+		if (!target)
+			throw Exception("no target pixel buffer");
+
+		std::unique_ptr<PerlinNoise_PixelWriter> writer = PerlinNoise_PixelWriter::create(target);
+
 		setup();
 
-		if (_texture_format == tf_rgba8)
-		{
-			auto pbuff = PixelBuffer::create(_width, _height, _texture_format);
-			PerlinNoise_PixelWriter_RGBA8 writer(pbuff);
-			create_noise4d(writer, start_x, end_x, start_y, end_y, z_position, w_position);
-			return pbuff;
-		}
-		if (_texture_format == tf_rgb8)
-		{
-			auto pbuff = PixelBuffer::create(_width, _height, _texture_format);
-			PerlinNoise_PixelWriter_RGB8 writer(pbuff);
-			create_noise4d(writer, start_x, end_x, start_y, end_y, z_position, w_position);
-			return pbuff;
-		}
-		if (_texture_format == tf_r8)
-		{
-			auto pbuff = PixelBuffer::create(_width, _height, _texture_format);
-			PerlinNoise_PixelWriter_R8 writer(pbuff);
-			create_noise4d(writer, start_x, end_x, start_y, end_y, z_position, w_position);
-			return pbuff;
-		}
-		if (_texture_format == tf_r32f)
-		{
-			auto pbuff = PixelBuffer::create(_width, _height, _texture_format);
-			PerlinNoise_PixelWriter_R32f writer(pbuff);
-			create_noise4d(writer, start_x, end_x, start_y, end_y, z_position, w_position);
-			return pbuff;
-		}
+		PerlinNoiseRowParams params;
+		params.permutations = permutation_table;
+		params.width = target->width();
+		params.height = target->height();
+		params.octaves = _octaves;
+		params.amplitude = _amplitude;
+		params.start_x = start_x;
+		params.size_x = end_x - start_x;
+		params.start_y = start_y;
+		params.size_y = end_y - start_y;
+		params.z_position = z_position;
+		params.w_position = w_position;
+
+		if (params.width <= 0 || params.height <= 0)
+			return;
 
-		throw Exception("sized format is not supported");
+		typedef void(*NoiseRowFunc)(const PerlinNoiseRowParams &params, int y, float *output);
+		NoiseRowFunc simd_row = nullptr;
+
+#ifdef USE_SSE2
+		static const NoiseRowFunc sse2_rows[4] = { &perlin_sse2::noise_row<1>, &perlin_sse2::noise_row<2>, &perlin_sse2::noise_row<3>, &perlin_sse2::noise_row<4> };
+		simd_row = sse2_rows[dimensions - 1];
+#endif
+#ifdef USE_AVX2
+		static const NoiseRowFunc avx2_rows[4] = { &perlin_avx2::noise_row<1>, &perlin_avx2::noise_row<2>, &perlin_avx2::noise_row<3>, &perlin_avx2::noise_row<4> };
+		static const bool use_avx2 = System::detect_cpu_extension(System::avx2);
+		if (use_avx2)
+			simd_row = avx2_rows[dimensions - 1];
+#endif
+
+		// Each row is independent, so rows are spread over the worker threads in batches of roughly 16K pixels
+		int min_batch = std::max(1, 16384 / params.width);
+		ThreadPool::shared().parallel_for(params.height, min_batch, [&](int begin, int end)
+		{
+			std::vector<float> values(params.width);
+			for (int y = begin; y < end; y++)
+			{
+				if (simd_row)
+					simd_row(params, y, values.data());
+				else
+					noise_row(params, dimensions, y, values.data());
+				writer->write_line(y, values.data());
+			}
+		});
 	}
 
-	void PerlinNoise_Impl::create_noise4d(PerlinNoise_PixelWriter &writer, float start_x, float end_x, float start_y, float end_y, float z_position, float w_position)
+	void PerlinNoise_Impl::noise_row(const PerlinNoiseRowParams &params, int dimensions, int y, float *output)
 	{
-		float size_x = end_x - start_x;
-		float size_y = end_y - start_y;
-		float fheight = (float)_height;
-		float fwidth = (float)_width;
+		float fheight = (float)params.height;
+		float fwidth = (float)params.width;
 
-		for (int y = 0; y < _height; y++)
+		for (int x = 0; x < params.width; x++)
 		{
-			for (int x = 0; x < _width; x++)
+			float result = 0.0f;
+			float current_amplitude = params.amplitude;
+			float value_x = params.start_x + (((float)x) * params.size_x) / fwidth;
+			float value_y = params.start_y + (((float)y) * params.size_y) / fheight;
+			float value_z = params.z_position;
+			float value_w = params.w_position;
+
+			for (int i = 0; i < params.octaves; i++)
 			{
-				float result = 0.0f;
-				float current_amplitude = _amplitude;
-				float value_x = start_x + (((float)x) * size_x) / fwidth;
-				float value_y = start_y + (((float)y) * size_y) / fheight;
-				float value_z = z_position;
-				float value_w = w_position;
-
-				for (int i = 0; i < _octaves; i++)
+				float value;
+				switch (dimensions)
 				{
-					result += current_amplitude * noise_4d(value_x, value_y, value_z, value_w);
-					value_x *= 2.0f;
-					value_y *= 2.0f;
-					value_z *= 2.0f;
-					value_w *= 2.0f;
-					current_amplitude *= 0.5f;
+				case 1: value = noise_1d(value_x); break;
+				case 2: value = noise_2d(value_x, value_y); break;
+				case 3: value = noise_3d(value_x, value_y, value_z); break;
+				default: value = noise_4d(value_x, value_y, value_z, value_w); break;
 				}
-
-				writer.write_pixel(result);
+				result += current_amplitude * value;
+				value_x *= 2.0f;
+				value_y *= 2.0f;
+				value_z *= 2.0f;
+				value_w *= 2.0f;
+				current_amplitude *= 0.5f;
 			}
-			writer.line_end();
+
+			output[x] = result;
 		}
 	}
 }
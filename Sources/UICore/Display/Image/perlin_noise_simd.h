@@ -0,0 +1,297 @@
+/*
+**  UICore
+**  Copyright (c) 1997-2015 The UICore Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries UICore may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+// Vectorized noise evaluation shared by the SSE2 and AVX2 code paths.
+//
+// This file is included by perlin_noise.cpp once per instruction set, inside a namespace
+// declaring the vector types F and I and the operations on them. It intentionally has no
+// include guard.
+
+inline F lerp(F t, F a, F b)
+{
+	return add(a, mul(t, sub(b, a)));
+}
+
+inline F s_curve(F t)
+{
+	return mul(mul(mul(t, t), t), add(mul(t, sub(mul(t, set1(6.0f)), set1(15.0f))), set1(10.0f)));
+}
+
+inline I bit_set(I value, int bit)
+{
+	I b = set1i(bit);
+	return cmpeqi(andi(value, b), b);
+}
+
+inline I wrap(I value)
+{
+	return andi(value, set1i(0xff));
+}
+
+inline F gradient_1d(I permutation_value, F x)
+{
+	F gradient = add(set1(1.0f), to_float(andi(permutation_value, set1i(7))));
+	gradient = negate_if(bit_set(permutation_value, 8), gradient);
+	return mul(gradient, x);
+}
+
+inline F gradient_2d(I permutation_value, F x, F y)
+{
+	I swap = bit_set(permutation_value, 4);
+	F u = select(swap, y, x);
+	F v = select(swap, x, y);
+	u = negate_if(bit_set(permutation_value, 1), u);
+	v = negate_if(bit_set(permutation_value, 2), v);
+	return add(u, mul(set1(2.0f), v));
+}
+
+inline F gradient_3d(I permutation_value, F x, F y, F z)
+{
+	I h = andi(permutation_value, set1i(15));
+	F u = select(bit_set(h, 8), y, x);
+	F v = select(bit_set(h, 4), select(bit_set(h, 8), x, z), y);
+	u = negate_if(bit_set(h, 1), u);
+	v = negate_if(bit_set(h, 2), v);
+	return add(u, v);
+}
+
+inline F gradient_4d(I permutation_value, F x, F y, F z, F t)
+{
+	I h = andi(permutation_value, set1i(31));
+	F u = select(cmplti(h, set1i(24)), x, y);
+	F v = select(cmplti(h, set1i(16)), y, z);
+	F w = select(cmplti(h, set1i(8)), z, t);
+	u = negate_if(bit_set(h, 1), u);
+	v = negate_if(bit_set(h, 2), v);
+	w = negate_if(bit_set(h, 4), w);
+	return add(add(u, v), w);
+}
+
+inline F noise_1d(const unsigned char *perm, F x)
+{
+	I ix0 = floor_to_int(x);
+	F fx0 = sub(x, to_float(ix0));
+	F fx1 = sub(fx0, set1(1.0f));
+	I ix1 = wrap(addi(ix0, set1i(1)));
+	ix0 = wrap(ix0);
+
+	F s = s_curve(fx0);
+
+	F n0 = gradient_1d(permute(perm, ix0), fx0);
+	F n1 = gradient_1d(permute(perm, ix1), fx1);
+	return lerp(s, n0, n1);
+}
+
+inline F noise_2d(const unsigned char *perm, F x, F y)
+{
+	I ix0 = floor_to_int(x);
+	I iy0 = floor_to_int(y);
+	F fx0 = sub(x, to_float(ix0));
+	F fy0 = sub(y, to_float(iy0));
+	F fx1 = sub(fx0, set1(1.0f));
+	F fy1 = sub(fy0, set1(1.0f));
+	I ix1 = wrap(addi(ix0, set1i(1)));
+	I iy1 = wrap(addi(iy0, set1i(1)));
+	ix0 = wrap(ix0);
+	iy0 = wrap(iy0);
+
+	F t = s_curve(fy0);
+	F s = s_curve(fx0);
+
+	I py0 = permute(perm, iy0);
+	I py1 = permute(perm, iy1);
+
+	F nx0 = gradient_2d(permute(perm, addi(ix0, py0)), fx0, fy0);
+	F nx1 = gradient_2d(permute(perm, addi(ix0, py1)), fx0, fy1);
+	F n0 = lerp(t, nx0, nx1);
+
+	nx0 = gradient_2d(permute(perm, addi(ix1, py0)), fx1, fy0);
+	nx1 = gradient_2d(permute(perm, addi(ix1, py1)), fx1, fy1);
+	F n1 = lerp(t, nx0, nx1);
+
+	return lerp(s, n0, n1);
+}
+
+inline F noise_3d(const unsigned char *perm, F x, F y, F z)
+{
+	I ix0 = floor_to_int(x);
+	I iy0 = floor_to_int(y);
+	I iz0 = floor_to_int(z);
+	F fx0 = sub(x, to_float(ix0));
+	F fy0 = sub(y, to_float(iy0));
+	F fz0 = sub(z, to_float(iz0));
+	F fx1 = sub(fx0, set1(1.0f));
+	F fy1 = sub(fy0, set1(1.0f));
+	F fz1 = sub(fz0, set1(1.0f));
+	I ix1 = wrap(addi(ix0, set1i(1)));
+	I iy1 = wrap(addi(iy0, set1i(1)));
+	I iz1 = wrap(addi(iz0, set1i(1)));
+	ix0 = wrap(ix0);
+	iy0 = wrap(iy0);
+	iz0 = wrap(iz0);
+
+	F r = s_curve(fz0);
+	F t = s_curve(fy0);
+	F s = s_curve(fx0);
+
+	I pz0 = permute(perm, iz0);
+	I pz1 = permute(perm, iz1);
+	I py0z0 = permute(perm, addi(iy0, pz0));
+	I py0z1 = permute(perm, addi(iy0, pz1));
+	I py1z0 = permute(perm, addi(iy1, pz0));
+	I py1z1 = permute(perm, addi(iy1, pz1));
+
+	F nxy0 = gradient_3d(permute(perm, addi(ix0, py0z0)), fx0, fy0, fz0);
+	F nxy1 = gradient_3d(permute(perm, addi(ix0, py0z1)), fx0, fy0, fz1);
+	F nx0 = lerp(r, nxy0, nxy1);
+
+	nxy0 = gradient_3d(permute(perm, addi(ix0, py1z0)), fx0, fy1, fz0);
+	nxy1 = gradient_3d(permute(perm, addi(ix0, py1z1)), fx0, fy1, fz1);
+	F nx1 = lerp(r, nxy0, nxy1);
+
+	F n0 = lerp(t, nx0, nx1);
+
+	nxy0 = gradient_3d(permute(perm, addi(ix1, py0z0)), fx1, fy0, fz0);
+	nxy1 = gradient_3d(permute(perm, addi(ix1, py0z1)), fx1, fy0, fz1);
+	nx0 = lerp(r, nxy0, nxy1);
+
+	nxy0 = gradient_3d(permute(perm, addi(ix1, py1z0)), fx1, fy1, fz0);
+	nxy1 = gradient_3d(permute(perm, addi(ix1, py1z1)), fx1, fy1, fz1);
+	nx1 = lerp(r, nxy0, nxy1);
+
+	F n1 = lerp(t, nx0, nx1);
+
+	return lerp(s, n0, n1);
+}
+
+inline F noise_4d(const unsigned char *perm, F x, F y, F z, F w)
+{
+	I ix0 = floor_to_int(x);
+	I iy0 = floor_to_int(y);
+	I iz0 = floor_to_int(z);
+	I iw0 = floor_to_int(w);
+	F fx0 = sub(x, to_float(ix0));
+	F fy0 = sub(y, to_float(iy0));
+	F fz0 = sub(z, to_float(iz0));
+	F fw0 = sub(w, to_float(iw0));
+	F fx1 = sub(fx0, set1(1.0f));
+	F fy1 = sub(fy0, set1(1.0f));
+	F fz1 = sub(fz0, set1(1.0f));
+	F fw1 = sub(fw0, set1(1.0f));
+	I ix1 = wrap(addi(ix0, set1i(1)));
+	I iy1 = wrap(addi(iy0, set1i(1)));
+	I iz1 = wrap(addi(iz0, set1i(1)));
+	I iw1 = wrap(addi(iw0, set1i(1)));
+	ix0 = wrap(ix0);
+	iy0 = wrap(iy0);
+	iz0 = wrap(iz0);
+	iw0 = wrap(iw0);
+
+	F q = s_curve(fw0);
+	F r = s_curve(fz0);
+	F t = s_curve(fy0);
+	F s = s_curve(fx0);
+
+	I ix[2] = { ix0, ix1 };
+	I iy[2] = { iy0, iy1 };
+	I iz[2] = { iz0, iz1 };
+	I pw[2] = { permute(perm, iw0), permute(perm, iw1) };
+	F fx[2] = { fx0, fx1 };
+	F fy[2] = { fy0, fy1 };
+	F fz[2] = { fz0, fz1 };
+
+	F nx[2];
+	for (int a = 0; a < 2; a++)
+	{
+		F ny[2];
+		for (int b = 0; b < 2; b++)
+		{
+			F nz[2];
+			for (int c = 0; c < 2; c++)
+			{
+				F n0 = gradient_4d(permute(perm, addi(ix[a], permute(perm, addi(iy[b], permute(perm, addi(iz[c], pw[0])))))), fx[a], fy[b], fz[c], fw0);
+				F n1 = gradient_4d(permute(perm, addi(ix[a], permute(perm, addi(iy[b], permute(perm, addi(iz[c], pw[1])))))), fx[a], fy[b], fz[c], fw1);
+				nz[c] = lerp(q, n0, n1);
+			}
+			ny[b] = lerp(r, nz[0], nz[1]);
+		}
+		nx[a] = lerp(t, ny[0], ny[1]);
+	}
+
+	return lerp(s, nx[0], nx[1]);
+}
+
+// Evaluates one row of the noise image, lanes pixels at a time
+template<int dimensions>
+void noise_row(const PerlinNoiseRowParams &params, int y, float *output)
+{
+	F x_offset = to_float(lane_indices());
+	float value_y = params.start_y + (((float)y) * params.size_y) / ((float)params.height);
+
+	for (int x = 0; x < params.width; x += lanes)
+	{
+		F value_x = add(set1(params.start_x), div(mul(add(to_float(set1i(x)), x_offset), set1(params.size_x)), set1((float)params.width)));
+		F vy = set1(value_y);
+		F vz = set1(params.z_position);
+		F vw = set1(params.w_position);
+
+		F result = set1(0.0f);
+		float current_amplitude = params.amplitude;
+		for (int i = 0; i < params.octaves; i++)
+		{
+			F n;
+			if (dimensions == 1)
+				n = noise_1d(params.permutations, value_x);
+			else if (dimensions == 2)
+				n = noise_2d(params.permutations, value_x, vy);
+			else if (dimensions == 3)
+				n = noise_3d(params.permutations, value_x, vy, vz);
+			else
+				n = noise_4d(params.permutations, value_x, vy, vz, vw);
+
+			result = add(result, mul(set1(current_amplitude), n));
+			value_x = mul(value_x, set1(2.0f));
+			vy = mul(vy, set1(2.0f));
+			vz = mul(vz, set1(2.0f));
+			vw = mul(vw, set1(2.0f));
+			current_amplitude *= 0.5f;
+		}
+
+		if (x + lanes <= params.width)
+		{
+			store(output + x, result);
+		}
+		else
+		{
+			float values[lanes];
+			store(values, result);
+			for (int i = 0; x + i < params.width; i++)
+				output[x + i] = values[i];
+		}
+	}
+}
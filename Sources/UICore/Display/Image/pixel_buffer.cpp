@@ -41,6 +41,9 @@
 #include "UICore/Core/Math/half_float.h"
 #include "UICore/Core/Math/half_float_vector.h"
 #include "cpu_pixel_buffer_provider.h"
+#include "pixel_buffer_resampler.h"
+#include "pixel_buffer_s3tc.h"
+#include "pixel_buffer_pool.h"
 #include <cstdint>
 
 namespace uicore
@@ -276,11 +279,11 @@ namespace uicore
 		{
 		case tf_compressed_rgb_s3tc_dxt1:
 		case tf_compressed_rgba_s3tc_dxt1:
-		case tf_compressed_rgba_s3tc_dxt3:
 		case tf_compressed_srgb_s3tc_dxt1:
 		case tf_compressed_srgb_alpha_s3tc_dxt1:
-		case tf_compressed_srgb_alpha_s3tc_dxt3:
 			return 8;
+		case tf_compressed_rgba_s3tc_dxt3:
+		case tf_compressed_srgb_alpha_s3tc_dxt3:
 		case tf_compressed_rgba_s3tc_dxt5:
 		case tf_compressed_srgb_alpha_s3tc_dxt5:
 			return 16;
@@ -334,7 +337,7 @@ namespace uicore
 		auto pbuf = PixelBuffer::create(width(), height(), format());
 		void *dst_data = pbuf->data();
 		const void *src_data = data();
-		memcpy(dst_data, src_data, height()*pitch());
+		memcpy(dst_data, src_data, data_size());
 		return pbuf;
 	}
 
@@ -391,11 +394,28 @@ namespace uicore
 
 	std::shared_ptr<PixelBuffer> PixelBuffer::to_format(TextureFormat texture_format, const std::shared_ptr<PixelConverter> &converter) const
 	{
+		if (is_compressed(texture_format))
+		{
+			return PixelBufferS3TC::compress(this, texture_format);
+		}
+		else if (is_compressed())
+		{
+			auto result = PixelBufferS3TC::decompress(this);
+			if (result->format() != texture_format)
+				result = result->to_format(texture_format, converter);
+			return result;
+		}
+
 		auto result = PixelBuffer::create(width(), height(), texture_format);
 		PixelBufferImpl::convert(this, result.get(), Rect(Point(), size()), Rect(Point(), size()), converter);
 		return result;
 	}
 
+	std::shared_ptr<PixelBuffer> PixelBuffer::scaled(int width, int height, ResampleFilter filter) const
+	{
+		return PixelBufferResampler::scale(this, width, height, filter);
+	}
+
 	void PixelBuffer::flip_vertical()
 	{
 		if (width() == 0 || height() <= 1)
@@ -631,6 +651,16 @@ namespace uicore
 		}
 	}
 
+	PixelBufferPoolStatistics PixelBuffer::pool_statistics()
+	{
+		return PixelBufferPool::statistics();
+	}
+
+	void PixelBuffer::purge_pool()
+	{
+		PixelBufferPool::purge();
+	}
+
 	std::shared_ptr<PixelBuffer> PixelBuffer::add_border(const std::shared_ptr<PixelBuffer> &pb, int border_size, const Rect &rect)
 	{
 		if (rect.left < 0 || rect.top < 0 || rect.right > pb->width() || rect.bottom > pb->height())
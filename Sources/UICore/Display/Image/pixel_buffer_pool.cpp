@@ -0,0 +1,281 @@
+/*
+**  UICore
+**  Copyright (c) 1997-2015 The UICore Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries UICore may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "UICore/precomp.h"
+#include "pixel_buffer_pool.h"
+#include "UICore/Core/System/system.h"
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+namespace uicore
+{
+	namespace
+	{
+		// Size classes are spaced four per power of two, starting at 256 bytes
+		const int min_class_shift = 8;
+		const int max_class_shift = 26;
+		const int classes_per_shift = 4;
+		const int num_size_classes = (max_class_shift - min_class_shift) * classes_per_shift + 1;
+
+		const int thread_cache_blocks_per_class = 4;
+		const size_t thread_cache_max_bytes = 32 * 1024 * 1024;
+		const size_t global_pool_max_bytes = 256 * 1024 * 1024;
+
+		int size_class(size_t size)
+		{
+			if (size <= ((size_t)1 << min_class_shift))
+				return 0;
+
+			int shift = min_class_shift;
+			while (((size_t)1 << (shift + 1)) < size)
+				shift++;
+
+			size_t base = (size_t)1 << shift;
+			size_t step = base / classes_per_shift;
+			int sub = (int)((size - base + step - 1) / step);
+			return (shift - min_class_shift) * classes_per_shift + sub;
+		}
+
+		size_t class_capacity(int size_class)
+		{
+			int shift = min_class_shift + size_class / classes_per_shift;
+			int sub = size_class % classes_per_shift;
+			size_t base = (size_t)1 << shift;
+			return base + sub * (base / classes_per_shift);
+		}
+
+		struct PoolCounters
+		{
+			std::atomic<int64_t> allocations{ 0 };
+			std::atomic<int64_t> reused{ 0 };
+			std::atomic<int64_t> system_allocations{ 0 };
+			std::atomic<int64_t> pooled_bytes{ 0 };
+			std::atomic<unsigned int> purge_generation{ 0 };
+		};
+
+		PoolCounters &counters()
+		{
+			static PoolCounters counters;
+			return counters;
+		}
+
+		class GlobalPool
+		{
+		public:
+			// Never destroyed, as thread caches may return blocks to it during shutdown
+			static GlobalPool *instance()
+			{
+				static GlobalPool *pool = new GlobalPool();
+				return pool;
+			}
+
+			void *pop(int size_class)
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				auto &blocks = free_blocks[size_class];
+				if (blocks.empty())
+					return nullptr;
+				void *data = blocks.back();
+				blocks.pop_back();
+				size -= class_capacity(size_class);
+				counters().pooled_bytes -= class_capacity(size_class);
+				return data;
+			}
+
+			bool push(int size_class, void *data)
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				size_t capacity = class_capacity(size_class);
+				if (size + capacity > global_pool_max_bytes)
+					return false;
+				free_blocks[size_class].push_back(data);
+				size += capacity;
+				counters().pooled_bytes += capacity;
+				return true;
+			}
+
+			void purge()
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				for (int i = 0; i < num_size_classes; i++)
+				{
+					for (void *data : free_blocks[i])
+						System::aligned_free(data);
+					counters().pooled_bytes -= free_blocks[i].size() * class_capacity(i);
+					free_blocks[i].clear();
+				}
+				size = 0;
+			}
+
+		private:
+			std::mutex mutex;
+			std::vector<void *> free_blocks[num_size_classes];
+			size_t size = 0;
+		};
+
+		class ThreadCache
+		{
+		public:
+			~ThreadCache()
+			{
+				purge_if_requested();
+				flush();
+			}
+
+			void *pop(int size_class)
+			{
+				if (count[size_class] == 0)
+					return nullptr;
+				size -= class_capacity(size_class);
+				counters().pooled_bytes -= class_capacity(size_class);
+				return blocks[size_class][--count[size_class]];
+			}
+
+			bool push(int size_class, void *data)
+			{
+				size_t capacity = class_capacity(size_class);
+				if (count[size_class] == thread_cache_blocks_per_class || size + capacity > thread_cache_max_bytes)
+					return false;
+				blocks[size_class][count[size_class]++] = data;
+				size += capacity;
+				counters().pooled_bytes += capacity;
+				return true;
+			}
+
+			void flush()
+			{
+				for (int i = 0; i < num_size_classes; i++)
+				{
+					for (int j = 0; j < count[i]; j++)
+						release_to_global(i, blocks[i][j]);
+					count[i] = 0;
+				}
+				size = 0;
+			}
+
+			// Frees the cached blocks if purge() was called on any thread since this cache was last used
+			void purge_if_requested()
+			{
+				unsigned int current_generation = counters().purge_generation;
+				if (generation == current_generation)
+					return;
+
+				for (int i = 0; i < num_size_classes; i++)
+				{
+					for (int j = 0; j < count[i]; j++)
+						System::aligned_free(blocks[i][j]);
+					counters().pooled_bytes -= count[i] * class_capacity(i);
+					count[i] = 0;
+				}
+				size = 0;
+				generation = current_generation;
+			}
+
+			static void release_to_global(int size_class, void *data)
+			{
+				counters().pooled_bytes -= class_capacity(size_class);
+				if (!GlobalPool::instance()->push(size_class, data))
+					System::aligned_free(data);
+			}
+
+		private:
+			void *blocks[num_size_classes][thread_cache_blocks_per_class];
+			int count[num_size_classes] = {};
+			size_t size = 0;
+			unsigned int generation = counters().purge_generation;
+		};
+
+		thread_local ThreadCache thread_cache;
+	}
+
+	void *PixelBufferPool::alloc(size_t size, size_t &out_capacity)
+	{
+		counters().allocations++;
+
+		int index = size_class(size);
+		if (index >= num_size_classes)
+		{
+			// Too large to be pooled
+			counters().system_allocations++;
+			out_capacity = size;
+			return System::aligned_alloc(size, 16);
+		}
+
+		out_capacity = class_capacity(index);
+
+		thread_cache.purge_if_requested();
+		void *data = thread_cache.pop(index);
+		if (!data)
+			data = GlobalPool::instance()->pop(index);
+
+		if (data)
+		{
+			counters().reused++;
+			return data;
+		}
+
+		counters().system_allocations++;
+		return System::aligned_alloc(out_capacity, 16);
+	}
+
+	void PixelBufferPool::free(void *data, size_t capacity)
+	{
+		if (!data)
+			return;
+
+		int index = size_class(capacity);
+		if (index >= num_size_classes || class_capacity(index) != capacity)
+		{
+			System::aligned_free(data);
+			return;
+		}
+
+		thread_cache.purge_if_requested();
+		if (!thread_cache.push(index, data) && !GlobalPool::instance()->push(index, data))
+			System::aligned_free(data);
+	}
+
+	PixelBufferPoolStatistics PixelBufferPool::statistics()
+	{
+		PixelBufferPoolStatistics stats;
+		stats.allocations = counters().allocations;
+		stats.reused = counters().reused;
+		stats.system_allocations = counters().system_allocations;
+		stats.pooled_bytes = counters().pooled_bytes;
+		return stats;
+	}
+
+	void PixelBufferPool::purge()
+	{
+		// Other threads free their caches the next time they allocate or free a pixel buffer
+		counters().purge_generation++;
+		thread_cache.purge_if_requested();
+		GlobalPool::instance()->purge();
+	}
+}
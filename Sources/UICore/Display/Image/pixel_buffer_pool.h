@@ -0,0 +1,53 @@
+/*
+**  UICore
+**  Copyright (c) 1997-2015 The UICore Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries UICore may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include "UICore/Display/Image/pixel_buffer.h"
+
+namespace uicore
+{
+	/// \brief Recycles pixel buffer memory by size class
+	///
+	/// Released blocks are first kept in a small per-thread cache, then in a global pool shared by all threads.
+	/// Blocks that do not fit in either are returned to the system.
+	class PixelBufferPool
+	{
+	public:
+		/// \brief Allocates at least size bytes aligned to 16 bytes. The capacity of the block is returned in out_capacity.
+		static void *alloc(size_t size, size_t &out_capacity);
+
+		/// \brief Returns a block obtained from alloc to the pool
+		static void free(void *data, size_t capacity);
+
+		static PixelBufferPoolStatistics statistics();
+
+		/// \brief Frees the blocks in the global pool and in the cache of the calling thread
+		static void purge();
+	};
+}
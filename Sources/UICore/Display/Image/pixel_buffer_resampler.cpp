@@ -0,0 +1,516 @@
+/*
+**  UICore
+**  Copyright (c) 1997-2015 The UICore Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries UICore may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "UICore/precomp.h"
+#include "pixel_buffer_resampler.h"
+#include "UICore/Core/System/exception.h"
+#include "UICore/Core/System/system.h"
+#include "UICore/Core/System/thread_pool.h"
+#include <algorithm>
+#include <cmath>
+
+#if !defined __ANDROID__ && ! defined CL_DISABLE_SSE2
+#define USE_SSE2
+#include <emmintrin.h>
+#if defined(_MSC_VER) || defined(__AVX2__) || defined(__GNUC__)
+#define USE_AVX2
+#include <immintrin.h>
+#if defined(_MSC_VER) || defined(__AVX2__)
+#define AVX2_TARGET
+#else
+#define AVX2_TARGET __attribute__((target("avx2")))
+#endif
+#endif
+#endif
+
+namespace uicore
+{
+	namespace
+	{
+		const int linear_to_srgb_size = 4096;
+
+		struct ResamplerTables
+		{
+			ResamplerTables()
+			{
+				for (int i = 0; i < 256; i++)
+				{
+					float c = i / 255.0f;
+					unorm8_to_float[i] = c;
+					srgb8_to_linear[i] = (c <= 0.04045f) ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+				}
+
+				for (int i = 0; i < linear_to_srgb_size; i++)
+				{
+					float c = i / (float)(linear_to_srgb_size - 1);
+					float s = (c <= 0.0031308f) ? c * 12.92f : 1.055f * std::pow(c, 1.0f / 2.4f) - 0.055f;
+					linear_to_srgb8[i] = (unsigned char)(s * 255.0f + 0.5f);
+				}
+			}
+
+			float unorm8_to_float[256];
+			float srgb8_to_linear[256];
+			unsigned char linear_to_srgb8[linear_to_srgb_size];
+		};
+
+		const ResamplerTables &resampler_tables()
+		{
+			static ResamplerTables tables;
+			return tables;
+		}
+
+		inline float clamp_unit(float v)
+		{
+			return std::min(std::max(v, 0.0f), 1.0f);
+		}
+
+#ifdef USE_AVX2
+		AVX2_TARGET void filter_horizontal_avx2(const float *src, float *dest, int dest_width, const int *start, const int *count, const float *weights4, int taps)
+		{
+			for (int x = 0; x < dest_width; x++)
+			{
+				const float *s = src + start[x] * 4;
+				const float *w = weights4 + x * taps * 4;
+				int n = count[x];
+
+				// Two source pixels per iteration
+				__m256 acc = _mm256_setzero_ps();
+				int k = 0;
+				for (; k + 1 < n; k += 2)
+					acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_loadu_ps(s + k * 4), _mm256_loadu_ps(w + k * 4)));
+
+				__m128 sum = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+				if (k < n)
+					sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(s + k * 4), _mm_loadu_ps(w + k * 4)));
+				_mm_storeu_ps(dest + x * 4, sum);
+			}
+		}
+
+		AVX2_TARGET void filter_vertical_avx2(const float **rows, const float *weights, int count, float *dest, int size)
+		{
+			int i = 0;
+			for (; i + 16 <= size; i += 16)
+			{
+				__m256 acc0 = _mm256_setzero_ps();
+				__m256 acc1 = _mm256_setzero_ps();
+				for (int k = 0; k < count; k++)
+				{
+					__m256 w = _mm256_set1_ps(weights[k]);
+					acc0 = _mm256_add_ps(acc0, _mm256_mul_ps(_mm256_loadu_ps(rows[k] + i), w));
+					acc1 = _mm256_add_ps(acc1, _mm256_mul_ps(_mm256_loadu_ps(rows[k] + i + 8), w));
+				}
+				_mm256_storeu_ps(dest + i, acc0);
+				_mm256_storeu_ps(dest + i + 8, acc1);
+			}
+
+			for (; i < size; i += 4)
+			{
+				__m128 acc = _mm_setzero_ps();
+				for (int k = 0; k < count; k++)
+					acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(rows[k] + i), _mm_set1_ps(weights[k])));
+				_mm_storeu_ps(dest + i, acc);
+			}
+		}
+#endif
+	}
+
+	std::shared_ptr<PixelBuffer> PixelBufferResampler::scale(const PixelBuffer *source, int width, int height, ResampleFilter filter)
+	{
+		if (width <= 0 || height <= 0)
+			throw Exception("Invalid size passed to PixelBuffer::scaled()");
+		if (source->is_compressed())
+			throw Exception("PixelBuffer::scaled() does not support compressed formats");
+
+		TextureFormat format = source->format();
+		if (source->width() == 0 || source->height() == 0)
+			return PixelBuffer::create(width, height, format);
+
+		// The 8 bit RGBA and BGRA layouts keep alpha in the last byte and can be filtered directly.
+		// Everything else is filtered as 32 bit float and converted back afterwards.
+		std::shared_ptr<PixelBuffer> float_source;
+		RowFormat row_format;
+		switch (format)
+		{
+		case tf_rgba8:
+		case tf_bgra8:
+			row_format = row_unorm8;
+			break;
+		case tf_srgb8_alpha8:
+			row_format = row_srgb8;
+			break;
+		case tf_rgba32f:
+			row_format = row_float32;
+			break;
+		default:
+			float_source = source->to_format(tf_rgba32f);
+			source = float_source.get();
+			row_format = row_float32;
+			break;
+		}
+
+		auto dest = PixelBuffer::create(width, height, source->format());
+
+		PixelBufferResampler resampler(source, dest.get(), row_format, filter);
+
+		// Each batch filters the source rows of its first vertical window again, so a batch should cover several windows
+		int min_batch_rows = std::max((int)((long long)8 * resampler.vert.taps * height / source->height()), 8);
+		ThreadPool::shared().parallel_for(height, min_batch_rows, [&](int begin, int end)
+		{
+			resampler.process(begin, end);
+		});
+
+		if (dest->format() != format)
+			return dest->to_format(format);
+		else
+			return dest;
+	}
+
+	PixelBufferResampler::PixelBufferResampler(const PixelBuffer *source, PixelBuffer *dest, RowFormat row_format, ResampleFilter filter)
+		: source(source), dest(dest), row_format(row_format)
+	{
+		horz = calc_contributions(source->width(), dest->width(), filter);
+		vert = calc_contributions(source->height(), dest->height(), filter);
+
+		horz_weights4.resize(horz.weights.size() * 4);
+		for (size_t i = 0; i < horz.weights.size(); i++)
+		{
+			for (int c = 0; c < 4; c++)
+				horz_weights4[i * 4 + c] = horz.weights[i];
+		}
+
+#ifdef USE_SSE2
+		use_sse2 = true;
+#endif
+#ifdef USE_AVX2
+		use_avx2 = System::detect_cpu_extension(System::avx2);
+#endif
+	}
+
+	void PixelBufferResampler::process(int begin, int end)
+	{
+		int src_width = source->width();
+		int dest_width = dest->width();
+
+		// Horizontally filtered source rows are kept in a ring buffer large enough for one vertical contribution window
+		int ring_size = vert.taps;
+		std::vector<float> src_row(src_width * 4);
+		std::vector<float> ring(ring_size * dest_width * 4);
+		std::vector<float> dest_row(dest_width * 4);
+		std::vector<const float *> rows(vert.taps);
+		int next_src_y = vert.start[begin];
+
+		for (int y = begin; y < end; y++)
+		{
+			int first = vert.start[y];
+			int count = vert.count[y];
+
+			next_src_y = std::max(next_src_y, first);
+			for (; next_src_y < first + count; next_src_y++)
+			{
+				read_row(source->line(next_src_y), src_row.data());
+				filter_horizontal(src_row.data(), ring.data() + (next_src_y % ring_size) * dest_width * 4);
+			}
+
+			for (int k = 0; k < count; k++)
+				rows[k] = ring.data() + ((first + k) % ring_size) * dest_width * 4;
+
+			filter_vertical(rows.data(), vert.weights.data() + y * vert.taps, count, dest_row.data());
+			write_row(dest_row.data(), dest->line(y));
+		}
+	}
+
+	void PixelBufferResampler::read_row(const void *src, float *dest) const
+	{
+		int width = source->width();
+		const ResamplerTables &tables = resampler_tables();
+
+		if (row_format == row_float32)
+		{
+			const float *s = static_cast<const float *>(src);
+			for (int x = 0; x < width; x++)
+			{
+				float a = s[x * 4 + 3];
+				dest[x * 4 + 0] = s[x * 4 + 0] * a;
+				dest[x * 4 + 1] = s[x * 4 + 1] * a;
+				dest[x * 4 + 2] = s[x * 4 + 2] * a;
+				dest[x * 4 + 3] = a;
+			}
+		}
+		else
+		{
+			const unsigned char *s = static_cast<const unsigned char *>(src);
+			const float *lut = (row_format == row_srgb8) ? tables.srgb8_to_linear : tables.unorm8_to_float;
+			for (int x = 0; x < width; x++)
+			{
+				float a = tables.unorm8_to_float[s[x * 4 + 3]];
+				dest[x * 4 + 0] = lut[s[x * 4 + 0]] * a;
+				dest[x * 4 + 1] = lut[s[x * 4 + 1]] * a;
+				dest[x * 4 + 2] = lut[s[x * 4 + 2]] * a;
+				dest[x * 4 + 3] = a;
+			}
+		}
+	}
+
+	void PixelBufferResampler::write_row(const float *src, void *dest_line) const
+	{
+		int width = dest->width();
+		const ResamplerTables &tables = resampler_tables();
+
+		if (row_format == row_float32)
+		{
+			float *d = static_cast<float *>(dest_line);
+			for (int x = 0; x < width; x++)
+			{
+				float a = src[x * 4 + 3];
+				float inv_a = (a > 0.0f) ? 1.0f / a : 0.0f;
+				d[x * 4 + 0] = src[x * 4 + 0] * inv_a;
+				d[x * 4 + 1] = src[x * 4 + 1] * inv_a;
+				d[x * 4 + 2] = src[x * 4 + 2] * inv_a;
+				d[x * 4 + 3] = a;
+			}
+		}
+		else if (row_format == row_srgb8)
+		{
+			unsigned char *d = static_cast<unsigned char *>(dest_line);
+			for (int x = 0; x < width; x++)
+			{
+				float a = clamp_unit(src[x * 4 + 3]);
+				float inv_a = (a > 0.0f) ? 1.0f / a : 0.0f;
+				for (int c = 0; c < 3; c++)
+					d[x * 4 + c] = tables.linear_to_srgb8[(int)(clamp_unit(src[x * 4 + c] * inv_a) * (linear_to_srgb_size - 1) + 0.5f)];
+				d[x * 4 + 3] = (unsigned char)(a * 255.0f + 0.5f);
+			}
+		}
+		else
+		{
+			unsigned char *d = static_cast<unsigned char *>(dest_line);
+			for (int x = 0; x < width; x++)
+			{
+				float a = clamp_unit(src[x * 4 + 3]);
+				float inv_a = (a > 0.0f) ? 1.0f / a : 0.0f;
+				for (int c = 0; c < 3; c++)
+					d[x * 4 + c] = (unsigned char)(clamp_unit(src[x * 4 + c] * inv_a) * 255.0f + 0.5f);
+				d[x * 4 + 3] = (unsigned char)(a * 255.0f + 0.5f);
+			}
+		}
+	}
+
+	void PixelBufferResampler::filter_horizontal(const float *src, float *dest_row) const
+	{
+		int dest_width = dest->width();
+		const int *start = horz.start.data();
+		const int *count = horz.count.data();
+		const float *weights4 = horz_weights4.data();
+		int taps = horz.taps;
+
+#ifdef USE_AVX2
+		if (use_avx2)
+		{
+			filter_horizontal_avx2(src, dest_row, dest_width, start, count, weights4, taps);
+			return;
+		}
+#endif
+
+#ifdef USE_SSE2
+		if (use_sse2)
+		{
+			for (int x = 0; x < dest_width; x++)
+			{
+				const float *s = src + start[x] * 4;
+				const float *w = weights4 + x * taps * 4;
+				__m128 acc = _mm_setzero_ps();
+				for (int k = 0; k < count[x]; k++)
+					acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(s + k * 4), _mm_loadu_ps(w + k * 4)));
+				_mm_storeu_ps(dest_row + x * 4, acc);
+			}
+			return;
+		}
+#endif
+
+		for (int x = 0; x < dest_width; x++)
+		{
+			const float *s = src + start[x] * 4;
+			const float *w = weights4 + x * taps * 4;
+			float acc[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+			for (int k = 0; k < count[x]; k++)
+			{
+				for (int c = 0; c < 4; c++)
+					acc[c] += s[k * 4 + c] * w[k * 4 + c];
+			}
+			for (int c = 0; c < 4; c++)
+				dest_row[x * 4 + c] = acc[c];
+		}
+	}
+
+	void PixelBufferResampler::filter_vertical(const float **rows, const float *weights, int count, float *dest_row) const
+	{
+		int size = dest->width() * 4;
+
+#ifdef USE_AVX2
+		if (use_avx2)
+		{
+			filter_vertical_avx2(rows, weights, count, dest_row, size);
+			return;
+		}
+#endif
+
+#ifdef USE_SSE2
+		if (use_sse2)
+		{
+			for (int i = 0; i < size; i += 4)
+			{
+				__m128 acc = _mm_setzero_ps();
+				for (int k = 0; k < count; k++)
+					acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(rows[k] + i), _mm_set1_ps(weights[k])));
+				_mm_storeu_ps(dest_row + i, acc);
+			}
+			return;
+		}
+#endif
+
+		for (int i = 0; i < size; i++)
+		{
+			float acc = 0.0f;
+			for (int k = 0; k < count; k++)
+				acc += rows[k][i] * weights[k];
+			dest_row[i] = acc;
+		}
+	}
+
+	PixelBufferResampler::Contributions PixelBufferResampler::calc_contributions(int src_size, int dest_size, ResampleFilter filter)
+	{
+		// When minifying the filter is stretched to cover all the source pixels mapping to a destination pixel
+		float scale = src_size / (float)dest_size;
+		float filter_scale = std::max(scale, 1.0f);
+		float radius = filter_support(filter) * filter_scale;
+
+		Contributions contrib;
+		contrib.taps = std::min((int)std::ceil(radius * 2.0f) + 2, src_size);
+		contrib.start.resize(dest_size);
+		contrib.count.resize(dest_size);
+		contrib.weights.resize(dest_size * contrib.taps);
+
+		for (int i = 0; i < dest_size; i++)
+		{
+			float center = (i + 0.5f) * scale;
+			int first = std::max((int)std::floor(center - radius), 0);
+			int last = std::min((int)std::ceil(center + radius), src_size - 1);
+			int count = std::min(last - first + 1, contrib.taps);
+
+			float *weights = contrib.weights.data() + i * contrib.taps;
+			float total = 0.0f;
+			for (int k = 0; k < count; k++)
+			{
+				weights[k] = filter_weight(filter, (first + k + 0.5f - center) / filter_scale);
+				total += weights[k];
+			}
+
+			// Drop zero weights at both ends
+			while (count > 1 && weights[count - 1] == 0.0f)
+				count--;
+			int skip = 0;
+			while (skip + 1 < count && weights[skip] == 0.0f)
+				skip++;
+			if (skip > 0)
+			{
+				for (int k = 0; k < count - skip; k++)
+					weights[k] = weights[k + skip];
+				for (int k = count - skip; k < count; k++)
+					weights[k] = 0.0f;
+				first += skip;
+				count -= skip;
+			}
+
+			if (total != 0.0f)
+			{
+				for (int k = 0; k < count; k++)
+					weights[k] /= total;
+			}
+			else
+			{
+				first = std::min(std::max((int)center, 0), src_size - 1);
+				count = 1;
+				weights[0] = 1.0f;
+			}
+
+			contrib.start[i] = first;
+			contrib.count[i] = count;
+		}
+
+		return contrib;
+	}
+
+	float PixelBufferResampler::filter_support(ResampleFilter filter)
+	{
+		switch (filter)
+		{
+		case resample_box: return 0.5f;
+		case resample_bilinear: return 1.0f;
+		case resample_mitchell: return 2.0f;
+		case resample_lanczos3: return 3.0f;
+		default: throw Exception("Unknown resample filter");
+		}
+	}
+
+	float PixelBufferResampler::filter_weight(ResampleFilter filter, float x)
+	{
+		const float pi = 3.14159265358979323846f;
+
+		x = std::abs(x);
+		switch (filter)
+		{
+		default:
+		case resample_box:
+			return (x < 0.5f) ? 1.0f : 0.0f;
+
+		case resample_bilinear:
+			return (x < 1.0f) ? 1.0f - x : 0.0f;
+
+		case resample_mitchell:
+		{
+			// Mitchell-Netravali with B = C = 1/3
+			const float b = 1.0f / 3.0f;
+			const float c = 1.0f / 3.0f;
+			if (x < 1.0f)
+				return ((12.0f - 9.0f * b - 6.0f * c) * x * x * x + (-18.0f + 12.0f * b + 6.0f * c) * x * x + (6.0f - 2.0f * b)) / 6.0f;
+			else if (x < 2.0f)
+				return ((-b - 6.0f * c) * x * x * x + (6.0f * b + 30.0f * c) * x * x + (-12.0f * b - 48.0f * c) * x + (8.0f * b + 24.0f * c)) / 6.0f;
+			else
+				return 0.0f;
+		}
+
+		case resample_lanczos3:
+			if (x < 1e-6f)
+				return 1.0f;
+			else if (x < 3.0f)
+				return 3.0f * std::sin(pi * x) * std::sin(pi * x / 3.0f) / (pi * pi * x * x);
+			else
+				return 0.0f;
+		}
+	}
+}
@@ -0,0 +1,84 @@
+/*
+**  UICore
+**  Copyright (c) 1997-2015 The UICore Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries UICore may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include "UICore/Display/Image/pixel_buffer.h"
+#include <vector>
+
+namespace uicore
+{
+	/// \brief Separable image resampler used by PixelBuffer::scaled
+	///
+	/// Filtering is done on premultiplied alpha in linear floating point. Each pass uses a
+	/// contribution table listing the source pixels and weights for every destination pixel.
+	class PixelBufferResampler
+	{
+	public:
+		static std::shared_ptr<PixelBuffer> scale(const PixelBuffer *source, int width, int height, ResampleFilter filter);
+
+	private:
+		struct Contributions
+		{
+			int taps = 0;                   // Max source pixels used for one destination pixel
+			std::vector<int> start;         // First source pixel for each destination pixel
+			std::vector<int> count;         // Number of source pixels for each destination pixel
+			std::vector<float> weights;     // taps weights per destination pixel
+		};
+
+		enum RowFormat
+		{
+			row_unorm8,
+			row_srgb8,
+			row_float32
+		};
+
+		PixelBufferResampler(const PixelBuffer *source, PixelBuffer *dest, RowFormat row_format, ResampleFilter filter);
+
+		void process(int begin, int end);
+
+		void read_row(const void *src, float *dest) const;
+		void write_row(const float *src, void *dest) const;
+
+		void filter_horizontal(const float *src, float *dest) const;
+		void filter_vertical(const float **rows, const float *weights, int count, float *dest) const;
+
+		static Contributions calc_contributions(int src_size, int dest_size, ResampleFilter filter);
+		static float filter_support(ResampleFilter filter);
+		static float filter_weight(ResampleFilter filter, float x);
+
+		const PixelBuffer *source;
+		PixelBuffer *dest;
+		RowFormat row_format;
+		Contributions horz;
+		Contributions vert;
+		std::vector<float> horz_weights4; // Horizontal weights repeated for each of the four channels
+		bool use_sse2 = false;
+		bool use_avx2 = false;
+	};
+}
@@ -0,0 +1,672 @@
+/*
+**  UICore
+**  Copyright (c) 1997-2015 The UICore Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries UICore may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "UICore/precomp.h"
+#include "pixel_buffer_s3tc.h"
+#include "UICore/Core/System/exception.h"
+#include "UICore/Core/System/system.h"
+#include "UICore/Core/System/thread_pool.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#if !defined __ANDROID__ && ! defined CL_DISABLE_SSE2 && (defined(_MSC_VER) || defined(__SSSE3__) || defined(__GNUC__))
+#define USE_SSSE3
+#include <tmmintrin.h>
+#if defined(_MSC_VER) || defined(__SSSE3__)
+#define SSSE3_TARGET
+#else
+#define SSSE3_TARGET __attribute__((target("ssse3")))
+#endif
+#endif
+
+namespace uicore
+{
+	namespace
+	{
+		struct S3TCTables
+		{
+			S3TCTables()
+			{
+				// Byte shuffle selecting four palette entries for one row of 2 bit indices
+				for (int bits = 0; bits < 256; bits++)
+				{
+					for (int x = 0; x < 4; x++)
+					{
+						int index = (bits >> (x * 2)) & 3;
+						for (int c = 0; c < 4; c++)
+							shuffle_masks[bits][x * 4 + c] = index * 4 + c;
+					}
+				}
+			}
+
+			alignas(16) unsigned char shuffle_masks[256][16];
+		};
+
+		const S3TCTables &s3tc_tables()
+		{
+			static S3TCTables tables;
+			return tables;
+		}
+
+		inline uint32_t pack_rgba(int r, int g, int b, int a)
+		{
+			return (uint32_t)r | ((uint32_t)g << 8) | ((uint32_t)b << 16) | ((uint32_t)a << 24);
+		}
+
+		inline void expand_565(int c, int &r, int &g, int &b)
+		{
+			r = (c >> 11) & 31;
+			g = (c >> 5) & 63;
+			b = c & 31;
+			r = (r << 3) | (r >> 2);
+			g = (g << 2) | (g >> 4);
+			b = (b << 3) | (b >> 2);
+		}
+
+		inline int to_565(float r, float g, float b)
+		{
+			int r5 = (int)(std::min(std::max(r, 0.0f), 255.0f) * 31.0f / 255.0f + 0.5f);
+			int g6 = (int)(std::min(std::max(g, 0.0f), 255.0f) * 63.0f / 255.0f + 0.5f);
+			int b5 = (int)(std::min(std::max(b, 0.0f), 255.0f) * 31.0f / 255.0f + 0.5f);
+			return (r5 << 11) | (g6 << 5) | b5;
+		}
+
+		inline int read_uint16(const unsigned char *p)
+		{
+			return p[0] | (p[1] << 8);
+		}
+
+		inline uint32_t read_uint32(const unsigned char *p)
+		{
+			return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+		}
+
+		inline void write_uint16(unsigned char *p, int v)
+		{
+			p[0] = v & 0xff;
+			p[1] = (v >> 8) & 0xff;
+		}
+
+		inline void write_uint32(unsigned char *p, uint32_t v)
+		{
+			p[0] = v & 0xff;
+			p[1] = (v >> 8) & 0xff;
+			p[2] = (v >> 16) & 0xff;
+			p[3] = (v >> 24) & 0xff;
+		}
+
+		bool is_dxt1(TextureFormat format)
+		{
+			return format == tf_compressed_rgb_s3tc_dxt1 || format == tf_compressed_rgba_s3tc_dxt1 || format == tf_compressed_srgb_s3tc_dxt1 || format == tf_compressed_srgb_alpha_s3tc_dxt1;
+		}
+
+		bool is_dxt3(TextureFormat format)
+		{
+			return format == tf_compressed_rgba_s3tc_dxt3 || format == tf_compressed_srgb_alpha_s3tc_dxt3;
+		}
+
+		bool is_dxt1_alpha(TextureFormat format)
+		{
+			return format == tf_compressed_rgba_s3tc_dxt1 || format == tf_compressed_srgb_alpha_s3tc_dxt1;
+		}
+
+		bool is_srgb(TextureFormat format)
+		{
+			return format == tf_compressed_srgb_s3tc_dxt1 || format == tf_compressed_srgb_alpha_s3tc_dxt1 || format == tf_compressed_srgb_alpha_s3tc_dxt3 || format == tf_compressed_srgb_alpha_s3tc_dxt5;
+		}
+
+		// Palette of a color block. Color 3 is transparent black in three color mode when DXT1 alpha is in use.
+		void decode_color_palette(const unsigned char *block, uint32_t *palette, bool always_four_colors, bool transparent_black)
+		{
+			int c0 = read_uint16(block);
+			int c1 = read_uint16(block + 2);
+			int r0, g0, b0, r1, g1, b1;
+			expand_565(c0, r0, g0, b0);
+			expand_565(c1, r1, g1, b1);
+
+			palette[0] = pack_rgba(r0, g0, b0, 255);
+			palette[1] = pack_rgba(r1, g1, b1, 255);
+			if (c0 > c1 || always_four_colors)
+			{
+				palette[2] = pack_rgba((2 * r0 + r1) / 3, (2 * g0 + g1) / 3, (2 * b0 + b1) / 3, 255);
+				palette[3] = pack_rgba((r0 + 2 * r1) / 3, (g0 + 2 * g1) / 3, (b0 + 2 * b1) / 3, 255);
+			}
+			else
+			{
+				palette[2] = pack_rgba((r0 + r1) / 2, (g0 + g1) / 2, (b0 + b1) / 2, 255);
+				palette[3] = transparent_black ? 0 : pack_rgba(0, 0, 0, 255);
+			}
+		}
+
+		void decode_alpha_palette(const unsigned char *block, int *palette)
+		{
+			int a0 = block[0];
+			int a1 = block[1];
+			palette[0] = a0;
+			palette[1] = a1;
+			if (a0 > a1)
+			{
+				for (int i = 1; i < 7; i++)
+					palette[i + 1] = ((7 - i) * a0 + i * a1) / 7;
+			}
+			else
+			{
+				for (int i = 1; i < 5; i++)
+					palette[i + 1] = ((5 - i) * a0 + i * a1) / 5;
+				palette[6] = 0;
+				palette[7] = 255;
+			}
+		}
+
+		inline uint64_t read_alpha_indices(const unsigned char *block)
+		{
+			uint64_t bits = 0;
+			for (int i = 0; i < 6; i++)
+				bits |= (uint64_t)block[2 + i] << (i * 8);
+			return bits;
+		}
+
+#ifdef USE_SSSE3
+		SSSE3_TARGET void decode_color_rows_ssse3(const uint32_t *palette, uint32_t indices, unsigned char *dest, int dest_pitch, int rows)
+		{
+			const S3TCTables &tables = s3tc_tables();
+			__m128i colors = _mm_loadu_si128((const __m128i*)palette);
+			for (int y = 0; y < rows; y++)
+			{
+				__m128i mask = _mm_load_si128((const __m128i*)tables.shuffle_masks[(indices >> (y * 8)) & 0xff]);
+				_mm_storeu_si128((__m128i*)(dest + y * dest_pitch), _mm_shuffle_epi8(colors, mask));
+			}
+		}
+#endif
+
+		// Squared RGB error of the best palette entry for each pixel
+		int assign_color_indices(const unsigned char *pixels, const bool *transparent, int c0, int c1, bool three_colors, int *indices)
+		{
+			int palette[4][3];
+			expand_565(c0, palette[0][0], palette[0][1], palette[0][2]);
+			expand_565(c1, palette[1][0], palette[1][1], palette[1][2]);
+			int count;
+			if (three_colors)
+			{
+				for (int c = 0; c < 3; c++)
+					palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+				count = 3;
+			}
+			else
+			{
+				for (int c = 0; c < 3; c++)
+				{
+					palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+					palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+				}
+				count = 4;
+			}
+
+			int total_error = 0;
+			for (int i = 0; i < 16; i++)
+			{
+				if (transparent[i])
+				{
+					indices[i] = 3;
+					continue;
+				}
+
+				int best_index = 0;
+				int best_error = 0x7fffffff;
+				for (int j = 0; j < count; j++)
+				{
+					int dr = pixels[i * 4 + 0] - palette[j][0];
+					int dg = pixels[i * 4 + 1] - palette[j][1];
+					int db = pixels[i * 4 + 2] - palette[j][2];
+					int error = dr * dr + dg * dg + db * db;
+					if (error < best_error)
+					{
+						best_error = error;
+						best_index = j;
+					}
+				}
+				indices[i] = best_index;
+				total_error += best_error;
+			}
+			return total_error;
+		}
+
+		// Least squares fit of the two endpoints for the current index selection
+		bool refine_color_endpoints(const unsigned char *pixels, const bool *transparent, const int *indices, bool three_colors, int &c0, int &c1)
+		{
+			static const float weights4[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+			static const float weights3[4] = { 0.0f, 1.0f, 0.5f, 0.0f };
+			const float *weights = three_colors ? weights3 : weights4;
+
+			float aa = 0.0f, bb = 0.0f, ab = 0.0f;
+			float ax[3] = { 0.0f, 0.0f, 0.0f };
+			float bx[3] = { 0.0f, 0.0f, 0.0f };
+			for (int i = 0; i < 16; i++)
+			{
+				if (transparent[i])
+					continue;
+
+				float beta = weights[indices[i]];
+				float alpha = 1.0f - beta;
+				aa += alpha * alpha;
+				bb += beta * beta;
+				ab += alpha * beta;
+				for (int c = 0; c < 3; c++)
+				{
+					ax[c] += alpha * pixels[i * 4 + c];
+					bx[c] += beta * pixels[i * 4 + c];
+				}
+			}
+
+			float det = aa * bb - ab * ab;
+			if (std::abs(det) < 1e-6f)
+				return false;
+
+			float inv_det = 1.0f / det;
+			float e0[3], e1[3];
+			for (int c = 0; c < 3; c++)
+			{
+				e0[c] = (ax[c] * bb - bx[c] * ab) * inv_det;
+				e1[c] = (bx[c] * aa - ax[c] * ab) * inv_det;
+			}
+			c0 = to_565(e0[0], e0[1], e0[2]);
+			c1 = to_565(e1[0], e1[1], e1[2]);
+			return true;
+		}
+
+		void encode_color_block(const unsigned char *pixels, unsigned char *block, bool allow_transparent)
+		{
+			bool transparent[16];
+			bool any_transparent = false;
+			int opaque = 0;
+			float mean[3] = { 0.0f, 0.0f, 0.0f };
+			for (int i = 0; i < 16; i++)
+			{
+				transparent[i] = allow_transparent && pixels[i * 4 + 3] < 128;
+				if (transparent[i])
+				{
+					any_transparent = true;
+				}
+				else
+				{
+					for (int c = 0; c < 3; c++)
+						mean[c] += pixels[i * 4 + c];
+					opaque++;
+				}
+			}
+
+			if (opaque == 0)
+			{
+				write_uint16(block, 0);
+				write_uint16(block + 2, 0);
+				write_uint32(block + 4, 0xffffffff);
+				return;
+			}
+
+			for (int c = 0; c < 3; c++)
+				mean[c] /= opaque;
+
+			// Principal axis of the colors by power iteration on the covariance matrix
+			float cov[6] = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+			for (int i = 0; i < 16; i++)
+			{
+				if (transparent[i])
+					continue;
+				float r = pixels[i * 4 + 0] - mean[0];
+				float g = pixels[i * 4 + 1] - mean[1];
+				float b = pixels[i * 4 + 2] - mean[2];
+				cov[0] += r * r;
+				cov[1] += r * g;
+				cov[2] += r * b;
+				cov[3] += g * g;
+				cov[4] += g * b;
+				cov[5] += b * b;
+			}
+
+			float axis[3] = { 1.0f, 1.0f, 1.0f };
+			for (int iteration = 0; iteration < 4; iteration++)
+			{
+				float r = axis[0] * cov[0] + axis[1] * cov[1] + axis[2] * cov[2];
+				float g = axis[0] * cov[1] + axis[1] * cov[3] + axis[2] * cov[4];
+				float b = axis[0] * cov[2] + axis[1] * cov[4] + axis[2] * cov[5];
+				float length = std::max(std::max(std::abs(r), std::abs(g)), std::abs(b));
+				if (length < 1e-6f)
+					break;
+				axis[0] = r / length;
+				axis[1] = g / length;
+				axis[2] = b / length;
+			}
+
+			int min_pixel = -1, max_pixel = -1;
+			float min_dot = 0.0f, max_dot = 0.0f;
+			for (int i = 0; i < 16; i++)
+			{
+				if (transparent[i])
+					continue;
+				float dot = pixels[i * 4 + 0] * axis[0] + pixels[i * 4 + 1] * axis[1] + pixels[i * 4 + 2] * axis[2];
+				if (min_pixel == -1 || dot < min_dot)
+				{
+					min_dot = dot;
+					min_pixel = i;
+				}
+				if (max_pixel == -1 || dot > max_dot)
+				{
+					max_dot = dot;
+					max_pixel = i;
+				}
+			}
+
+			const unsigned char *pmax = pixels + max_pixel * 4;
+			const unsigned char *pmin = pixels + min_pixel * 4;
+			int c0 = to_565(pmax[0], pmax[1], pmax[2]);
+			int c1 = to_565(pmin[0], pmin[1], pmin[2]);
+
+			int indices[16];
+			int error = assign_color_indices(pixels, transparent, c0, c1, any_transparent, indices);
+
+			for (int iteration = 0; iteration < 2 && error > 0; iteration++)
+			{
+				int new_c0 = c0, new_c1 = c1;
+				if (!refine_color_endpoints(pixels, transparent, indices, any_transparent, new_c0, new_c1) || (new_c0 == c0 && new_c1 == c1))
+					break;
+
+				int new_indices[16];
+				int new_error = assign_color_indices(pixels, transparent, new_c0, new_c1, any_transparent, new_indices);
+				if (new_error >= error)
+					break;
+
+				c0 = new_c0;
+				c1 = new_c1;
+				error = new_error;
+				std::copy(new_indices, new_indices + 16, indices);
+			}
+
+			// The decoder picks three or four color mode from the endpoint order
+			if (any_transparent ? c0 > c1 : c0 < c1)
+			{
+				std::swap(c0, c1);
+				for (int i = 0; i < 16; i++)
+				{
+					if (indices[i] < 2 || !any_transparent)
+						indices[i] ^= 1;
+				}
+			}
+			else if (c0 == c1 && !any_transparent)
+			{
+				for (int i = 0; i < 16; i++)
+					indices[i] = 0;
+			}
+
+			uint32_t bits = 0;
+			for (int i = 0; i < 16; i++)
+				bits |= (uint32_t)indices[i] << (i * 2);
+
+			write_uint16(block, c0);
+			write_uint16(block + 2, c1);
+			write_uint32(block + 4, bits);
+		}
+
+		void encode_alpha_block(const unsigned char *pixels, unsigned char *block)
+		{
+			int min_alpha = 255, max_alpha = 0;
+			for (int i = 0; i < 16; i++)
+			{
+				min_alpha = std::min(min_alpha, (int)pixels[i * 4 + 3]);
+				max_alpha = std::max(max_alpha, (int)pixels[i * 4 + 3]);
+			}
+
+			block[0] = max_alpha;
+			block[1] = min_alpha;
+			for (int i = 2; i < 8; i++)
+				block[i] = 0;
+			if (min_alpha == max_alpha)
+				return;
+
+			int palette[8];
+			decode_alpha_palette(block, palette);
+
+			uint64_t bits = 0;
+			for (int i = 0; i < 16; i++)
+			{
+				int alpha = pixels[i * 4 + 3];
+				int best_index = 0;
+				int best_error = 256;
+				for (int j = 0; j < 8; j++)
+				{
+					int error = std::abs(alpha - palette[j]);
+					if (error < best_error)
+					{
+						best_error = error;
+						best_index = j;
+					}
+				}
+				bits |= (uint64_t)best_index << (i * 3);
+			}
+
+			for (int i = 0; i < 6; i++)
+				block[2 + i] = (bits >> (i * 8)) & 0xff;
+		}
+
+		void encode_explicit_alpha_block(const unsigned char *pixels, unsigned char *block)
+		{
+			for (int i = 0; i < 8; i++)
+			{
+				int a0 = (pixels[i * 8 + 3] * 15 + 127) / 255;
+				int a1 = (pixels[i * 8 + 7] * 15 + 127) / 255;
+				block[i] = a0 | (a1 << 4);
+			}
+		}
+	}
+
+	bool PixelBufferS3TC::is_s3tc(TextureFormat format)
+	{
+		switch (format)
+		{
+		case tf_compressed_rgb_s3tc_dxt1:
+		case tf_compressed_rgba_s3tc_dxt1:
+		case tf_compressed_rgba_s3tc_dxt3:
+		case tf_compressed_rgba_s3tc_dxt5:
+		case tf_compressed_srgb_s3tc_dxt1:
+		case tf_compressed_srgb_alpha_s3tc_dxt1:
+		case tf_compressed_srgb_alpha_s3tc_dxt3:
+		case tf_compressed_srgb_alpha_s3tc_dxt5:
+			return true;
+		default:
+			return false;
+		}
+	}
+
+	std::shared_ptr<PixelBuffer> PixelBufferS3TC::decompress(const PixelBuffer *source)
+	{
+		TextureFormat format = source->format();
+		if (!is_s3tc(format))
+			throw Exception("Pixel buffer is not S3TC compressed");
+
+		int width = source->width();
+		int height = source->height();
+		auto dest = PixelBuffer::create(width, height, is_srgb(format) ? tf_srgb8_alpha8 : tf_rgba8);
+
+		int block_size = PixelBuffer::bytes_per_block(format);
+		int blocks_pitch = ((width + 3) / 4) * block_size;
+		int block_rows = (height + 3) / 4;
+
+		bool use_ssse3 = false;
+#ifdef USE_SSSE3
+		use_ssse3 = System::detect_cpu_extension(System::ssse3);
+#endif
+
+		const unsigned char *src = source->data_uint8();
+		unsigned char *dest_data = dest->data_uint8();
+		int dest_pitch = dest->pitch();
+		ThreadPool::shared().parallel_for(block_rows, 16, [&](int begin, int end)
+		{
+			for (int by = begin; by < end; by++)
+			{
+				int rows = std::min(4, height - by * 4);
+				decode_block_row(src + by * blocks_pitch, block_size, format, dest_data + by * 4 * dest_pitch, dest_pitch, width, rows, use_ssse3);
+			}
+		});
+
+		return dest;
+	}
+
+	std::shared_ptr<PixelBuffer> PixelBufferS3TC::compress(const PixelBuffer *source, TextureFormat format)
+	{
+		if (!is_s3tc(format))
+			throw Exception("Unsupported compressed format");
+
+		std::shared_ptr<PixelBuffer> converted;
+		if (source->is_compressed())
+		{
+			converted = decompress(source);
+			source = converted.get();
+		}
+		if (source->format() != tf_rgba8 && source->format() != tf_srgb8_alpha8)
+		{
+			converted = source->to_format(is_srgb(format) ? tf_srgb8_alpha8 : tf_rgba8);
+			source = converted.get();
+		}
+
+		int width = source->width();
+		int height = source->height();
+		auto dest = PixelBuffer::create(width, height, format);
+
+		int blocks_pitch = ((width + 3) / 4) * PixelBuffer::bytes_per_block(format);
+		int block_rows = (height + 3) / 4;
+
+		const unsigned char *src = source->data_uint8();
+		int src_pitch = source->pitch();
+		unsigned char *blocks = dest->data_uint8();
+		ThreadPool::shared().parallel_for(block_rows, 4, [&](int begin, int end)
+		{
+			for (int by = begin; by < end; by++)
+			{
+				int rows = std::min(4, height - by * 4);
+				encode_block_row(src + by * 4 * src_pitch, src_pitch, width, rows, format, blocks + by * blocks_pitch);
+			}
+		});
+
+		return dest;
+	}
+
+	void PixelBufferS3TC::decode_block_row(const unsigned char *blocks, int block_size, TextureFormat format, unsigned char *dest, int dest_pitch, int width, int height, bool use_ssse3)
+	{
+		bool always_four_colors = !is_dxt1(format);
+		bool transparent_black = is_dxt1_alpha(format);
+		int blocks_width = (width + 3) / 4;
+
+		for (int bx = 0; bx < blocks_width; bx++)
+		{
+			const unsigned char *block = blocks + bx * block_size;
+			const unsigned char *color_block = (block_size == 16) ? block + 8 : block;
+			unsigned char *block_dest = dest + bx * 16;
+			int columns = std::min(4, width - bx * 4);
+
+			uint32_t palette[4];
+			decode_color_palette(color_block, palette, always_four_colors, transparent_black);
+			uint32_t indices = read_uint32(color_block + 4);
+
+#ifdef USE_SSSE3
+			if (use_ssse3 && columns == 4)
+			{
+				decode_color_rows_ssse3(palette, indices, block_dest, dest_pitch, height);
+			}
+			else
+#endif
+			{
+				for (int y = 0; y < height; y++)
+				{
+					uint32_t *line = reinterpret_cast<uint32_t*>(block_dest + y * dest_pitch);
+					for (int x = 0; x < columns; x++)
+						line[x] = palette[(indices >> ((y * 4 + x) * 2)) & 3];
+				}
+			}
+
+			if (block_size != 16)
+				continue;
+
+			if (is_dxt3(format))
+			{
+				for (int y = 0; y < height; y++)
+				{
+					unsigned char *line = block_dest + y * dest_pitch;
+					for (int x = 0; x < columns; x++)
+						line[x * 4 + 3] = ((block[y * 2 + x / 2] >> ((x & 1) * 4)) & 0xf) * 17;
+				}
+			}
+			else
+			{
+				int alpha_palette[8];
+				decode_alpha_palette(block, alpha_palette);
+				uint64_t alpha_indices = read_alpha_indices(block);
+				for (int y = 0; y < height; y++)
+				{
+					unsigned char *line = block_dest + y * dest_pitch;
+					for (int x = 0; x < columns; x++)
+						line[x * 4 + 3] = alpha_palette[(alpha_indices >> ((y * 4 + x) * 3)) & 7];
+				}
+			}
+		}
+	}
+
+	void PixelBufferS3TC::encode_block_row(const unsigned char *src, int src_pitch, int width, int height, TextureFormat format, unsigned char *blocks)
+	{
+		int block_size = PixelBuffer::bytes_per_block(format);
+		int blocks_width = (width + 3) / 4;
+
+		for (int bx = 0; bx < blocks_width; bx++)
+		{
+			// Partial blocks at the right and bottom edges repeat the last pixel
+			unsigned char pixels[16 * 4];
+			for (int y = 0; y < 4; y++)
+			{
+				const uint32_t *line = reinterpret_cast<const uint32_t*>(src + std::min(y, height - 1) * src_pitch);
+				for (int x = 0; x < 4; x++)
+				{
+					uint32_t p = line[std::min(bx * 4 + x, width - 1)];
+					memcpy(pixels + (y * 4 + x) * 4, &p, 4);
+				}
+			}
+
+			unsigned char *block = blocks + bx * block_size;
+			if (is_dxt1(format))
+			{
+				encode_color_block(pixels, block, is_dxt1_alpha(format));
+			}
+			else
+			{
+				if (is_dxt3(format))
+					encode_explicit_alpha_block(pixels, block);
+				else
+					encode_alpha_block(pixels, block);
+				encode_color_block(pixels, block + 8, false);
+			}
+		}
+	}
+}
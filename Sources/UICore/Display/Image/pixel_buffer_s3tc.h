@@ -0,0 +1,54 @@
+/*
+**  UICore
+**  Copyright (c) 1997-2015 The UICore Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries UICore may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include "UICore/Display/Image/pixel_buffer.h"
+
+namespace uicore
+{
+	/// \brief Software encoder and decoder for the S3TC (BC1, BC2 and BC3) block compressed formats
+	class PixelBufferS3TC
+	{
+	public:
+		/// \brief Returns true if the format is one of the S3TC formats
+		static bool is_s3tc(TextureFormat format);
+
+		/// \brief Decodes a compressed pixel buffer to tf_rgba8, or tf_srgb8_alpha8 for the sRGB formats
+		static std::shared_ptr<PixelBuffer> decompress(const PixelBuffer *source);
+
+		/// \brief Encodes a pixel buffer to one of the S3TC formats
+		///
+		/// Endpoints are fitted along the principal axis of each block's colors and refined with a least squares pass.
+		static std::shared_ptr<PixelBuffer> compress(const PixelBuffer *source, TextureFormat format);
+
+	private:
+		static void decode_block_row(const unsigned char *blocks, int block_size, TextureFormat format, unsigned char *dest, int dest_pitch, int width, int height, bool use_ssse3);
+		static void encode_block_row(const unsigned char *src, int src_pitch, int width, int height, TextureFormat format, unsigned char *blocks);
+	};
+}
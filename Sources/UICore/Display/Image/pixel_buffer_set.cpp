@@ -29,6 +29,7 @@
 #include "UICore/precomp.h"
 #include "UICore/Display/Image/pixel_buffer_set.h"
 #include "UICore/Display/Image/pixel_buffer.h"
+#include "UICore/Core/System/thread_pool.h"
 #include <algorithm>
 
 namespace uicore
@@ -74,6 +75,40 @@ namespace uicore
 		return set;
 	}
 
+	std::shared_ptr<PixelBufferSet> PixelBufferSet::create_mipmaps(const std::shared_ptr<PixelBuffer> &image, ResampleFilter filter)
+	{
+		auto set = create(image);
+
+		std::shared_ptr<PixelBuffer> level_image = image;
+		int level = 0;
+		while (level_image->width() > 1 || level_image->height() > 1)
+		{
+			int width = std::max(level_image->width() / 2, 1);
+			int height = std::max(level_image->height() / 2, 1);
+			level_image = level_image->scaled(width, height, filter);
+			set->set_image(0, ++level, level_image);
+		}
+
+		return set;
+	}
+
+	std::future<std::shared_ptr<PixelBufferSet>> PixelBufferSet::create_mipmaps_async(const std::shared_ptr<PixelBuffer> &image, ResampleFilter filter)
+	{
+		auto promise = std::make_shared<std::promise<std::shared_ptr<PixelBufferSet>>>();
+		ThreadPool::shared().queue([=]()
+		{
+			try
+			{
+				promise->set_value(create_mipmaps(image, filter));
+			}
+			catch (...)
+			{
+				promise->set_exception(std::current_exception());
+			}
+		});
+		return promise->get_future();
+	}
+
 	std::shared_ptr<PixelBuffer> PixelBufferSetImpl::image(int slice, int level)
 	{
 		if (slice < 0 || slice >= (int)_slices.size() || level < 0)
@@ -29,8 +29,10 @@
 
 #include "UICore/precomp.h"
 #include "UICore/Display/Image/pixel_converter.h"
+#include "UICore/Display/Image/pixel_buffer.h"
 #include "UICore/Core/System/databuffer.h"
 #include "UICore/Core/System/system.h"
+#include "UICore/Core/System/thread_pool.h"
 #include "pixel_converter_impl.h"
 #include "pixel_reader_cast.h"
 #include "pixel_reader_half_float.h"
@@ -55,6 +57,13 @@
 #include "pixel_filter_swizzle.h"
 #include "pixel_filter_rgb_to_ycrcb.h"
 
+#include "pixel_kernel_8bit.h"
+#include <algorithm>
+
+#if !defined __ANDROID__ && ! defined CL_DISABLE_SSE2
+#include "pixel_kernel_sse.h"
+#endif
+
 namespace uicore
 {
 	std::shared_ptr<PixelConverter> PixelConverter::create()
@@ -64,28 +73,170 @@ namespace uicore
 
 	void PixelConverterImpl::convert(void *output, int output_pitch, TextureFormat output_format, const void *input, int input_pitch, TextureFormat input_format, int width, int height)
 	{
-		bool sse2 = System::detect_cpu_extension(System::sse2);
-		bool sse4 = System::detect_cpu_extension(System::sse4_1);
+		ConvertParams params;
+		params.output = output;
+		params.output_pitch = output_pitch;
+		params.output_format = output_format;
+		params.input = input;
+		params.input_pitch = input_pitch;
+		params.input_format = input_format;
+		params.width = width;
+		params.height = height;
+		params.sse2 = System::detect_cpu_extension(System::sse2);
+		params.ssse3 = System::detect_cpu_extension(System::ssse3);
+		params.sse4 = System::detect_cpu_extension(System::sse4_1);
+
+		// In-place conversions must visit the rows in order
+		if (_max_threads == 1 || output == input || width <= 0)
+		{
+			convert_rows(params, 0, height);
+			return;
+		}
+
+		int min_batch_rows = std::max(min_batch_pixels / width, 1);
+		ThreadPool::shared().parallel_for(height, min_batch_rows, [&](int begin, int end) { convert_rows(params, begin, end); }, _max_threads);
+	}
 
-		std::unique_ptr<PixelReader> reader = create_reader(input_format, sse2);
-		std::unique_ptr<PixelWriter> writer = create_writer(output_format, sse2, sse4);
-		std::vector<std::shared_ptr<PixelFilter> > filters = create_filters(sse2);
+	void PixelConverterImpl::convert_rows(const ConvertParams &params, int begin, int end)
+	{
+		std::unique_ptr<PixelKernel> kernel = create_kernel(params.output_format, params.input_format, params.sse2, params.ssse3);
+		if (kernel)
+		{
+			for (int input_y = begin; input_y < end; input_y++)
+			{
+				int output_y = _flip_vertical ? (params.height - 1 - input_y) : input_y;
 
-		auto work_buffer = DataBuffer::create(width * sizeof(Vec4f));
+				const char *input_line = static_cast<const char*>(params.input) + params.input_pitch * input_y;
+				char *output_line = static_cast<char*>(params.output) + params.output_pitch * output_y;
+				kernel->convert(output_line, input_line, params.width);
+			}
+			return;
+		}
+
+		std::unique_ptr<PixelReader> reader = create_reader(params.input_format, params.sse2);
+		std::unique_ptr<PixelWriter> writer = create_writer(params.output_format, params.sse2, params.sse4);
+		std::vector<std::shared_ptr<PixelFilter> > filters = create_filters(params.sse2);
+
+		auto work_buffer = DataBuffer::create(params.width * sizeof(Vec4f));
 		Vec4f *temp = work_buffer->data<Vec4f>();
-		for (int input_y = 0; input_y < height; input_y++)
+		for (int input_y = begin; input_y < end; input_y++)
 		{
-			int output_y = _flip_vertical ? (height - 1 - input_y) : input_y;
+			int output_y = _flip_vertical ? (params.height - 1 - input_y) : input_y;
 
-			const char *input_line = static_cast<const char*>(input)+input_pitch * input_y;
-			char *output_line = static_cast<char*>(output)+output_pitch * output_y;
-			reader->read(input_line, temp, width);
+			const char *input_line = static_cast<const char*>(params.input) + params.input_pitch * input_y;
+			char *output_line = static_cast<char*>(params.output) + params.output_pitch * output_y;
+			reader->read(input_line, temp, params.width);
 			for (auto & filter : filters)
-				filter->filter(temp, width);
-			writer->write(output_line, temp, width);
+				filter->filter(temp, params.width);
+			writer->write(output_line, temp, params.width);
 		}
 	}
 
+	std::unique_ptr<PixelKernel> PixelConverterImpl::create_kernel(TextureFormat output_format, TextureFormat input_format, bool sse2, bool ssse3)
+	{
+		// Filters other than premultiply alpha need the Vec4f pipeline
+		if (input_is_ycrcb() || output_is_ycrcb() || gamma() != 1.0f || swizzle() != Vec4i(0, 1, 2, 3))
+			return nullptr;
+
+		// The sRGB formats are read and written as their linear counterparts
+		if (input_format == tf_srgb8_alpha8)
+			input_format = tf_rgba8;
+		else if (input_format == tf_srgb8)
+			input_format = tf_rgb8;
+		if (output_format == tf_srgb8_alpha8)
+			output_format = tf_rgba8;
+		else if (output_format == tf_srgb8)
+			output_format = tf_rgb8;
+
+		bool input_rgba = (input_format == tf_rgba8 || input_format == tf_bgra8);
+		bool input_rgb = (input_format == tf_rgb8 || input_format == tf_bgr8);
+		bool output_rgba = (output_format == tf_rgba8 || output_format == tf_bgra8);
+		bool output_rgb = (output_format == tf_rgb8 || output_format == tf_bgr8);
+		bool swap_rb = (input_format == tf_bgra8 || input_format == tf_bgr8) != (output_format == tf_bgra8 || output_format == tf_bgr8);
+
+		if (premultiply_alpha())
+		{
+			if (input_rgba && output_rgba)
+			{
+#if !defined __ANDROID__ && ! defined CL_DISABLE_SSE2
+				if (sse2)
+				{
+					if (swap_rb)
+						return std::unique_ptr<PixelKernel>(new PixelKernelSSE2_premultiply4<true>());
+					else
+						return std::unique_ptr<PixelKernel>(new PixelKernelSSE2_premultiply4<false>());
+				}
+#endif
+				if (swap_rb)
+					return std::unique_ptr<PixelKernel>(new PixelKernel_premultiply4<true>());
+				else
+					return std::unique_ptr<PixelKernel>(new PixelKernel_premultiply4<false>());
+			}
+			else if (!input_rgb)
+			{
+				return nullptr;
+			}
+			// Premultiplying an image without alpha does not change it
+		}
+
+		if (input_format == output_format)
+		{
+			if (PixelBuffer::is_compressed(input_format))
+				return nullptr;
+			return std::unique_ptr<PixelKernel>(new PixelKernel_copy(PixelBuffer::bytes_per_pixel(input_format)));
+		}
+		else if (input_rgba && output_rgba)
+		{
+#ifdef USE_SSSE3
+			if (ssse3)
+				return std::unique_ptr<PixelKernel>(new PixelKernelSSSE3_swap_rb4());
+#endif
+#if !defined __ANDROID__ && ! defined CL_DISABLE_SSE2
+			if (sse2)
+				return std::unique_ptr<PixelKernel>(new PixelKernelSSE2_swap_rb4());
+#endif
+			return std::unique_ptr<PixelKernel>(new PixelKernel_swap_rb4());
+		}
+		else if (input_rgb && output_rgba)
+		{
+#ifdef USE_SSSE3
+			if (ssse3)
+			{
+				if (swap_rb)
+					return std::unique_ptr<PixelKernel>(new PixelKernelSSSE3_expand3to4<true>());
+				else
+					return std::unique_ptr<PixelKernel>(new PixelKernelSSSE3_expand3to4<false>());
+			}
+#endif
+			if (swap_rb)
+				return std::unique_ptr<PixelKernel>(new PixelKernel_expand3to4<true>());
+			else
+				return std::unique_ptr<PixelKernel>(new PixelKernel_expand3to4<false>());
+		}
+		else if (input_rgba && output_rgb)
+		{
+#ifdef USE_SSSE3
+			if (ssse3)
+			{
+				if (swap_rb)
+					return std::unique_ptr<PixelKernel>(new PixelKernelSSSE3_pack4to3<true>());
+				else
+					return std::unique_ptr<PixelKernel>(new PixelKernelSSSE3_pack4to3<false>());
+			}
+#endif
+			if (swap_rb)
+				return std::unique_ptr<PixelKernel>(new PixelKernel_pack4to3<true>());
+			else
+				return std::unique_ptr<PixelKernel>(new PixelKernel_pack4to3<false>());
+		}
+		else if (input_rgb && output_rgb)
+		{
+			return std::unique_ptr<PixelKernel>(new PixelKernel_swap_rb3());
+		}
+
+		return nullptr;
+	}
+
 	std::unique_ptr<PixelReader> PixelConverterImpl::create_reader(TextureFormat format, bool sse2)
 	{
 		switch (format)
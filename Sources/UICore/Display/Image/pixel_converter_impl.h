@@ -57,6 +57,14 @@ namespace uicore
 		virtual void filter(Vec4f *pixels, int num_pixels) = 0;
 	};
 
+	/// \brief Converts directly between two pixel formats without going through Vec4f
+	class PixelKernel
+	{
+	public:
+		virtual ~PixelKernel() { }
+		virtual void convert(void *output, const void *input, int num_pixels) = 0;
+	};
+
 	class PixelConverterImpl : public PixelConverter
 	{
 	public:
@@ -66,19 +74,37 @@ namespace uicore
 		Vec4i swizzle() const override { return _swizzle; }
 		bool input_is_ycrcb() const override { return _input_is_ycrcb; }
 		bool output_is_ycrcb() const override { return _output_is_ycrcb; }
+		int max_threads() const override { return _max_threads; }
 		void set_premultiply_alpha(bool value) override { _premultiply_alpha = value; }
 		void set_flip_vertical(bool value) override { _flip_vertical = value; }
 		void set_gamma(float value) override { _gamma = value; }
 		void set_swizzle(const Vec4i &value) override { _swizzle = value; }
 		void set_input_is_ycrcb(bool value) override { _input_is_ycrcb = value; }
 		void set_output_is_ycrcb(bool value) override { _output_is_ycrcb = value; }
+		void set_max_threads(int value) override { _max_threads = value; }
 
 		void convert(void *output, int output_pitch, TextureFormat output_format, const void *input, int input_pitch, TextureFormat input_format, int width, int height) override;
 
 	private:
+		struct ConvertParams
+		{
+			void *output;
+			int output_pitch;
+			TextureFormat output_format;
+			const void *input;
+			int input_pitch;
+			TextureFormat input_format;
+			int width;
+			int height;
+			bool sse2, ssse3, sse4;
+		};
+
+		void convert_rows(const ConvertParams &params, int begin, int end);
+
 		std::unique_ptr<PixelReader> create_reader(TextureFormat format, bool sse2);
 		std::unique_ptr<PixelWriter> create_writer(TextureFormat format, bool sse2, bool sse4);
 		std::vector<std::shared_ptr<PixelFilter> > create_filters(bool sse2);
+		std::unique_ptr<PixelKernel> create_kernel(TextureFormat output_format, TextureFormat input_format, bool sse2, bool ssse3);
 
 		bool _premultiply_alpha = false;
 		bool _flip_vertical = false;
@@ -86,5 +112,9 @@ namespace uicore
 		Vec4i _swizzle = Vec4i(0, 1, 2, 3);
 		bool _input_is_ycrcb = false;
 		bool _output_is_ycrcb = false;
+		int _max_threads = 0;
+
+		// A batch this size takes the 8-bit kernels roughly 70-100 us, far more than the cost of handing it to a pool thread
+		static const int min_batch_pixels = 256 * 1024;
 	};
 }
@@ -0,0 +1,145 @@
+/*
+**  UICore
+**  Copyright (c) 1997-2015 The UICore Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries UICore may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include "pixel_converter_impl.h"
+#include <cstring>
+
+namespace uicore
+{
+	class PixelKernel_copy : public PixelKernel
+	{
+	public:
+		PixelKernel_copy(int bytes_per_pixel) : bytes_per_pixel(bytes_per_pixel) { }
+
+		void convert(void *output, const void *input, int num_pixels) override
+		{
+			memcpy(output, input, num_pixels * bytes_per_pixel);
+		}
+
+	private:
+		int bytes_per_pixel;
+	};
+
+	class PixelKernel_swap_rb4 : public PixelKernel
+	{
+	public:
+		void convert(void *output, const void *input, int num_pixels) override
+		{
+			const unsigned char *s = static_cast<const unsigned char *>(input);
+			unsigned char *d = static_cast<unsigned char *>(output);
+			for (int i = 0; i < num_pixels; i++, s += 4, d += 4)
+			{
+				unsigned char r = s[0], g = s[1], b = s[2], a = s[3];
+				d[0] = b;
+				d[1] = g;
+				d[2] = r;
+				d[3] = a;
+			}
+		}
+	};
+
+	class PixelKernel_swap_rb3 : public PixelKernel
+	{
+	public:
+		void convert(void *output, const void *input, int num_pixels) override
+		{
+			const unsigned char *s = static_cast<const unsigned char *>(input);
+			unsigned char *d = static_cast<unsigned char *>(output);
+			for (int i = 0; i < num_pixels; i++, s += 3, d += 3)
+			{
+				unsigned char r = s[0], g = s[1], b = s[2];
+				d[0] = b;
+				d[1] = g;
+				d[2] = r;
+			}
+		}
+	};
+
+	template<bool swap_rb>
+	class PixelKernel_expand3to4 : public PixelKernel
+	{
+	public:
+		void convert(void *output, const void *input, int num_pixels) override
+		{
+			const unsigned char *s = static_cast<const unsigned char *>(input);
+			unsigned char *d = static_cast<unsigned char *>(output);
+			for (int i = 0; i < num_pixels; i++, s += 3, d += 4)
+			{
+				d[0] = s[swap_rb ? 2 : 0];
+				d[1] = s[1];
+				d[2] = s[swap_rb ? 0 : 2];
+				d[3] = 255;
+			}
+		}
+	};
+
+	template<bool swap_rb>
+	class PixelKernel_pack4to3 : public PixelKernel
+	{
+	public:
+		void convert(void *output, const void *input, int num_pixels) override
+		{
+			const unsigned char *s = static_cast<const unsigned char *>(input);
+			unsigned char *d = static_cast<unsigned char *>(output);
+			for (int i = 0; i < num_pixels; i++, s += 4, d += 3)
+			{
+				d[0] = s[swap_rb ? 2 : 0];
+				d[1] = s[1];
+				d[2] = s[swap_rb ? 0 : 2];
+			}
+		}
+	};
+
+	template<bool swap_rb>
+	class PixelKernel_premultiply4 : public PixelKernel
+	{
+	public:
+		void convert(void *output, const void *input, int num_pixels) override
+		{
+			const unsigned char *s = static_cast<const unsigned char *>(input);
+			unsigned char *d = static_cast<unsigned char *>(output);
+			for (int i = 0; i < num_pixels; i++, s += 4, d += 4)
+			{
+				unsigned int r = s[swap_rb ? 2 : 0], g = s[1], b = s[swap_rb ? 0 : 2], a = s[3];
+				d[0] = mul_div255(r, a);
+				d[1] = mul_div255(g, a);
+				d[2] = mul_div255(b, a);
+				d[3] = a;
+			}
+		}
+
+		// Rounded c * a / 255, exact for all 8 bit inputs
+		static unsigned char mul_div255(unsigned int c, unsigned int a)
+		{
+			unsigned int t = c * a + 128;
+			return (unsigned char)((t + (t >> 8)) >> 8);
+		}
+	};
+}
@@ -0,0 +1,184 @@
+/*
+**  UICore
+**  Copyright (c) 1997-2015 The UICore Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries UICore may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include "pixel_converter_impl.h"
+#include "pixel_kernel_8bit.h"
+
+#include <emmintrin.h>
+#if defined(_MSC_VER) || defined(__SSSE3__) || defined(__GNUC__)
+#define USE_SSSE3
+#include <tmmintrin.h>
+#if defined(_MSC_VER) || defined(__SSSE3__)
+#define SSSE3_TARGET
+#else
+#define SSSE3_TARGET __attribute__((target("ssse3")))
+#endif
+#endif
+
+namespace uicore
+{
+	class PixelKernelSSE2_swap_rb4 : public PixelKernel
+	{
+	public:
+		void convert(void *output, const void *input, int num_pixels) override
+		{
+			const unsigned char *s = static_cast<const unsigned char *>(input);
+			unsigned char *d = static_cast<unsigned char *>(output);
+
+			__m128i mask_ga = _mm_set1_epi32(0xff00ff00);
+			__m128i mask_ff = _mm_set1_epi32(0xff);
+			int sse_length = (num_pixels / 4) * 4;
+			for (int i = 0; i < sse_length; i += 4)
+			{
+				__m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i * 4));
+				__m128i ga = _mm_and_si128(pixels, mask_ga);
+				__m128i r = _mm_slli_epi32(_mm_and_si128(pixels, mask_ff), 16);
+				__m128i b = _mm_and_si128(_mm_srli_epi32(pixels, 16), mask_ff);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(d + i * 4), _mm_or_si128(ga, _mm_or_si128(r, b)));
+			}
+
+			PixelKernel_swap_rb4().convert(d + sse_length * 4, s + sse_length * 4, num_pixels - sse_length);
+		}
+	};
+
+	template<bool swap_rb>
+	class PixelKernelSSE2_premultiply4 : public PixelKernel
+	{
+	public:
+		void convert(void *output, const void *input, int num_pixels) override
+		{
+			const unsigned char *s = static_cast<const unsigned char *>(input);
+			unsigned char *d = static_cast<unsigned char *>(output);
+
+			__m128i zero = _mm_setzero_si128();
+			__m128i mask_rgb = _mm_set_epi16(0, -1, -1, -1, 0, -1, -1, -1);
+			__m128i alpha_one = _mm_set_epi16(255, 0, 0, 0, 255, 0, 0, 0);
+			__m128i half = _mm_set1_epi16(128);
+			int sse_length = (num_pixels / 4) * 4;
+			for (int i = 0; i < sse_length; i += 4)
+			{
+				__m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i * 4));
+				__m128i lo = multiply(_mm_unpacklo_epi8(pixels, zero), mask_rgb, alpha_one, half);
+				__m128i hi = multiply(_mm_unpackhi_epi8(pixels, zero), mask_rgb, alpha_one, half);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(d + i * 4), _mm_packus_epi16(lo, hi));
+			}
+
+			PixelKernel_premultiply4<swap_rb>().convert(d + sse_length * 4, s + sse_length * 4, num_pixels - sse_length);
+		}
+
+	private:
+		// Multiplies two pixels stored as 16 bit channels with their alpha, using the same rounding as PixelKernel_premultiply4
+		static __m128i multiply(__m128i pixels, __m128i mask_rgb, __m128i alpha_one, __m128i half)
+		{
+			if (swap_rb)
+				pixels = _mm_shufflehi_epi16(_mm_shufflelo_epi16(pixels, _MM_SHUFFLE(3, 0, 1, 2)), _MM_SHUFFLE(3, 0, 1, 2));
+
+			__m128i alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(pixels, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+			alpha = _mm_or_si128(_mm_and_si128(alpha, mask_rgb), alpha_one);
+
+			__m128i t = _mm_add_epi16(_mm_mullo_epi16(pixels, alpha), half);
+			return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+		}
+	};
+
+#ifdef USE_SSSE3
+	class PixelKernelSSSE3_swap_rb4 : public PixelKernel
+	{
+	public:
+		SSSE3_TARGET void convert(void *output, const void *input, int num_pixels) override
+		{
+			const unsigned char *s = static_cast<const unsigned char *>(input);
+			unsigned char *d = static_cast<unsigned char *>(output);
+
+			__m128i shuffle = _mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+			int sse_length = (num_pixels / 4) * 4;
+			for (int i = 0; i < sse_length; i += 4)
+			{
+				__m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i * 4));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(d + i * 4), _mm_shuffle_epi8(pixels, shuffle));
+			}
+
+			PixelKernel_swap_rb4().convert(d + sse_length * 4, s + sse_length * 4, num_pixels - sse_length);
+		}
+	};
+
+	template<bool swap_rb>
+	class PixelKernelSSSE3_expand3to4 : public PixelKernel
+	{
+	public:
+		SSSE3_TARGET void convert(void *output, const void *input, int num_pixels) override
+		{
+			const unsigned char *s = static_cast<const unsigned char *>(input);
+			unsigned char *d = static_cast<unsigned char *>(output);
+
+			__m128i shuffle = swap_rb ?
+				_mm_setr_epi8(2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1) :
+				_mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+			__m128i alpha = _mm_set1_epi32(0xff000000);
+
+			// Each load reads 16 bytes to get 4 pixels, so stop while at least 6 pixels remain in the input
+			int i = 0;
+			for (; i + 6 <= num_pixels; i += 4)
+			{
+				__m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i * 3));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(d + i * 4), _mm_or_si128(_mm_shuffle_epi8(pixels, shuffle), alpha));
+			}
+
+			PixelKernel_expand3to4<swap_rb>().convert(d + i * 4, s + i * 3, num_pixels - i);
+		}
+	};
+
+	template<bool swap_rb>
+	class PixelKernelSSSE3_pack4to3 : public PixelKernel
+	{
+	public:
+		SSSE3_TARGET void convert(void *output, const void *input, int num_pixels) override
+		{
+			const unsigned char *s = static_cast<const unsigned char *>(input);
+			unsigned char *d = static_cast<unsigned char *>(output);
+
+			__m128i shuffle = swap_rb ?
+				_mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1) :
+				_mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+
+			int sse_length = (num_pixels / 4) * 4;
+			for (int i = 0; i < sse_length; i += 4)
+			{
+				__m128i pixels = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i * 4)), shuffle);
+				_mm_storel_epi64(reinterpret_cast<__m128i*>(d + i * 3), pixels);
+				int last = _mm_cvtsi128_si32(_mm_srli_si128(pixels, 8));
+				memcpy(d + i * 3 + 8, &last, 4);
+			}
+
+			PixelKernel_pack4to3<swap_rb>().convert(d + sse_length * 3, s + sse_length * 4, num_pixels - sse_length);
+		}
+	};
+#endif
+}
@@ -38,11 +38,7 @@ namespace uicore
 	public:
 		void read(const void *input, Vec4f *output, int num_pixels) override
 		{
-			const Vec4hf *d = static_cast<const Vec4hf *>(input);
-			for (int i = 0; i < num_pixels; i++)
-			{
-				output[i] = Vec4f(d[i]);
-			}
+			Vec4hf::to_float_array(static_cast<const Vec4hf *>(input), output, num_pixels);
 		}
 	};
 
@@ -38,11 +38,7 @@ namespace uicore
 	public:
 		void write(void *output, Vec4f *input, int num_pixels) override
 		{
-			Vec4hf *d = static_cast<Vec4hf *>(output);
-			for (int i = 0; i < num_pixels; i++)
-			{
-				d[i] = Vec4hf(input[i]);
-			}
+			Vec4hf::from_float_array(input, static_cast<Vec4hf *>(output), num_pixels);
 		}
 	};
 
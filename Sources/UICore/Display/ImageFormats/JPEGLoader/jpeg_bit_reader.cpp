@@ -33,17 +33,32 @@
 namespace uicore
 {
 	JPEGBitReader::JPEGBitReader(JPEGFileReader *reader)
-		: reader(reader), length(0), pos(0), bitpos(0)
+		: reader(reader), data(nullptr), length(0), pos(0), bitpos(0)
 	{
 		buffer.resize(16 * 1024);
+		data = buffer.data();
+	}
+
+	JPEGBitReader::JPEGBitReader(const unsigned char *data, int length)
+		: reader(nullptr), data(data), length(length), pos(0), bitpos(0)
+	{
 	}
 
 	void JPEGBitReader::reset()
 	{
-		length = 0;
-		pos = 0;
-		bitpos = 0;
-		buffer.resize(16 * 1024);
+		if (reader)
+		{
+			length = 0;
+			pos = 0;
+			bitpos = 0;
+			buffer.resize(16 * 1024);
+			data = buffer.data();
+		}
+		else if (bitpos != 0) // Skip to the next byte
+		{
+			pos++;
+			bitpos = 0;
+		}
 	}
 
 	unsigned int JPEGBitReader::get_bit()
@@ -55,6 +70,9 @@ namespace uicore
 		}
 		if (pos == length)
 		{
+			if (!reader) // Entropy data already in memory
+				throw Exception("Premature end of JPEG entropy data");
+
 			length = reader->read_entropy_data(&buffer[0], buffer.size());
 			if (length == 0)
 			{
@@ -64,7 +82,7 @@ namespace uicore
 			pos = 0;
 		}
 
-		unsigned int v = (buffer[pos] >> (7 - bitpos)) & 0x01;
+		unsigned int v = (data[pos] >> (7 - bitpos)) & 0x01;
 		bitpos++;
 		return v;
 	}
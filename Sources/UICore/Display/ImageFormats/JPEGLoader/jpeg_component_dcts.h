@@ -28,27 +28,70 @@
 
 #pragma once
 
+#include <memory>
+#include <vector>
+
 namespace uicore
 {
+	/// \brief DCT coefficients of all the blocks in a component
+	///
+	/// Blocks are stored as 16-bit coefficients in chunks that are only allocated once a block in them is written.
+	/// Blocks never written to, such as those of components not yet seen in a progressive scan, read as zero.
+	///
+	/// This only saves memory for files whose early scans leave components or regions untouched. Typical progressive
+	/// files start with an interleaved DC scan covering every block, so the peak remains the full coefficient set:
+	/// later scans refine all blocks and nothing can be released before the last scan has been read.
 	class JPEGComponentDCTs
 	{
 	public:
 		void resize(size_t size);
+
+		/// \brief Returns the block for writing, allocating it if needed
 		short *get(size_t index);
 
+		/// \brief Returns the block for reading
+		const short *find(size_t index) const;
+
+		/// \brief Allocates all blocks up front, which makes get() safe to call from multiple threads
+		void allocate_all();
+
 	private:
-		std::vector<short> dcts;
+		enum { blocks_per_chunk = 256, block_coefficients = 64 };
+
+		std::vector<std::unique_ptr<short[]>> chunks;
+		size_t block_count = 0;
 	};
 
 	inline void JPEGComponentDCTs::resize(size_t size)
 	{
-		dcts.resize(size * 64, 0);
+		block_count = size;
+		chunks.resize((size + blocks_per_chunk - 1) / blocks_per_chunk);
 	}
 
 	inline short *JPEGComponentDCTs::get(size_t index)
 	{
-		if (dcts.size() < (index + 1) * 64)
-			dcts.resize((index + 1) * 64, 0);
-		return &dcts[index * 64];
+		if (index >= block_count)
+			resize(index + 1);
+
+		std::unique_ptr<short[]> &chunk = chunks[index / blocks_per_chunk];
+		if (!chunk)
+			chunk.reset(new short[blocks_per_chunk * block_coefficients]());
+		return chunk.get() + (index % blocks_per_chunk) * block_coefficients;
+	}
+
+	inline const short *JPEGComponentDCTs::find(size_t index) const
+	{
+		static const short zero_block[block_coefficients] = { 0 };
+
+		size_t chunk_index = index / blocks_per_chunk;
+		if (chunk_index >= chunks.size() || !chunks[chunk_index])
+			return zero_block;
+		return chunks[chunk_index].get() + (index % blocks_per_chunk) * block_coefficients;
+	}
+
+	inline void JPEGComponentDCTs::allocate_all()
+	{
+		for (size_t i = 0; i < chunks.size(); i++)
+			get(i * blocks_per_chunk);
 	}
 }
@@ -0,0 +1,284 @@
+/*
+**  UICore
+**  Copyright (c) 1997-2015 The UICore Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries UICore may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "UICore/precomp.h"
+#include "jpeg_decoder_avx2.h"
+
+#if !defined __ANDROID__ && ! defined CL_DISABLE_SSE2 && (defined(_MSC_VER) || defined(__AVX2__) || defined(__GNUC__))
+#define USE_AVX2
+#include <immintrin.h>
+#if defined(_MSC_VER) || defined(__AVX2__)
+#define AVX2_TARGET
+#else
+#define AVX2_TARGET __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace uicore
+{
+#ifdef USE_AVX2
+
+	namespace
+	{
+		const int const_bits = 13;
+		const int pass1_bits = 2;
+
+		// Constants scaled by 2^13
+		const int fix_0_298631336 = 2446;
+		const int fix_0_390180644 = 3196;
+		const int fix_0_541196100 = 4433;
+		const int fix_0_765366865 = 6270;
+		const int fix_0_899976223 = 7373;
+		const int fix_1_175875602 = 9633;
+		const int fix_1_501321110 = 12299;
+		const int fix_1_847759065 = 15137;
+		const int fix_1_961570560 = 16069;
+		const int fix_2_053119869 = 16819;
+		const int fix_2_562915447 = 20995;
+		const int fix_3_072711026 = 25172;
+
+		AVX2_TARGET inline __m256i mul_const(__m256i v, int c)
+		{
+			return _mm256_mullo_epi32(v, _mm256_set1_epi32(c));
+		}
+
+		AVX2_TARGET inline void transpose8x8(__m256i *r)
+		{
+			__m256i t0 = _mm256_unpacklo_epi32(r[0], r[1]);
+			__m256i t1 = _mm256_unpackhi_epi32(r[0], r[1]);
+			__m256i t2 = _mm256_unpacklo_epi32(r[2], r[3]);
+			__m256i t3 = _mm256_unpackhi_epi32(r[2], r[3]);
+			__m256i t4 = _mm256_unpacklo_epi32(r[4], r[5]);
+			__m256i t5 = _mm256_unpackhi_epi32(r[4], r[5]);
+			__m256i t6 = _mm256_unpacklo_epi32(r[6], r[7]);
+			__m256i t7 = _mm256_unpackhi_epi32(r[6], r[7]);
+
+			__m256i u0 = _mm256_unpacklo_epi64(t0, t2);
+			__m256i u1 = _mm256_unpackhi_epi64(t0, t2);
+			__m256i u2 = _mm256_unpacklo_epi64(t1, t3);
+			__m256i u3 = _mm256_unpackhi_epi64(t1, t3);
+			__m256i u4 = _mm256_unpacklo_epi64(t4, t6);
+			__m256i u5 = _mm256_unpackhi_epi64(t4, t6);
+			__m256i u6 = _mm256_unpacklo_epi64(t5, t7);
+			__m256i u7 = _mm256_unpackhi_epi64(t5, t7);
+
+			r[0] = _mm256_permute2x128_si256(u0, u4, 0x20);
+			r[1] = _mm256_permute2x128_si256(u1, u5, 0x20);
+			r[2] = _mm256_permute2x128_si256(u2, u6, 0x20);
+			r[3] = _mm256_permute2x128_si256(u3, u7, 0x20);
+			r[4] = _mm256_permute2x128_si256(u0, u4, 0x31);
+			r[5] = _mm256_permute2x128_si256(u1, u5, 0x31);
+			r[6] = _mm256_permute2x128_si256(u2, u6, 0x31);
+			r[7] = _mm256_permute2x128_si256(u3, u7, 0x31);
+		}
+
+		// One 1D IDCT pass over eight columns at once. Each vector holds one row of the block.
+		AVX2_TARGET inline void idct_pass(__m256i *r, int shift)
+		{
+			/* Even part */
+
+			__m256i z1 = mul_const(_mm256_add_epi32(r[2], r[6]), fix_0_541196100);
+			__m256i tmp2 = _mm256_sub_epi32(z1, mul_const(r[6], fix_1_847759065));
+			__m256i tmp3 = _mm256_add_epi32(z1, mul_const(r[2], fix_0_765366865));
+
+			__m256i tmp0 = _mm256_slli_epi32(_mm256_add_epi32(r[0], r[4]), const_bits);
+			__m256i tmp1 = _mm256_slli_epi32(_mm256_sub_epi32(r[0], r[4]), const_bits);
+
+			__m256i tmp10 = _mm256_add_epi32(tmp0, tmp3);
+			__m256i tmp13 = _mm256_sub_epi32(tmp0, tmp3);
+			__m256i tmp11 = _mm256_add_epi32(tmp1, tmp2);
+			__m256i tmp12 = _mm256_sub_epi32(tmp1, tmp2);
+
+			/* Odd part */
+
+			tmp0 = r[7];
+			tmp1 = r[5];
+			tmp2 = r[3];
+			tmp3 = r[1];
+
+			z1 = _mm256_add_epi32(tmp0, tmp3);
+			__m256i z2 = _mm256_add_epi32(tmp1, tmp2);
+			__m256i z3 = _mm256_add_epi32(tmp0, tmp2);
+			__m256i z4 = _mm256_add_epi32(tmp1, tmp3);
+			__m256i z5 = mul_const(_mm256_add_epi32(z3, z4), fix_1_175875602);
+
+			tmp0 = mul_const(tmp0, fix_0_298631336);
+			tmp1 = mul_const(tmp1, fix_2_053119869);
+			tmp2 = mul_const(tmp2, fix_3_072711026);
+			tmp3 = mul_const(tmp3, fix_1_501321110);
+			z1 = mul_const(z1, -fix_0_899976223);
+			z2 = mul_const(z2, -fix_2_562915447);
+			z3 = _mm256_add_epi32(mul_const(z3, -fix_1_961570560), z5);
+			z4 = _mm256_add_epi32(mul_const(z4, -fix_0_390180644), z5);
+
+			tmp0 = _mm256_add_epi32(tmp0, _mm256_add_epi32(z1, z3));
+			tmp1 = _mm256_add_epi32(tmp1, _mm256_add_epi32(z2, z4));
+			tmp2 = _mm256_add_epi32(tmp2, _mm256_add_epi32(z2, z3));
+			tmp3 = _mm256_add_epi32(tmp3, _mm256_add_epi32(z1, z4));
+
+			/* Final output stage: descale with rounding */
+
+			__m256i round = _mm256_set1_epi32(1 << (shift - 1));
+			tmp10 = _mm256_add_epi32(tmp10, round);
+			tmp11 = _mm256_add_epi32(tmp11, round);
+			tmp12 = _mm256_add_epi32(tmp12, round);
+			tmp13 = _mm256_add_epi32(tmp13, round);
+
+			r[0] = _mm256_srai_epi32(_mm256_add_epi32(tmp10, tmp3), shift);
+			r[7] = _mm256_srai_epi32(_mm256_sub_epi32(tmp10, tmp3), shift);
+			r[1] = _mm256_srai_epi32(_mm256_add_epi32(tmp11, tmp2), shift);
+			r[6] = _mm256_srai_epi32(_mm256_sub_epi32(tmp11, tmp2), shift);
+			r[2] = _mm256_srai_epi32(_mm256_add_epi32(tmp12, tmp1), shift);
+			r[5] = _mm256_srai_epi32(_mm256_sub_epi32(tmp12, tmp1), shift);
+			r[3] = _mm256_srai_epi32(_mm256_add_epi32(tmp13, tmp0), shift);
+			r[4] = _mm256_srai_epi32(_mm256_sub_epi32(tmp13, tmp0), shift);
+		}
+
+		AVX2_TARGET void idct_avx2(const short *inptr, unsigned char *outptr, int pitch, const int *quantptr)
+		{
+			__m256i r[8];
+			for (int i = 0; i < 8; i++)
+			{
+				__m256i coeffs = _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(inptr + i * 8)));
+				r[i] = _mm256_mullo_epi32(coeffs, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(quantptr + i * 8)));
+			}
+
+			/* Pass 1: process columns, keeping pass1_bits of extra precision */
+			idct_pass(r, const_bits - pass1_bits);
+
+			/* Pass 2: process rows, descaling by the factor of 8 and the extra precision */
+			transpose8x8(r);
+			idct_pass(r, const_bits + pass1_bits + 3);
+			transpose8x8(r);
+
+			/* Range limit and store */
+			__m256i center = _mm256_set1_epi32(128);
+			for (int i = 0; i < 8; i += 2)
+			{
+				__m256i row0 = _mm256_add_epi32(r[i], center);
+				__m256i row1 = _mm256_add_epi32(r[i + 1], center);
+				__m256i words = _mm256_permute4x64_epi64(_mm256_packs_epi32(row0, row1), 0xd8); // row0 in the low half, row1 in the high half
+				__m128i bytes = _mm_packus_epi16(_mm256_castsi256_si128(words), _mm256_extracti128_si256(words, 1));
+				_mm_storel_epi64(reinterpret_cast<__m128i*>(outptr), bytes);
+				_mm_storel_epi64(reinterpret_cast<__m128i*>(outptr + pitch), _mm_srli_si128(bytes, 8));
+				outptr += pitch * 2;
+			}
+		}
+
+		AVX2_TARGET void convert_ycbcr_h2_avx2(const unsigned char *y_line, const unsigned char *cb_line, const unsigned char *cr_line, unsigned int *output, int width)
+		{
+			__m256 offset = _mm256_set1_ps(128.0f);
+			__m256 cr_r = _mm256_set1_ps(1.40200f);
+			__m256 cb_g = _mm256_set1_ps(0.34414f);
+			__m256 cr_g = _mm256_set1_ps(0.71414f);
+			__m256 cb_b = _mm256_set1_ps(1.77200f);
+			__m256 zero = _mm256_setzero_ps();
+			__m256 max_value = _mm256_set1_ps(255.0f);
+			__m256 half = _mm256_set1_ps(0.5f);
+			__m256i alpha = _mm256_set1_epi32(0xff000000);
+
+			int avx_width = (width / 8) * 8;
+			for (int x = 0; x < avx_width; x += 8)
+			{
+				int cb4, cr4;
+				memcpy(&cb4, cb_line + x / 2, 4);
+				memcpy(&cr4, cr_line + x / 2, 4);
+
+				// Upsample by duplicating each chroma sample
+				__m128i cb8 = _mm_cvtsi32_si128(cb4);
+				__m128i cr8 = _mm_cvtsi32_si128(cr4);
+				cb8 = _mm_unpacklo_epi8(cb8, cb8);
+				cr8 = _mm_unpacklo_epi8(cr8, cr8);
+
+				__m256 Y = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(y_line + x))));
+				__m256 Cb = _mm256_sub_ps(_mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(cb8)), offset);
+				__m256 Cr = _mm256_sub_ps(_mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(cr8)), offset);
+
+				__m256 R = _mm256_add_ps(Y, _mm256_mul_ps(cr_r, Cr));
+				__m256 G = _mm256_sub_ps(_mm256_sub_ps(Y, _mm256_mul_ps(cb_g, Cb)), _mm256_mul_ps(cr_g, Cr));
+				__m256 B = _mm256_add_ps(Y, _mm256_mul_ps(cb_b, Cb));
+
+				R = _mm256_add_ps(_mm256_min_ps(_mm256_max_ps(R, zero), max_value), half);
+				G = _mm256_add_ps(_mm256_min_ps(_mm256_max_ps(G, zero), max_value), half);
+				B = _mm256_add_ps(_mm256_min_ps(_mm256_max_ps(B, zero), max_value), half);
+
+				__m256i pixels = _mm256_add_epi32(alpha, _mm256_add_epi32(_mm256_add_epi32(_mm256_cvttps_epi32(B), _mm256_slli_epi32(_mm256_cvttps_epi32(G), 8)), _mm256_slli_epi32(_mm256_cvttps_epi32(R), 16)));
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(output + x), pixels);
+			}
+
+			for (int x = avx_width; x < width; x++)
+			{
+				float Y = y_line[x];
+				float Cb = cb_line[x / 2] - 128.0f;
+				float Cr = cr_line[x / 2] - 128.0f;
+
+				float R = Y + 1.40200f * Cr;
+				float G = Y - 0.34414f * Cb - 0.71414f * Cr;
+				float B = Y + 1.77200f * Cb;
+
+				R = std::min(std::max(R, 0.0f), 255.0f) + 0.5f;
+				G = std::min(std::max(G, 0.0f), 255.0f) + 0.5f;
+				B = std::min(std::max(B, 0.0f), 255.0f) + 0.5f;
+
+				output[x] = 0xff000000 + ((unsigned int)B) + (((unsigned int)G) << 8) + (((unsigned int)R) << 16);
+			}
+		}
+	}
+
+	bool JPEGDecoderAVX2::is_available()
+	{
+		return true;
+	}
+
+	void JPEGDecoderAVX2::idct(const short *inptr, unsigned char *outptr, int pitch, const int *quantptr)
+	{
+		idct_avx2(inptr, outptr, pitch, quantptr);
+	}
+
+	void JPEGDecoderAVX2::convert_ycbcr_h2(const unsigned char *y_line, const unsigned char *cb_line, const unsigned char *cr_line, unsigned int *output, int width)
+	{
+		convert_ycbcr_h2_avx2(y_line, cb_line, cr_line, output, width);
+	}
+
+#else
+
+	bool JPEGDecoderAVX2::is_available()
+	{
+		return false;
+	}
+
+	void JPEGDecoderAVX2::idct(const short *inptr, unsigned char *outptr, int pitch, const int *quantptr)
+	{
+	}
+
+	void JPEGDecoderAVX2::convert_ycbcr_h2(const unsigned char *y_line, const unsigned char *cb_line, const unsigned char *cr_line, unsigned int *output, int width)
+	{
+	}
+
+#endif
+}
@@ -0,0 +1,50 @@
+/*
+**  UICore
+**  Copyright (c) 1997-2015 The UICore Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries UICore may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+namespace uicore
+{
+	/// \brief AVX2 kernels for the JPEG decoder
+	///
+	/// Only call these if System::detect_cpu_extension(System::avx2) returns true.
+	class JPEGDecoderAVX2
+	{
+	public:
+		/// \brief Returns true if the kernels were compiled into this build
+		static bool is_available();
+
+		/// \brief Integer 8x8 IDCT (same algorithm as the libjpeg islow IDCT)
+		static void idct(const short *inptr, unsigned char *outptr, int pitch, const int *quantptr);
+
+		/// \brief Converts a row of YCbCr with horizontally subsampled chroma to BGRA
+		///
+		/// Each chroma sample covers two pixels, as with 4:2:0 and 4:2:2 subsampling.
+		static void convert_ycbcr_h2(const unsigned char *y_line, const unsigned char *cb_line, const unsigned char *cr_line, unsigned int *output, int width);
+	};
+}
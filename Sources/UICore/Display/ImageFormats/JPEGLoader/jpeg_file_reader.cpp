@@ -335,30 +335,54 @@ namespace uicore
 		uint8_t *data = reinterpret_cast<uint8_t*>(d);
 
 		int start = iodevice->position();
-		int len = iodevice->try_read(data, size);
+
+		// Unstuff directly from memory backed devices instead of copying the data twice
+		int len = size;
+		const uint8_t *src = static_cast<const uint8_t*>(iodevice->try_read_in_place(size));
+		if (!src)
+		{
+			len = iodevice->try_read(data, size);
+			src = data;
+		}
 		if (len == 0)
 			return 0;
 
 		int j = 0;
 		for (int i = 0; i < len; i++)
 		{
-			if (data[i] == 0xff && i + 1 < len && data[i + 1] == 0x00)
+			if (src[i] == 0xff && i + 1 < len && src[i + 1] == 0x00)
 			{
 				data[j] = 0xff;
 				j++;
 				i++;
 			}
-			else if (data[i] == 0xff)
+			else if (src[i] == 0xff)
 			{
 				iodevice->seek(start + i);
 				break;
 			}
 			else
 			{
-				data[j] = data[i];
+				data[j] = src[i];
 				j++;
 			}
 		}
 		return j;
 	}
+
+	void JPEGFileReader::read_entropy_segment(std::vector<unsigned char> &segment)
+	{
+		// Reads entropy data until the next marker
+		const int block_size = 16 * 1024;
+		segment.clear();
+		while (true)
+		{
+			size_t pos = segment.size();
+			segment.resize(pos + block_size);
+			int length = read_entropy_data(segment.data() + pos, block_size);
+			segment.resize(pos + length);
+			if (length == 0)
+				break;
+		}
+	}
 }
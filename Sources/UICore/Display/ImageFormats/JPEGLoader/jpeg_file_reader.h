@@ -58,6 +58,7 @@ namespace uicore
 		JPEGDefineNumberOfLines read_dnl();
 		std::string read_comment();
 		int read_entropy_data(void *d, int size);
+		void read_entropy_segment(std::vector<unsigned char> &segment);
 
 	private:
 		std::shared_ptr<IODevice> iodevice;
@@ -32,53 +32,131 @@
 #include "jpeg_huffman_decoder.h"
 #include "jpeg_mcu_decoder.h"
 #include "jpeg_rgb_decoder.h"
+#include "UICore/Core/System/thread_pool.h"
 
 namespace uicore
 {
-	std::shared_ptr<PixelBuffer> JPEGLoader::load(const std::shared_ptr<IODevice> &iodevice, bool srgb)
+	std::shared_ptr<PixelBuffer> JPEGLoader::load(const std::shared_ptr<IODevice> &iodevice, bool srgb, int scale_denominator, const ScanCallback &scan_callback)
 	{
-		JPEGLoader loader(iodevice);
-		JPEGMCUDecoder mcu_decoder(&loader);
-		JPEGRGBDecoder rgb_decoder(&loader);
+		if (scale_denominator != 1 && scale_denominator != 2 && scale_denominator != 4 && scale_denominator != 8)
+			throw Exception("Unsupported JPEG scale");
 
-		int image_width = loader.start_of_frame.width;
-		int image_height = loader.start_of_frame.height;
-		auto image = PixelBuffer::create(image_width, image_height, srgb ? tf_srgb8_alpha8 : tf_rgba8);
-		unsigned int *image_pixels = image->data_uint32();
+		std::shared_ptr<PixelBuffer> image;
+
+		std::function<void(JPEGLoader &)> scan_complete;
+		if (scan_callback)
+		{
+			scan_complete = [&](JPEGLoader &loader)
+			{
+				if (loader.start_of_frame.height == 0) // Height is defined by a DNL marker later on
+					return;
+
+				if (!image)
+					image = loader.create_image(srgb);
+				loader.decode_image(image.get());
+				scan_callback(image);
+			};
+		}
+
+		JPEGLoader loader(iodevice, 8 / scale_denominator, scan_complete);
+
+		// The scan callback already rendered the final scan of progressive images
+		if (!image)
+		{
+			image = loader.create_image(srgb);
+			loader.decode_image(image.get());
+		}
+
+		return image;
+	}
 
-		const unsigned int *block_pixels = rgb_decoder.get_pixels();
-		int block_width = rgb_decoder.get_width();
-		int block_height = rgb_decoder.get_height();
+	ImageFileInfo JPEGLoader::probe(const std::shared_ptr<IODevice> &iodevice, bool srgb)
+	{
+		JPEGFileReader reader(iodevice);
+
+		JPEGMarker marker = reader.read_marker();
+		if (marker != marker_soi)
+			throw Exception("Not a JPEG file");
 
-		for (int curMcuY = 0, y = 0; curMcuY < loader.mcu_height; curMcuY++, y += block_height)
+		marker = reader.read_marker();
+		while (marker != marker_eoi && marker != marker_sos)
 		{
-			for (int curMcuX = 0, x = 0; curMcuX < loader.mcu_width; curMcuX++, x += block_width)
+			if (marker == marker_sof0 || marker == marker_sof2)
+			{
+				JPEGStartOfFrame sof = reader.read_sof();
+				if (sof.height == 0) // Height is defined by a DNL marker after the first scan
+					throw Exception("JPEG image height is not stored in the frame header");
+				return ImageFileInfo(sof.width, sof.height, srgb ? tf_srgb8_alpha8 : tf_rgba8);
+			}
+			else if ((marker >= marker_sof0 && marker <= marker_sof3) || (marker >= marker_sof5 && marker <= marker_sof15))
 			{
-				mcu_decoder.decode(curMcuX + curMcuY * loader.mcu_width);
-				rgb_decoder.decode(&mcu_decoder);
+				throw Exception("JPEG compression method not supported");
+			}
+			else
+			{
+				reader.skip_unknown();
+			}
+
+			marker = reader.read_marker();
+		}
 
-				int w = min(block_width, image_width - x);
-				int h = min(block_height, image_height - y);
-				for (int yy = 0; yy < h; yy++)
+		throw Exception("Invalid JPEG Image");
+	}
+
+	std::shared_ptr<PixelBuffer> JPEGLoader::create_image(bool srgb) const
+	{
+		int scale_denominator = 8 / idct_size;
+		int image_width = (start_of_frame.width + scale_denominator - 1) / scale_denominator;
+		int image_height = (start_of_frame.height + scale_denominator - 1) / scale_denominator;
+		return PixelBuffer::create(image_width, image_height, srgb ? tf_srgb8_alpha8 : tf_rgba8);
+	}
+
+	void JPEGLoader::decode_image(PixelBuffer *image)
+	{
+		int image_width = image->width();
+		int image_height = image->height();
+		unsigned int *image_pixels = image->data_uint32();
+
+		// Each MCU row covers a separate part of the image, allowing the rows to be decoded in parallel
+		int block_rows_pixels = image_width * mcu_y * idct_size;
+		int min_batch_rows = max(64 * 1024 / max(block_rows_pixels, 1), 1);
+		ThreadPool::shared().parallel_for(mcu_height, min_batch_rows, [&](int begin, int end)
+		{
+			JPEGMCUDecoder mcu_decoder(this);
+			JPEGRGBDecoder rgb_decoder(this);
+
+			const unsigned int *block_pixels = rgb_decoder.get_pixels();
+			int block_width = rgb_decoder.get_width();
+			int block_height = rgb_decoder.get_height();
+
+			for (int curMcuY = begin, y = begin * block_height; curMcuY < end; curMcuY++, y += block_height)
+			{
+				for (int curMcuX = 0, x = 0; curMcuX < mcu_width; curMcuX++, x += block_width)
 				{
-					for (int xx = 0; xx < w; xx++)
+					mcu_decoder.decode(curMcuX + curMcuY * mcu_width);
+					rgb_decoder.decode(&mcu_decoder);
+
+					int w = min(block_width, image_width - x);
+					int h = min(block_height, image_height - y);
+					for (int yy = 0; yy < h; yy++)
 					{
-						unsigned int p = block_pixels[xx + yy*block_width];
-						unsigned int red = (p >> 16) & 0xff;
-						unsigned int green = (p >> 8) & 0xff;
-						unsigned int blue = p & 0xff;
-						unsigned int alpha = (p >> 24) & 0xff;
-						image_pixels[x + xx + (y + yy)*image_width] = (alpha << 24) | (blue << 16) | (green << 8) | red;
+						for (int xx = 0; xx < w; xx++)
+						{
+							unsigned int p = block_pixels[xx + yy*block_width];
+							unsigned int red = (p >> 16) & 0xff;
+							unsigned int green = (p >> 8) & 0xff;
+							unsigned int blue = p & 0xff;
+							unsigned int alpha = (p >> 24) & 0xff;
+							image_pixels[x + xx + (y + yy)*image_width] = (alpha << 24) | (blue << 16) | (green << 8) | red;
+						}
 					}
 				}
 			}
-		}
-
-		return image;
+		});
 	}
 
-	JPEGLoader::JPEGLoader(const std::shared_ptr<IODevice> &iodevice)
-		: progressive(false), scan_count(0), mcu_x(0), mcu_y(0), mcu_width(0), mcu_height(0), restart_interval(0), eobrun(0), is_jfif_jpeg(false), is_adobe_jpeg(false), adobe_app14_transform(1)
+	JPEGLoader::JPEGLoader(const std::shared_ptr<IODevice> &iodevice, int idct_size, const std::function<void(JPEGLoader &)> &scan_complete)
+		: progressive(false), scan_count(0), mcu_x(0), mcu_y(0), mcu_width(0), mcu_height(0), restart_interval(0), eobrun(0), idct_size(idct_size), is_jfif_jpeg(false), is_adobe_jpeg(false), adobe_app14_transform(1)
 	{
 		JPEGFileReader reader(iodevice);
 
@@ -118,6 +196,8 @@ namespace uicore
 				/*try
 				{*/
 				process_sos(reader);
+				if (progressive && scan_complete)
+					scan_complete(*this);
 				/*}
 				catch (...)
 				{
@@ -305,6 +385,13 @@ namespace uicore
 		verify_dc_table_selector(start_of_scan);
 		verify_ac_table_selector(start_of_scan);
 
+		// Restart intervals reset all decoder state, so the intervals can be decoded independently
+		if (restart_interval != 0 && start_of_frame.height != 0 && restart_interval < mcu_width*mcu_height)
+		{
+			process_sos_sequential_restart_intervals(start_of_scan, component_to_sof, reader);
+			return;
+		}
+
 		JPEGBitReader bit_reader(&reader);
 		int restart_counter = 0;
 		for (int mcu_block = 0; mcu_block < mcu_width*mcu_height; mcu_block++)
@@ -324,46 +411,91 @@ namespace uicore
 			}
 			restart_counter++;
 
-			for (size_t c = 0; c < start_of_scan.components.size(); c++)
+			decode_sequential_mcu(start_of_scan, component_to_sof, bit_reader, mcu_block, last_dc_values);
+		}
+	}
+
+	void JPEGLoader::process_sos_sequential_restart_intervals(JPEGStartOfScan &start_of_scan, const std::vector<int> &component_to_sof, JPEGFileReader &reader)
+	{
+		int mcu_count = mcu_width*mcu_height;
+		int interval_count = (mcu_count + restart_interval - 1) / restart_interval;
+
+		std::vector<std::vector<unsigned char>> intervals(interval_count);
+		for (int i = 0; i < interval_count; i++)
+		{
+			if (i > 0)
+			{
+				JPEGMarker marker = reader.read_marker();
+				if (marker < marker_rst0 || marker > marker_rst7)
+				{
+					throw Exception("Restart marker missing between JPEG entropy data");
+				}
+			}
+			reader.read_entropy_segment(intervals[i]);
+		}
+
+		for (int c : component_to_sof)
+			component_dcts[c].allocate_all();
+
+		ThreadPool::shared().parallel_for(interval_count, 1, [&](int begin, int end)
+		{
+			std::vector<short> dc_values(start_of_frame.components.size());
+			for (int i = begin; i < end; i++)
+			{
+				for (auto & elem : dc_values)
+					elem = 0;
+
+				JPEGBitReader bit_reader(intervals[i].data(), (int)intervals[i].size());
+				int mcu_end = min((i + 1) * restart_interval, mcu_count);
+				for (int mcu_block = i * restart_interval; mcu_block < mcu_end; mcu_block++)
+					decode_sequential_mcu(start_of_scan, component_to_sof, bit_reader, mcu_block, dc_values);
+			}
+		});
+
+		eobrun = 0;
+	}
+
+	void JPEGLoader::decode_sequential_mcu(const JPEGStartOfScan &start_of_scan, const std::vector<int> &component_to_sof, JPEGBitReader &bit_reader, int mcu_block, std::vector<short> &dc_values)
+	{
+		for (size_t c = 0; c < start_of_scan.components.size(); c++)
+		{
+			int c_sof = component_to_sof[c];
+			const JPEGHuffmanTable &dc_table = huffman_dc_tables[start_of_scan.components[c].dc_table_selector];
+			const JPEGHuffmanTable &ac_table = huffman_ac_tables[start_of_scan.components[c].ac_table_selector];
+			int scale_x = start_of_frame.components[c_sof].horz_sampling_factor;
+			int scale_y = start_of_frame.components[c_sof].vert_sampling_factor;
+			for (int i = 0; i < scale_x * scale_y; i++)
 			{
-				int c_sof = component_to_sof[c];
-				const JPEGHuffmanTable &dc_table = huffman_dc_tables[start_of_scan.components[c].dc_table_selector];
-				const JPEGHuffmanTable &ac_table = huffman_ac_tables[start_of_scan.components[c].ac_table_selector];
-				int scale_x = start_of_frame.components[c_sof].horz_sampling_factor;
-				int scale_y = start_of_frame.components[c_sof].vert_sampling_factor;
-				for (int i = 0; i < scale_x * scale_y; i++)
+				short *dct = component_dcts[c_sof].get(mcu_block*scale_x*scale_y + i);
+				for (int j = start_of_scan.start_dct_coefficient; j <= start_of_scan.end_dct_coefficient; j++)
 				{
-					short *dct = component_dcts[c_sof].get(mcu_block*scale_x*scale_y + i);
-					for (int j = start_of_scan.start_dct_coefficient; j <= start_of_scan.end_dct_coefficient; j++)
+					if (j == 0) // DCT DC coefficient
 					{
-						if (j == 0) // DCT DC coefficient
-						{
-							unsigned int code = JPEGHuffmanDecoder::decode(bit_reader, dc_table);
-							if (code != huffman_eob)
-								dct[0] = JPEGHuffmanDecoder::decode_number(bit_reader, code);
-							dct[0] <<= start_of_scan.point_transform;
+						unsigned int code = JPEGHuffmanDecoder::decode(bit_reader, dc_table);
+						if (code != huffman_eob)
+							dct[0] = JPEGHuffmanDecoder::decode_number(bit_reader, code);
+						dct[0] <<= start_of_scan.point_transform;
 
-							dct[0] += last_dc_values[c_sof];
-							last_dc_values[c_sof] = dct[0];
-						}
-						else // DCT AC coefficient
+						dct[0] += dc_values[c_sof];
+						dc_values[c_sof] = dct[0];
+					}
+					else // DCT AC coefficient
+					{
+						unsigned int code = JPEGHuffmanDecoder::decode(bit_reader, ac_table);
+						if (code != huffman_eob)
 						{
-							unsigned int code = JPEGHuffmanDecoder::decode(bit_reader, ac_table);
-							if (code != huffman_eob)
+							unsigned int zeros = (code >> 4);
+							j += zeros;
+							if (j <= start_of_scan.end_dct_coefficient)
 							{
-								unsigned int zeros = (code >> 4);
-								j += zeros;
-								if (j <= start_of_scan.end_dct_coefficient)
-								{
-									dct[zigzag_map[j]] = JPEGHuffmanDecoder::decode_number(bit_reader, code & 0x0f);
-									dct[zigzag_map[j]] <<= start_of_scan.point_transform;
-								}
-							}
-							else
-							{
-								break;
+								dct[zigzag_map[j]] = JPEGHuffmanDecoder::decode_number(bit_reader, code & 0x0f);
+								dct[zigzag_map[j]] <<= start_of_scan.point_transform;
 							}
 						}
+						else
+						{
+							break;
+						}
 					}
 				}
 			}
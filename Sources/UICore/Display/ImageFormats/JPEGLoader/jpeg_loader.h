@@ -30,6 +30,7 @@
 
 #include "UICore/Core/IOData/iodevice.h"
 #include "UICore/Display/Image/pixel_buffer.h"
+#include "UICore/Display/ImageFormats/image_file_info.h"
 #include "jpeg_file_reader.h"
 #include "jpeg_start_of_frame.h"
 #include "jpeg_start_of_scan.h"
@@ -37,6 +38,7 @@
 #include "jpeg_define_quantization_table.h"
 #include "jpeg_component_dcts.h"
 #include "jpeg_markers.h"
+#include <functional>
 
 namespace uicore
 {
@@ -45,7 +47,16 @@ namespace uicore
 	class JPEGLoader
 	{
 	public:
-		static std::shared_ptr<PixelBuffer> load(const std::shared_ptr<IODevice> &iodevice, bool srgb);
+		typedef std::function<void(const std::shared_ptr<PixelBuffer> &image)> ScanCallback;
+
+		/// \brief Decodes the image, optionally at 1/2, 1/4 or 1/8 size
+		///
+		/// For progressive images the scan callback is invoked with the image decoded so far after each scan.
+		/// The same pixel buffer is updated and passed for every scan, and then returned.
+		static std::shared_ptr<PixelBuffer> load(const std::shared_ptr<IODevice> &iodevice, bool srgb, int scale_denominator = 1, const ScanCallback &scan_callback = ScanCallback());
+
+		/// \brief Reads the frame header, skipping all segments before it by their length
+		static ImageFileInfo probe(const std::shared_ptr<IODevice> &iodevice, bool srgb);
 
 	private:
 		enum ColorSpace
@@ -57,13 +68,18 @@ namespace uicore
 			colorspace_grayscale
 		};
 
-		JPEGLoader(const std::shared_ptr<IODevice> &iodevice);
+		JPEGLoader(const std::shared_ptr<IODevice> &iodevice, int idct_size, const std::function<void(JPEGLoader &)> &scan_complete);
+
+		std::shared_ptr<PixelBuffer> create_image(bool srgb) const;
+		void decode_image(PixelBuffer *image);
 
 		void process_app0(JPEGFileReader &reader);
 		void process_app14(JPEGFileReader &reader);
 		void process_dnl(JPEGFileReader &reader);
 		void process_sos(JPEGFileReader &reader);
 		void process_sos_sequential(JPEGStartOfScan &start_of_scan, std::vector<int> component_to_sof, JPEGFileReader &reader);
+		void process_sos_sequential_restart_intervals(JPEGStartOfScan &start_of_scan, const std::vector<int> &component_to_sof, JPEGFileReader &reader);
+		void decode_sequential_mcu(const JPEGStartOfScan &start_of_scan, const std::vector<int> &component_to_sof, JPEGBitReader &bit_reader, int mcu_block, std::vector<short> &dc_values);
 		void process_sos_progressive(JPEGStartOfScan &start_of_scan, std::vector<int> component_to_sof, JPEGFileReader &reader);
 		void process_dqt(JPEGFileReader &reader);
 		void process_dht(JPEGFileReader &reader);
@@ -86,6 +102,7 @@ namespace uicore
 		int restart_interval;
 		int eobrun;
 		std::vector<short> last_dc_values;
+		int idct_size; // Width and height of a decoded DCT block. Less than 8 when decoding a downscaled image
 
 		bool is_jfif_jpeg;
 		bool is_adobe_jpeg;
@@ -30,6 +30,7 @@
 #include "jpeg_mcu_decoder.h"
 #include "jpeg_loader.h"
 #include "UICore/Core/System/system.h"
+#include "jpeg_decoder_avx2.h"
 
 #ifndef CL_DISABLE_SSE2
 #ifndef ARM_PLATFORM
@@ -41,13 +42,30 @@
 namespace uicore
 {
 	JPEGMCUDecoder::JPEGMCUDecoder(JPEGLoader *loader)
-		: loader(loader)
+		: loader(loader), idct_size(loader->idct_size), use_avx2(false)
 	{
+		use_avx2 = JPEGDecoderAVX2::is_available() && System::detect_cpu_extension(System::avx2);
+
 		try
 		{
 			for (size_t c = 0; c < loader->start_of_frame.components.size(); c++)
 				channels.push_back((unsigned char *)System::aligned_alloc(loader->mcu_x*loader->mcu_y * 64, 16));
 
+			/* The reduced size IDCT only uses the idct_size lowest frequencies in each direction,
+			 * evaluated at the centers of the idct_size output pixels:
+			 *   basis[x][u] = C(u) / 2 * cos((2x+1)*u*PI/(2*idct_size)),  C(0) = 1/sqrt(2), C(u) = 1
+			 * The DC coefficient gives the same output as the full IDCT, and the result
+			 * approximates the average of the pixels covered by each output pixel.
+			 */
+			for (int x = 0; x < idct_size; x++)
+			{
+				for (int u = 0; u < idct_size; u++)
+				{
+					float cu = (u == 0) ? 0.707106781f : 1.0f;
+					reduced_basis[x * 8 + u] = cu * 0.5f * std::cos((2 * x + 1) * u * 3.14159265f / (2 * idct_size));
+				}
+			}
+
 			/* For float AA&N IDCT method, divisors are equal to quantization
 			 * coefficients scaled by scalefactor[row]*scalefactor[col], where
 			 *   scalefactor[0] = 1
@@ -66,6 +84,10 @@ namespace uicore
 				for (int y = 0; y < 8; y++)
 					for (int x = 0; x < 8; x++)
 						quant[c][x + y * 8] = aanscalefactor[x] * aanscalefactor[y] * qtable.values[x + y * 8];
+
+				quant_int.push_back((int*)System::aligned_alloc(64 * sizeof(int), 16));
+				for (int i = 0; i < 64; i++)
+					quant_int[c][i] = qtable.values[i];
 			}
 		}
 		catch (...)
@@ -74,6 +96,8 @@ namespace uicore
 				System::aligned_free(elem);
 			for (auto & elem : quant)
 				System::aligned_free(elem);
+			for (auto & elem : quant_int)
+				System::aligned_free(elem);
 			throw;
 		}
 	}
@@ -84,6 +108,8 @@ namespace uicore
 			System::aligned_free(elem);
 		for (auto & elem : quant)
 			System::aligned_free(elem);
+		for (auto & elem : quant_int)
+			System::aligned_free(elem);
 	}
 
 	void JPEGMCUDecoder::decode(int block)
@@ -97,7 +123,19 @@ namespace uicore
 			{
 				for (int dct_x = 0; dct_x < scale_x; dct_x++)
 				{
-					short *dct = loader->component_dcts[c].get(block * block_size + dct_x + dct_y * scale_x);
+					const short *dct = loader->component_dcts[c].find(block * block_size + dct_x + dct_y * scale_x);
+
+					if (idct_size != 8)
+					{
+						idct_reduced(dct, channels[c] + dct_x * idct_size + dct_y * scale_x * idct_size * idct_size, scale_x * idct_size, quant_int[c]);
+						continue;
+					}
+
+					if (use_avx2)
+					{
+						JPEGDecoderAVX2::idct(dct, channels[c] + dct_x * 8 + dct_y*scale_x * 64, scale_x * 8, quant_int[c]);
+						continue;
+					}
 
 #ifdef CL_DISABLE_SSE2
 					idct(dct, channels[c]+dct_x*8+dct_y*scale_x*64, scale_x*8, quant[c]);
@@ -116,7 +154,7 @@ namespace uicore
 		}
 	}
 
-	void JPEGMCUDecoder::idct(short *inptr, unsigned char *outptr, int pitch, float *quantptr)
+	void JPEGMCUDecoder::idct(const short *inptr, unsigned char *outptr, int pitch, float *quantptr)
 	{
 		float tmp0, tmp1, tmp2, tmp3, tmp4, tmp5, tmp6, tmp7;
 		float tmp10, tmp11, tmp12, tmp13;
@@ -257,7 +295,7 @@ namespace uicore
 #ifndef CL_DISABLE_SSE2
 
 #ifndef ARM_PLATFORM
-	void JPEGMCUDecoder::idct_sse(short *inptr, unsigned char *outptr, int pitch, float *quantptr)
+	void JPEGMCUDecoder::idct_sse(const short *inptr, unsigned char *outptr, int pitch, float *quantptr)
 	{
 		__m128 tmp0, tmp1, tmp2, tmp3, tmp4, tmp5, tmp6, tmp7;
 		__m128 tmp10, tmp11, tmp12, tmp13;
@@ -439,6 +477,50 @@ namespace uicore
 #endif
 #endif // not CL_DISABLE_SSE2
 
+	void JPEGMCUDecoder::idct_reduced(const short *inptr, unsigned char *outptr, int pitch, const int *quantptr)
+	{
+		if (idct_size == 1) // DC only
+		{
+			*outptr = float_to_int(inptr[0] * quantptr[0] * (1.0f / 8.0f));
+			return;
+		}
+
+		/* Pass 1: columns, using the lowest idct_size coefficients of each */
+
+		float workspace[8 * 8];
+		for (int u = 0; u < idct_size; u++)
+		{
+			float coeffs[8];
+			for (int v = 0; v < idct_size; v++)
+				coeffs[v] = (float)(inptr[u + v * 8] * quantptr[u + v * 8]);
+
+			for (int y = 0; y < idct_size; y++)
+			{
+				const float *basis = reduced_basis + y * 8;
+				float sum = 0.0f;
+				for (int v = 0; v < idct_size; v++)
+					sum += basis[v] * coeffs[v];
+				workspace[u + y * 8] = sum;
+			}
+		}
+
+		/* Pass 2: rows */
+
+		for (int y = 0; y < idct_size; y++)
+		{
+			const float *wsptr = workspace + y * 8;
+			for (int x = 0; x < idct_size; x++)
+			{
+				const float *basis = reduced_basis + x * 8;
+				float sum = 0.0f;
+				for (int u = 0; u < idct_size; u++)
+					sum += basis[u] * wsptr[u];
+				outptr[x] = float_to_int(sum);
+			}
+			outptr += pitch;
+		}
+	}
+
 	unsigned char JPEGMCUDecoder::float_to_int(float f)
 	{
 		unsigned char i;
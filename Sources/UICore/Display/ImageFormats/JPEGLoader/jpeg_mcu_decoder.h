@@ -43,12 +43,17 @@ namespace uicore
 		const unsigned char *get_channel(int c) const { return channels[c]; }
 
 	private:
-		void idct(short *inptr, unsigned char *outptr, int pitch, float *quantptr);
-		void idct_sse(short *inptr, unsigned char *outptr, int pitch, float *quantptr);
+		void idct(const short *inptr, unsigned char *outptr, int pitch, float *quantptr);
+		void idct_sse(const short *inptr, unsigned char *outptr, int pitch, float *quantptr);
+		void idct_reduced(const short *inptr, unsigned char *outptr, int pitch, const int *quantptr);
 		static inline unsigned char float_to_int(float v);
 
 		JPEGLoader *loader;
 		std::vector<unsigned char *> channels;
 		std::vector<float *> quant;
+		std::vector<int *> quant_int;
+		int idct_size;
+		bool use_avx2;
+		float reduced_basis[8 * 8];
 	};
 }
@@ -31,6 +31,7 @@
 #include "jpeg_mcu_decoder.h"
 #include "jpeg_loader.h"
 #include "UICore/Core/System/system.h"
+#include "jpeg_decoder_avx2.h"
 
 #ifndef CL_DISABLE_SSE2
 #ifndef ARM_PLATFORM
@@ -42,10 +43,14 @@
 namespace uicore
 {
 	JPEGRGBDecoder::JPEGRGBDecoder(JPEGLoader *loader)
-		: loader(loader), mcu_x(0), mcu_y(0), pixels(nullptr)
+		: loader(loader), mcu_x(0), mcu_y(0), block_size(8), use_sse2(false), use_avx2(false), pixels(nullptr)
 	{
+		use_sse2 = System::detect_cpu_extension(System::sse2);
+		use_avx2 = JPEGDecoderAVX2::is_available() && System::detect_cpu_extension(System::avx2);
+
 		mcu_x = loader->mcu_x;
 		mcu_y = loader->mcu_y;
+		block_size = loader->idct_size;
 		try
 		{
 			pixels = (unsigned int *)System::aligned_alloc(mcu_x*mcu_y * 64 * 4, 16);
@@ -70,6 +75,9 @@ namespace uicore
 
 	void JPEGRGBDecoder::decode(JPEGMCUDecoder *mcu_decoder)
 	{
+		if (use_avx2 && loader->get_colorspace() == JPEGLoader::colorspace_ycrcb && convert_ycrcb_h2_avx2(mcu_decoder))
+			return;
+
 		upsample(mcu_decoder);
 
 		switch (loader->get_colorspace())
@@ -79,7 +87,7 @@ namespace uicore
 			break;
 		case JPEGLoader::colorspace_ycrcb:
 #ifndef CL_DISABLE_SSE2
-			if (System::detect_cpu_extension(System::sse2))
+			if (use_sse2 && get_width() % 4 == 0)
 				convert_ycrcb_sse();
 			else
 				convert_ycrcb_float();
@@ -97,10 +105,35 @@ namespace uicore
 		}
 	}
 
+	// Fused upsample and color conversion for 4:2:0 and 4:2:2 subsampled chroma
+	bool JPEGRGBDecoder::convert_ycrcb_h2_avx2(JPEGMCUDecoder *mcu_decoder)
+	{
+		const auto &components = loader->start_of_frame.components;
+		if (mcu_x != 2 || (mcu_y != 1 && mcu_y != 2) || components.size() != 3 ||
+			components[0].horz_sampling_factor != mcu_x || components[0].vert_sampling_factor != mcu_y ||
+			components[1].horz_sampling_factor != 1 || components[1].vert_sampling_factor != 1 ||
+			components[2].horz_sampling_factor != 1 || components[2].vert_sampling_factor != 1)
+			return false;
+
+		int height = mcu_y * block_size;
+		int width = mcu_x * block_size;
+		for (int y = 0; y < height; y++)
+		{
+			int chroma_y = y / mcu_y;
+			JPEGDecoderAVX2::convert_ycbcr_h2(
+				mcu_decoder->get_channel(0) + y * width,
+				mcu_decoder->get_channel(1) + chroma_y * block_size,
+				mcu_decoder->get_channel(2) + chroma_y * block_size,
+				pixels + y * width,
+				width);
+		}
+		return true;
+	}
+
 	void JPEGRGBDecoder::upsample(JPEGMCUDecoder *mcu_decoder)
 	{
-		int height = mcu_y * 8;
-		int width = mcu_x * 8;
+		int height = mcu_y * block_size;
+		int width = mcu_x * block_size;
 
 		for (size_t c = 0; c < channels.size(); c++)
 		{
@@ -120,7 +153,7 @@ namespace uicore
 				int sy = step_sy >> 1;
 				for (int y = 0; y < height; y++)
 				{
-					const unsigned char *input_line = input + (sy >> 16)*v * 8;
+					const unsigned char *input_line = input + (sy >> 16)*h * block_size;
 					int sx = step_sx >> 1;
 					for (int x = 0; x < width; x++)
 					{
@@ -135,8 +168,8 @@ namespace uicore
 
 	void JPEGRGBDecoder::convert_monochrome()
 	{
-		int height = mcu_y * 8;
-		int width = mcu_x * 8;
+		int height = mcu_y * block_size;
+		int width = mcu_x * block_size;
 
 		for (int y = 0; y < height; y++)
 		{
@@ -164,8 +197,8 @@ namespace uicore
 #ifndef ARM_PLATFORM
 	void JPEGRGBDecoder::convert_ycrcb_sse()
 	{
-		int height = mcu_y * 8;
-		int width = mcu_x * 8;
+		int height = mcu_y * block_size;
+		int width = mcu_x * block_size;
 		for (int y = 0; y < height; y++)
 		{
 			unsigned char *c_line[3] =
@@ -211,8 +244,8 @@ namespace uicore
 
 	void JPEGRGBDecoder::convert_ycrcb_float()
 	{
-		int height = mcu_y * 8;
-		int width = mcu_x * 8;
+		int height = mcu_y * block_size;
+		int width = mcu_x * block_size;
 		for (int y = 0; y < height; y++)
 		{
 			for (int x = 0; x < width; x++)
@@ -245,8 +278,8 @@ namespace uicore
 
 	void JPEGRGBDecoder::convert_rgb()
 	{
-		int height = mcu_y * 8;
-		int width = mcu_x * 8;
+		int height = mcu_y * block_size;
+		int width = mcu_x * block_size;
 		for (int y = 0; y < height; y++)
 		{
 			for (int x = 0; x < width; x++)
@@ -41,11 +41,12 @@ namespace uicore
 
 		void decode(JPEGMCUDecoder *mcu_decoder);
 
-		int get_width() const { return mcu_x * 8; }
-		int get_height() const { return mcu_y * 8; }
+		int get_width() const { return mcu_x * block_size; }
+		int get_height() const { return mcu_y * block_size; }
 		const unsigned int *get_pixels() const { return pixels; }
 
 	private:
+		bool convert_ycrcb_h2_avx2(JPEGMCUDecoder *mcu_decoder);
 		void upsample(JPEGMCUDecoder *mcu_decoder);
 		void convert_monochrome();
 		void convert_ycrcb_sse();
@@ -54,6 +55,9 @@ namespace uicore
 
 		JPEGLoader *loader;
 		int mcu_x, mcu_y;
+		int block_size;
+		bool use_sse2;
+		bool use_avx2;
 		unsigned int *pixels;
 		std::vector<unsigned char *> channels;
 	};
@@ -10,9 +10,13 @@
 
 #include "UICore/precomp.h"
 #include "jpge.h"
+#include "UICore/Core/System/thread_pool.h"
 
 #include <stdlib.h>
 #include <string.h>
+#include <memory>
+#include <mutex>
+#include <vector>
 #if !defined(__APPLE__)
 #include <malloc.h>
 #endif
@@ -26,7 +30,7 @@ namespace uicore_jpge {
 	static inline void jpge_free(void *p) { free(p); }
 
 	// Various JPEG enums and tables.
-	enum { M_SOF0 = 0xC0, M_DHT = 0xC4, M_SOI = 0xD8, M_EOI = 0xD9, M_SOS = 0xDA, M_DQT = 0xDB, M_APP0 = 0xE0 };
+	enum { M_SOF0 = 0xC0, M_DHT = 0xC4, M_SOI = 0xD8, M_EOI = 0xD9, M_SOS = 0xDA, M_DQT = 0xDB, M_DRI = 0xDD, M_RST0 = 0xD0, M_APP0 = 0xE0 };
 	enum { DC_LUM_CODES = 12, AC_LUM_CODES = 256, DC_CHROMA_CODES = 12, AC_CHROMA_CODES = 256, MAX_HUFF_SYMBOLS = 257, MAX_HUFF_CODESIZE = 32 };
 
 	static uint8 s_zag[64] = { 0, 1, 8, 16, 9, 2, 3, 10, 17, 24, 32, 25, 18, 11, 4, 5, 12, 19, 26, 33, 40, 48, 41, 34, 27, 20, 13, 6, 7, 14, 21, 28, 35, 42, 49, 56, 57, 50, 43, 36, 29, 22, 15, 23, 30, 37, 44, 51, 58, 59, 52, 45, 38, 31, 39, 46, 53, 60, 61, 54, 47, 55, 62, 63 };
@@ -338,6 +342,14 @@ namespace uicore_jpge {
 		}
 	}
 
+	// Emit restart interval
+	void jpeg_encoder::emit_dri()
+	{
+		emit_marker(M_DRI);
+		emit_word(4);
+		emit_word(m_restart_interval);
+	}
+
 	// emit start of scan
 	void jpeg_encoder::emit_sos()
 	{
@@ -365,6 +377,8 @@ namespace uicore_jpge {
 		emit_dqt();
 		emit_sof();
 		emit_dhts();
+		if (m_restart_interval)
+			emit_dri();
 		emit_sos();
 	}
 
@@ -441,7 +455,32 @@ namespace uicore_jpge {
 		return true;
 	}
 
+	void jpeg_encoder::load_std_huffman_tables()
+	{
+		memcpy(m_huff_bits[0 + 0], s_dc_lum_bits, 17);    memcpy(m_huff_val[0 + 0], s_dc_lum_val, DC_LUM_CODES);
+		memcpy(m_huff_bits[2 + 0], s_ac_lum_bits, 17);    memcpy(m_huff_val[2 + 0], s_ac_lum_val, AC_LUM_CODES);
+		memcpy(m_huff_bits[0 + 1], s_dc_chroma_bits, 17); memcpy(m_huff_val[0 + 1], s_dc_chroma_val, DC_CHROMA_CODES);
+		memcpy(m_huff_bits[2 + 1], s_ac_chroma_bits, 17); memcpy(m_huff_val[2 + 1], s_ac_chroma_val, AC_CHROMA_CODES);
+	}
+
 	bool jpeg_encoder::jpg_open(int p_x_res, int p_y_res, int src_channels)
+	{
+		if (!jpg_setup(p_x_res, p_y_res, src_channels)) return false;
+
+		if (m_params.m_two_pass_flag)
+		{
+			clear_obj(m_huff_count);
+			first_pass_init();
+		}
+		else
+		{
+			load_std_huffman_tables();
+			if (!second_pass_init()) return false;   // in effect, skip over the first pass
+		}
+		return m_all_stream_writes_succeeded;
+	}
+
+	bool jpeg_encoder::jpg_setup(int p_x_res, int p_y_res, int src_channels)
 	{
 		m_num_components = 3;
 		switch (m_params.m_subsampling)
@@ -496,21 +535,7 @@ namespace uicore_jpge {
 
 		m_out_buf_left = JPGE_OUT_BUF_SIZE;
 		m_pOut_buf = m_out_buf;
-
-		if (m_params.m_two_pass_flag)
-		{
-			clear_obj(m_huff_count);
-			first_pass_init();
-		}
-		else
-		{
-			memcpy(m_huff_bits[0 + 0], s_dc_lum_bits, 17);    memcpy(m_huff_val[0 + 0], s_dc_lum_val, DC_LUM_CODES);
-			memcpy(m_huff_bits[2 + 0], s_ac_lum_bits, 17);    memcpy(m_huff_val[2 + 0], s_ac_lum_val, AC_LUM_CODES);
-			memcpy(m_huff_bits[0 + 1], s_dc_chroma_bits, 17); memcpy(m_huff_val[0 + 1], s_dc_chroma_val, DC_CHROMA_CODES);
-			memcpy(m_huff_bits[2 + 1], s_ac_chroma_bits, 17); memcpy(m_huff_val[2 + 1], s_ac_chroma_val, AC_CHROMA_CODES);
-			if (!second_pass_init()) return false;   // in effect, skip over the first pass
-		}
-		return m_all_stream_writes_succeeded;
+		return true;
 	}
 
 	void jpeg_encoder::load_block_8_8_grey(int x)
@@ -856,6 +881,7 @@ namespace uicore_jpge {
 		m_mcu_lines[0] = nullptr;
 		m_pass_num = 0;
 		m_all_stream_writes_succeeded = true;
+		m_restart_interval = 0;
 	}
 
 	jpeg_encoder::jpeg_encoder()
@@ -900,6 +926,140 @@ namespace uicore_jpge {
 		return m_all_stream_writes_succeeded;
 	}
 
+	class vector_stream : public output_stream
+	{
+		vector_stream(const vector_stream &);
+		vector_stream &operator= (const vector_stream &);
+
+		std::vector<uint8> &m_buf;
+
+	public:
+		vector_stream(std::vector<uint8> &buf) : m_buf(buf) { }
+
+		virtual bool put_buf(const void* pBuf, int len) override
+		{
+			const uint8 *pBytes = static_cast<const uint8*>(pBuf);
+			m_buf.insert(m_buf.end(), pBytes, pBytes + len);
+			return true;
+		}
+	};
+
+	// Prepares this encoder to code one restart interval using the tables and pass of the master encoder.
+	bool jpeg_encoder::init_segment(const jpeg_encoder &master, output_stream *pStream)
+	{
+		deinit();
+		m_pStream = pStream;
+		m_params = master.m_params;
+		if (!jpg_setup(master.m_image_x, master.m_image_y, master.m_image_bpp)) return false;
+
+		memcpy(m_huff_codes, master.m_huff_codes, sizeof(m_huff_codes));
+		memcpy(m_huff_code_sizes, master.m_huff_code_sizes, sizeof(m_huff_code_sizes));
+		clear_obj(m_huff_count);
+		first_pass_init();
+		m_pass_num = master.m_pass_num;
+		return true;
+	}
+
+	// Codes the MCU rows of one restart interval. DC prediction starts from zero, as required after a restart marker.
+	bool jpeg_encoder::encode_segment(const uint8 *pImage_data, int pitch, int first_mcu_row, int num_mcu_rows)
+	{
+		int y_start = first_mcu_row * m_mcu_y;
+		int y_end = JPGE_MIN((first_mcu_row + num_mcu_rows) * m_mcu_y, m_image_y);
+		for (int y = y_start; y < y_end; y++)
+			load_mcu(pImage_data + (size_t)y * pitch);
+
+		if (m_mcu_y_ofs)
+		{
+			for (int i = m_mcu_y_ofs; i < m_mcu_y; i++)
+				memcpy(m_mcu_lines[i], m_mcu_lines[m_mcu_y_ofs - 1], m_image_bpl_mcu);
+			process_mcu_row();
+			m_mcu_y_ofs = 0;
+		}
+
+		if (m_pass_num == 2)
+		{
+			put_bits(0x7F, 7);
+			flush_output_buffer();
+		}
+		return m_all_stream_writes_succeeded;
+	}
+
+	bool jpeg_encoder::compress_image_parallel(output_stream *pStream, int width, int height, int src_channels, const uint8 *pImage_data, int pitch, const params &comp_params)
+	{
+		deinit();
+		if (((!pStream) || (width < 1) || (height < 1)) || ((src_channels != 1) && (src_channels != 3) && (src_channels != 4)) || (!comp_params.check()) || (comp_params.m_restart_rows < 1)) return false;
+		m_pStream = pStream;
+		m_params = comp_params;
+		if (!jpg_setup(width, height, src_channels)) return false;
+
+		// The restart interval is a 16 bit MCU count
+		int rows_per_segment = JPGE_MIN(m_params.m_restart_rows, JPGE_MAX(65535 / m_mcus_per_row, 1));
+		m_restart_interval = rows_per_segment * m_mcus_per_row;
+
+		int mcu_rows = m_image_y_mcu / m_mcu_y;
+		int num_segments = (mcu_rows + rows_per_segment - 1) / rows_per_segment;
+
+		std::vector<std::vector<uint8>> segment_data(num_segments);
+		std::vector<char> segment_succeeded(num_segments);
+		std::mutex count_mutex;
+
+		auto encode_segments = [&]()
+		{
+			uicore::ThreadPool::shared().parallel_for(num_segments, 1, [&](int begin, int end)
+			{
+				std::unique_ptr<jpeg_encoder> segment(new jpeg_encoder());
+				for (int i = begin; i < end; i++)
+				{
+					vector_stream stream(segment_data[i]);
+					segment_succeeded[i] = segment->init_segment(*this, &stream) && segment->encode_segment(pImage_data, pitch, i * rows_per_segment, rows_per_segment);
+
+					if (m_pass_num == 1)
+					{
+						std::unique_lock<std::mutex> lock(count_mutex);
+						for (int t = 0; t < 4; t++)
+						{
+							for (int c = 0; c < 256; c++)
+								m_huff_count[t][c] += segment->m_huff_count[t][c];
+						}
+					}
+				}
+			});
+
+			for (char succeeded : segment_succeeded)
+			{
+				if (!succeeded)
+					return false;
+			}
+			return true;
+		};
+
+		if (m_params.m_two_pass_flag)
+		{
+			clear_obj(m_huff_count);
+			first_pass_init();
+			if (!encode_segments() || !terminate_pass_one()) return false;
+		}
+		else
+		{
+			load_std_huffman_tables();
+			if (!second_pass_init()) return false;
+		}
+
+		if (!encode_segments()) return false;
+
+		for (int i = 0; i < num_segments; i++)
+		{
+			if (!segment_data[i].empty())
+				m_all_stream_writes_succeeded = m_all_stream_writes_succeeded && m_pStream->put_buf(segment_data[i].data(), (int)segment_data[i].size());
+			if (i + 1 < num_segments)
+				emit_marker(M_RST0 + (i & 7));
+		}
+		emit_marker(M_EOI);
+		m_pass_num++;
+
+		return m_all_stream_writes_succeeded;
+	}
+
 	// Higher level wrappers/examples (optional).
 #include <stdio.h>
 
@@ -1009,6 +1169,31 @@ namespace uicore_jpge {
 		}
 	};
 
+	bool compress_image_to_jpeg_stream(output_stream &dst_stream, int width, int height, int num_channels, const uint8 *pImage_data, int pitch, const params &comp_params)
+	{
+		jpeg_encoder dst_image;
+		if (comp_params.m_restart_rows > 0)
+			return dst_image.compress_image_parallel(&dst_stream, width, height, num_channels, pImage_data, pitch, comp_params);
+
+		if (!dst_image.init(&dst_stream, width, height, num_channels, comp_params))
+			return false;
+
+		for (uint pass_index = 0; pass_index < dst_image.get_total_passes(); pass_index++)
+		{
+			for (int i = 0; i < height; i++)
+			{
+				const uint8* pScanline = pImage_data + (size_t)i * pitch;
+				if (!dst_image.process_scanline(pScanline))
+					return false;
+			}
+			if (!dst_image.process_scanline(nullptr))
+				return false;
+		}
+
+		dst_image.deinit();
+		return true;
+	}
+
 	bool compress_image_to_jpeg_file_in_memory(void *pDstBuf, int &buf_size, int width, int height, int num_channels, const uint8 *pImage_data, const params &comp_params)
 	{
 		if ((!pDstBuf) || (!buf_size))
@@ -19,12 +19,13 @@ namespace uicore_jpge
 	// JPEG compression parameters structure.
 	struct params
 	{
-		inline params() : m_quality(85), m_subsampling(H2V2), m_no_chroma_discrim_flag(false), m_two_pass_flag(false) { }
+		inline params() : m_quality(85), m_subsampling(H2V2), m_no_chroma_discrim_flag(false), m_two_pass_flag(false), m_restart_rows(0) { }
 
 		inline bool check() const
 		{
 			if ((m_quality < 1) || (m_quality > 100)) return false;
 			if ((uint)m_subsampling > (uint)H2V2) return false;
+			if (m_restart_rows < 0) return false;
 			return true;
 		}
 
@@ -42,7 +43,12 @@ namespace uicore_jpge
 		// If true, the Y quantization table is also used for the CbCr channels.
 		bool m_no_chroma_discrim_flag;
 
+		// Gathers symbol statistics in a first pass and writes optimized Huffman tables.
 		bool m_two_pass_flag;
+
+		// Number of MCU rows per restart interval. 0 disables restart markers.
+		// When set, compress_image_to_jpeg_stream() encodes the restart intervals in parallel.
+		int m_restart_rows;
 	};
 
 	// Writes JPEG image to a file. 
@@ -54,6 +60,12 @@ namespace uicore_jpge
 	// If return value is true, buf_size will be set to the size of the compressed data.
 	bool compress_image_to_jpeg_file_in_memory(void *pBuf, int &buf_size, int width, int height, int num_channels, const uint8 *pImage_data, const params &comp_params = params());
 
+	class output_stream;
+
+	// Writes JPEG image to an output stream.
+	// pitch is the number of bytes between the start of each source scanline.
+	bool compress_image_to_jpeg_stream(output_stream &dst_stream, int width, int height, int num_channels, const uint8 *pImage_data, int pitch, const params &comp_params = params());
+
 	// Output stream abstract class - used by the jpeg_encoder class to write to the output stream. 
 	// put_buf() is generally called with len==JPGE_OUT_BUF_SIZE bytes, but for headers it'll be called with smaller amounts.
 	class output_stream
@@ -93,6 +105,10 @@ namespace uicore_jpge
 		// Returns false on out of memory or if a stream write fails.
 		bool process_scanline(const void* pScanline);
 
+		// Compresses a whole image with restart markers every m_restart_rows MCU rows, encoding the intervals in parallel.
+		// If m_two_pass_flag is set, the symbol statistics pass also runs in parallel.
+		bool compress_image_parallel(output_stream *pStream, int width, int height, int src_channels, const uint8 *pImage_data, int pitch, const params &comp_params);
+
 	private:
 		jpeg_encoder(const jpeg_encoder &);
 		jpeg_encoder &operator =(const jpeg_encoder &);
@@ -127,6 +143,7 @@ namespace uicore_jpge
 		uint m_bits_in;
 		uint8 m_pass_num;
 		bool m_all_stream_writes_succeeded;
+		uint m_restart_interval;
 
 		void optimize_huffman_table(int table_num, int table_len);
 		void emit_byte(uint8 i);
@@ -137,6 +154,7 @@ namespace uicore_jpge
 		void emit_sof();
 		void emit_dht(uint8 *bits, uint8 *val, int index, bool ac_flag);
 		void emit_dhts();
+		void emit_dri();
 		void emit_sos();
 		void emit_markers();
 		void compute_huffman_table(uint *codes, uint8 *code_sizes, uint8 *bits, uint8 *val);
@@ -145,6 +163,10 @@ namespace uicore_jpge
 		void first_pass_init();
 		bool second_pass_init();
 		bool jpg_open(int p_x_res, int p_y_res, int src_channels);
+		bool jpg_setup(int p_x_res, int p_y_res, int src_channels);
+		void load_std_huffman_tables();
+		bool init_segment(const jpeg_encoder &master, output_stream *pStream);
+		bool encode_segment(const uint8 *pImage_data, int pitch, int first_mcu_row, int num_mcu_rows);
 		void load_block_8_8_grey(int x);
 		void load_block_8_8(int x, int y, int c);
 		void load_block_16_8(int x, int c);
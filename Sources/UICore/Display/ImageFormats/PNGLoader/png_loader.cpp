@@ -28,39 +28,117 @@
 
 #include "UICore/precomp.h"
 #include "png_loader.h"
-#include "UICore/Core/Zip/zlib_compression.h"
 #include "UICore/Core/System/system.h"
 #include "UICore/Display/ImageFormats/PNGWriter/png_writer.h"
 
+#if !defined __ANDROID__ && ! defined CL_DISABLE_SSE2
+#include "png_predictor_sse.h"
+#endif
+
 namespace uicore
 {
+	namespace
+	{
+		// Adam7 passes. Images without interlacing are decoded as a single pass
+		const int starting_row[7] = { 0, 0, 4, 0, 2, 0, 1 };
+		const int starting_col[7] = { 0, 4, 0, 2, 0, 1, 0 };
+		const int row_increment[7] = { 8, 8, 8, 4, 4, 2, 2 };
+		const int col_increment[7] = { 8, 8, 4, 4, 2, 2, 1 };
+		const int no_interlace_increment[1] = { 1 };
+	}
+
 	std::shared_ptr<PixelBuffer> PNGLoader::load(const std::shared_ptr<IODevice> &iodevice, bool srgb)
 	{
-		PNGLoader loader(iodevice, srgb);
+		PNGLoader loader(iodevice, srgb, ScanlineCallback());
 		return loader.image;
 	}
 
-	PNGLoader::PNGLoader(const std::shared_ptr<IODevice> &iodevice, bool force_srgb)
-		: file(iodevice), force_srgb(force_srgb), scanline(nullptr), prev_scanline(nullptr), scanline_4ub(nullptr), scanline_4us(nullptr), palette(nullptr)
+	void PNGLoader::load(const std::shared_ptr<IODevice> &iodevice, bool srgb, const ScanlineCallback &callback)
+	{
+		PNGLoader loader(iodevice, srgb, callback);
+	}
+
+	PNGLoader::PNGLoader(const std::shared_ptr<IODevice> &iodevice, bool force_srgb, const ScanlineCallback &callback)
+		: file(iodevice), force_srgb(force_srgb), scanline_callback(callback), scanline(nullptr), prev_scanline(nullptr), scanline_4ub(nullptr), scanline_4us(nullptr), palette(nullptr)
 	{
-		read_magic();
+#if !defined __ANDROID__ && ! defined CL_DISABLE_SSE2
+		use_sse2 = System::detect_cpu_extension(System::sse2);
+		use_ssse3 = System::detect_cpu_extension(System::ssse3);
+#endif
+		read_magic(file.get());
 		read_chunks();
-		decode_header();
-		decode_palette();
-		decode_colorkey();
-		decode_image();
 	}
 
 	PNGLoader::~PNGLoader()
 	{
-		System::aligned_free(scanline);
-		System::aligned_free(prev_scanline);
+		if (scanline)
+			System::aligned_free(scanline - scanline_padding);
+		if (prev_scanline)
+			System::aligned_free(prev_scanline - scanline_padding);
 		System::aligned_free(scanline_4ub);
 		System::aligned_free(scanline_4us);
 		System::aligned_free(palette);
 	}
 
-	void PNGLoader::read_magic()
+	ImageFileInfo PNGLoader::probe(const std::shared_ptr<IODevice> &file, bool srgb)
+	{
+		read_magic(file.get());
+		file->set_big_endian_mode();
+
+		// IHDR must be the first chunk
+		char name[5];
+		name[4] = 0;
+		unsigned int length = file->read_uint32();
+		file->read(name, 4);
+		if (length != 13 || name != std::string("IHDR"))
+			throw Exception("Invalid PNG image file");
+
+		unsigned char ihdr[13];
+		file->read(ihdr, 13);
+		unsigned int crc32 = file->read_uint32();
+		if (crc32 != PNGCRC32::crc(name, ihdr, 13))
+			throw Exception("CRC32 error");
+
+		int image_width = from_network_order(*reinterpret_cast<unsigned int*>(ihdr));
+		int image_height = from_network_order(*reinterpret_cast<unsigned int*>(ihdr + 4));
+		int bit_depth = ihdr[8];
+		if (bit_depth != 1 && bit_depth != 2 && bit_depth != 4 && bit_depth != 8 && bit_depth != 16)
+			throw Exception("Invalid PNG image file");
+		if (image_width >= (1 << 23) || image_height >= (1 << 23))
+			throw Exception("PNG image is too big");
+
+		ImageFileInfo info(image_width, image_height, bit_depth <= 8 ? (srgb ? tf_srgb8_alpha8 : tf_rgba8) : tf_rgba16);
+
+		// pHYs must precede the image data. Other chunks are skipped without reading them
+		while (true)
+		{
+			length = file->read_uint32();
+			file->read(name, 4);
+			if (length >= (1u << 31))
+				throw Exception("PNG image file too big!");
+
+			if (name == std::string("IDAT") || name == std::string("IEND"))
+				break;
+
+			if (name == std::string("pHYs") && length == 9)
+			{
+				unsigned char phys[9];
+				file->read(phys, 9);
+				crc32 = file->read_uint32();
+				if (crc32 != PNGCRC32::crc(name, phys, 9))
+					throw Exception("CRC32 error");
+
+				info.pixel_ratio = decode_pixel_ratio(phys);
+				break;
+			}
+
+			file->seek_from_current((long long)length + 4);
+		}
+
+		return info;
+	}
+
+	void PNGLoader::read_magic(IODevice *file)
 	{
 		unsigned char png_magic[8] = { 0x89, 0x50, 0x4E, 0x47, 0x0D, 0x0A, 0x1A, 0x0A };
 		unsigned char file_magic[8];
@@ -75,9 +153,6 @@ namespace uicore
 
 		std::map<std::string, std::shared_ptr<DataBuffer>> chunks;
 
-		std::vector<std::shared_ptr<DataBuffer>> idat_chunks;
-		uint64_t total_idat_size = 0;
-
 		while (true)
 		{
 			unsigned int length = file->read_uint32();
@@ -85,51 +160,72 @@ namespace uicore
 			name[4] = 0;
 			file->read(name, 4);
 
-			auto data = DataBuffer::create(length);
-			file->read(data->data(), data->size());
+			if (length >= (1u << 31))
+				throw Exception("PNG image file too big!");
 
-			unsigned int crc32 = file->read_uint32();
+			if (name == std::string("IDAT")) // Decode the image data while reading it, instead of concatenating all IDAT chunks first
+			{
+				// Memory backed devices let the chunk be used in place
+				const unsigned char *idat_data = static_cast<const unsigned char*>(file->try_read_in_place(length));
+				if (!idat_data)
+				{
+					idat_chunk.resize(length);
+					if (length > 0)
+						file->read(idat_chunk.data(), length);
+					idat_data = idat_chunk.data();
+				}
 
-			unsigned int compare_crc32 = PNGCRC32::crc(name, data->data(), data->size());
-			if (crc32 != compare_crc32)
-				throw Exception("CRC32 error");
+				unsigned int crc32 = file->read_uint32();
+				unsigned int compare_crc32 = PNGCRC32::crc(name, idat_data, length);
+				if (crc32 != compare_crc32)
+					throw Exception("CRC32 error");
 
-			if (name == std::string("IDAT")) // Concatenate all IDAT chunks to one big
-			{
-				total_idat_size += length;
-				idat_chunks.push_back(data);
+				if (!idat_inflater)
+				{
+					// The chunks describing the image data must precede the first IDAT chunk
+					ihdr = chunks["IHDR"];
+					plte = chunks["PLTE"];
+
+					trns = chunks["tRNS"];
+					chrm = chunks["cHRM"];
+					gama = chunks["gAMA"];
+					iccp = chunks["iCCP"];
+					sbit = chunks["sBIT"];
+					srgb = chunks["sRGB"];
+					phys = chunks["pHYs"];
+
+					if (!ihdr || ihdr->size() != 13) // Always required chunks
+						throw Exception("Invalid PNG image file");
+
+					decode_header();
+					decode_palette();
+					decode_colorkey();
+					begin_image();
+				}
+
+				decode_image_data(idat_data, length);
 			}
 			else
 			{
+				auto data = DataBuffer::create(length);
+				file->read(data->data(), data->size());
+
+				unsigned int crc32 = file->read_uint32();
+
+				unsigned int compare_crc32 = PNGCRC32::crc(name, data->data(), data->size());
+				if (crc32 != compare_crc32)
+					throw Exception("CRC32 error");
+
 				chunks[name] = data;
 				if (name == std::string("IEND")) // image trailer, which is the last chunk in a PNG datastream.
 					break;
 			}
 		}
 
-		if (total_idat_size >= (1 << 31))
-			throw Exception("PNG image file too big!");
-
-		idat = DataBuffer::create((int)total_idat_size);
-		int idat_pos = 0;
-		for (auto & idat_chunk : idat_chunks)
-		{
-			memcpy(idat->data() + idat_pos, idat_chunk->data(), idat_chunk->size());
-			idat_pos += idat_chunk->size();
-		}
-
-		ihdr = chunks["IHDR"];
-		plte = chunks["PLTE"];
-
-		trns = chunks["tRNS"];
-		chrm = chunks["cHRM"];
-		gama = chunks["gAMA"];
-		iccp = chunks["iCCP"];
-		sbit = chunks["sBIT"];
-		srgb = chunks["sRGB"];
-
-		if (!ihdr || idat_chunks.empty() || ihdr->size() != 13) // Always required chunks
+		if (!idat_inflater) // Always required chunks
 			throw Exception("Invalid PNG image file");
+
+		end_image();
 	}
 
 	void PNGLoader::decode_header()
@@ -216,25 +312,124 @@ namespace uicore
 		}
 	}
 
-	void PNGLoader::decode_image()
+	void PNGLoader::begin_image()
 	{
-		std::shared_ptr<DataBuffer> image_data = ZLibCompression::decompress(idat, false);
+		if (!scanline_callback || interlace_method == 1)
+			create_image();
+		if (scanline_callback)
+			callback_scanline = PixelBuffer::create(image_width, 1, bit_depth <= 8 ? (force_srgb ? tf_srgb8_alpha8 : tf_rgba8) : tf_rgba16);
 
-		create_image();
 		create_scanline_buffers();
 
-		if (interlace_method == 0)
+		idat_inflater = ZLibDecompressor::create(false);
+		pass = 0;
+		row_y = interlace_method == 1 ? starting_row[0] : 0;
+		image_complete = !begin_row();
+	}
+
+	bool PNGLoader::begin_row()
+	{
+		int num_passes = interlace_method == 1 ? 7 : 1;
+		while (pass < num_passes)
 		{
-			decode_interlace_none(reinterpret_cast<const unsigned char*>(image_data->data()), image_data->size());
+			int start_col = interlace_method == 1 ? starting_col[pass] : 0;
+			if (row_y < (int)image_height && start_col < (int)image_width)
+			{
+				int col_inc = interlace_method == 1 ? col_increment[pass] : no_interlace_increment[0];
+				row_pixel_length = (image_width - start_col + col_inc - 1) / col_inc;
+				row_byte_length = (row_pixel_length * bit_depth * get_image_data_channels() + 7) / 8;
+				row_pos = 0;
+
+				unsigned char *tmp = scanline;
+				scanline = prev_scanline;
+				prev_scanline = tmp;
+				return true;
+			}
+
+			// Next pass starts with an empty previous scanline
+			pass++;
+			if (pass < num_passes)
+			{
+				row_y = starting_row[pass];
+				memset(scanline, 0, (image_width * bit_depth * get_image_data_channels() + 7) / 8);
+			}
 		}
-		else if (interlace_method == 1)
+		return false;
+	}
+
+	void PNGLoader::decode_image_data(const unsigned char *data, int data_length)
+	{
+		idat_inflater->set_input(data, data_length);
+		while (!image_complete)
 		{
-			decode_interlace_adam7(reinterpret_cast<const unsigned char*>(image_data->data()), image_data->size());
+			// Decompress the predictor type byte and scanline directly into the scanline buffer
+			unsigned char *row_data = scanline - 1;
+			int bytes = idat_inflater->decompress(row_data + row_pos, row_byte_length + 1 - row_pos);
+			row_pos += bytes;
+
+			if (row_pos == row_byte_length + 1)
+			{
+				decode_row();
+				row_y += interlace_method == 1 ? row_increment[pass] : no_interlace_increment[0];
+				image_complete = !begin_row();
+			}
+			else if (bytes == 0)
+			{
+				break;
+			}
 		}
+	}
+
+	void PNGLoader::decode_row()
+	{
+		filter_scanline(scanline[-1], row_byte_length);
+
+		if (bit_depth <= 8)
+			convert_scanline_4ub(row_pixel_length);
 		else
+			convert_scanline_4us(row_pixel_length);
+
+		if (interlace_method == 0)
 		{
+			unsigned char *output_line = scanline_callback ? callback_scanline->data_uint8() : image->line_uint8(row_y);
+			if (bit_depth <= 8)
+				memcpy(output_line, scanline_4ub, image_width * 4);
+			else
+				memcpy(output_line, scanline_4us, image_width * 8);
+
+			if (scanline_callback)
+				scanline_callback(Size(image_width, image_height), row_y, callback_scanline);
+		}
+		else
+		{
+			unsigned char *output_line = image->line_uint8(row_y);
+			int scanline_pos = 0;
+			for (int x = starting_col[pass]; x < (int)image_width; x += col_increment[pass])
+			{
+				if (bit_depth <= 8)
+					*reinterpret_cast<Vec4ub*>(output_line + x * 4) = scanline_4ub[scanline_pos++];
+				else
+					*reinterpret_cast<Vec4us*>(output_line + x * 8) = scanline_4us[scanline_pos++];
+			}
+		}
+	}
+
+	void PNGLoader::end_image()
+	{
+		if (!image_complete)
 			throw Exception("Invalid PNG image file");
+
+		// Interlaced images are only complete after the last pass
+		if (scanline_callback && interlace_method == 1)
+		{
+			for (int y = 0; y < (int)image_height; y++)
+			{
+				memcpy(callback_scanline->data(), image->line(y), callback_scanline->pitch());
+				scanline_callback(Size(image_width, image_height), y, callback_scanline);
+			}
 		}
+
+		idat_inflater.reset();
 	}
 
 	void PNGLoader::create_image()
@@ -243,13 +438,25 @@ namespace uicore
 			image = PixelBuffer::create(image_width, image_height, force_srgb ? tf_srgb8_alpha8 : tf_rgba8);
 		else
 			image = PixelBuffer::create(image_width, image_height, tf_rgba16);
+
+		if (phys && phys->size() == 9)
+			image->set_pixel_ratio(decode_pixel_ratio(phys->data<unsigned char>()));
+	}
+
+	float PNGLoader::decode_pixel_ratio(const unsigned char *phys)
+	{
+		// Same pixels per meter for a pixel ratio of one as used by PNGWriter
+		unsigned int ppm_x = from_network_order(*reinterpret_cast<const unsigned int*>(phys));
+		return phys[8] == 1 ? ppm_x / 3800.0f : 0.0f;
 	}
 
 	void PNGLoader::create_scanline_buffers()
 	{
 		int size = (image_width * bit_depth * get_image_data_channels() + 7) / 8;
-		scanline = static_cast<unsigned char *>(System::aligned_alloc(size));
-		prev_scanline = static_cast<unsigned char *>(System::aligned_alloc(size));
+		scanline = static_cast<unsigned char *>(System::aligned_alloc(size + scanline_padding)) + scanline_padding;
+		prev_scanline = static_cast<unsigned char *>(System::aligned_alloc(size + scanline_padding)) + scanline_padding;
+		memset(scanline, 0, size);
+		memset(prev_scanline, 0, size);
 		scanline_4ub = static_cast<Vec4ub *>(System::aligned_alloc(image_width * sizeof(Vec4ub)));
 		scanline_4us = static_cast<Vec4us *>(System::aligned_alloc(image_width * sizeof(Vec4us)));
 	}
@@ -267,161 +474,106 @@ namespace uicore
 		}
 	}
 
-	void PNGLoader::decode_interlace_none(const unsigned char *data, int data_length)
+	void PNGLoader::filter_scanline(int predictor_type, int scanline_byte_length)
 	{
-		int scanline_size = (image_width * bit_depth * get_image_data_channels() + 7) / 8;
-		if ((1 + scanline_size) * image_height > data_length)
+		int channels = get_image_data_channels();
+		if (predictor_type < 0 || predictor_type > 4)
 			throw Exception("Invalid PNG image file");
+		if (predictor_type == 0) // none
+			return;
 
-		for (size_t i = 0; i < scanline_size; i++)
-			scanline[i] = 0;
+#if !defined __ANDROID__ && ! defined CL_DISABLE_SSE2
+		if (use_sse2 && filter_scanline_sse2(predictor_type, scanline_byte_length, channels * ((bit_depth + 7) / 8)))
+			return;
+#endif
 
-		int data_pos = 0;
-		for (int y = 0; y < image_height; y++)
+		switch (predictor_type)
 		{
-			unsigned char *tmp = scanline;
-			scanline = prev_scanline;
-			prev_scanline = tmp;
-
-			int predictor_type = data[data_pos++];
-			memcpy(scanline, data + data_pos, scanline_size);
-			data_pos += scanline_size;
-
-			filter_scanline(predictor_type, scanline_size);
-
-			if (bit_depth <= 8)
-				convert_scanline_4ub(image_width);
-			else
-				convert_scanline_4us(image_width);
-
-			unsigned char *output_line = image->line_uint8(y);
-			if (bit_depth <= 8)
-				memcpy(output_line, scanline_4ub, image_width * 4);
-			else
-				memcpy(output_line, scanline_4us, image_width * 8);
+		case 1: predictor_sub(scanline, prev_scanline, scanline_byte_length, channels, bit_depth); break;
+		case 2: predictor_up(scanline, prev_scanline, scanline_byte_length, channels, bit_depth); break;
+		case 3: predictor_average(scanline, prev_scanline, scanline_byte_length, channels, bit_depth); break;
+		case 4: predictor_paeth(scanline, prev_scanline, scanline_byte_length, channels, bit_depth); break;
 		}
 	}
 
-	void PNGLoader::decode_interlace_adam7(const unsigned char *data, int data_length)
+#if !defined __ANDROID__ && ! defined CL_DISABLE_SSE2
+	bool PNGLoader::filter_scanline_sse2(int predictor_type, int scanline_byte_length, int bytes_per_pixel)
 	{
-		int scanline_size = (image_width * bit_depth * get_image_data_channels() + 7) / 8;
-
-		int data_pos = 0;
-		int channels = get_image_data_channels();
-
-		int starting_row[7] = { 0, 0, 4, 0, 2, 0, 1 };
-		int starting_col[7] = { 0, 4, 0, 2, 0, 1, 0 };
-		int row_increment[7] = { 8, 8, 8, 4, 4, 2, 2 };
-		int col_increment[7] = { 8, 8, 4, 4, 2, 2, 1 };
-		//int block_height[7]  = { 8, 8, 4, 4, 2, 2, 1 };
-		//int block_width[7]   = { 8, 4, 4, 2, 2, 1, 1 };
-
-		unsigned char *output = image->data_uint8();
-		int output_pitch = image->pitch();
-		for (int pass = 0; pass < 7; pass++)
+		if (predictor_type == 2)
 		{
-			for (size_t i = 0; i < scanline_size; i++)
-				scanline[i] = 0;
-
-			for (int y = starting_row[pass]; y < image_height; y += row_increment[pass])
-			{
-				if (starting_col[pass] < image_width)
-				{
-					unsigned char *tmp = scanline;
-					scanline = prev_scanline;
-					prev_scanline = tmp;
-
-					int scanline_pixel_length = (image_width - starting_col[pass] + col_increment[pass] - 1) / col_increment[pass];
-					int scanline_byte_length = (scanline_pixel_length * bit_depth * channels + 7) / 8;
-
-					if (data_pos + scanline_byte_length > data_length)
-						throw Exception("Invalid PNG image file");
+			png_predictor_up_sse2(scanline, prev_scanline, scanline_byte_length);
+			return true;
+		}
 
-					int predictor_type = data[data_pos++];
-					memcpy(scanline, data + data_pos, scanline_byte_length);
-					data_pos += scanline_byte_length;
-
-					filter_scanline(predictor_type, scanline_byte_length);
-
-					if (bit_depth <= 8)
-						convert_scanline_4ub(scanline_pixel_length);
-					else
-						convert_scanline_4us(scanline_pixel_length);
-
-					int scanline_pos = 0;
-					for (int x = starting_col[pass]; x < image_width; x += col_increment[pass])
-					{
-						if (bit_depth <= 8)
-							*reinterpret_cast<Vec4ub*>(output + y * output_pitch + x * 4) = scanline_4ub[scanline_pos++];
-						else
-							*reinterpret_cast<Vec4us*>(output + y * output_pitch + x * 8) = scanline_4us[scanline_pos++];
-					}
-				}
-			}
+		switch (bytes_per_pixel)
+		{
+		case 3: return filter_scanline_sse2<3>(predictor_type, scanline_byte_length);
+		case 4: return filter_scanline_sse2<4>(predictor_type, scanline_byte_length);
+		case 6: return filter_scanline_sse2<6>(predictor_type, scanline_byte_length);
+		case 8: return filter_scanline_sse2<8>(predictor_type, scanline_byte_length);
+		default: return false; // Single pixel vectors do not pay off for 1 and 2 bytes per pixel
 		}
 	}
 
-	void PNGLoader::filter_scanline(int predictor_type, int scanline_byte_length)
+	template<int bytes_per_pixel>
+	bool PNGLoader::filter_scanline_sse2(int predictor_type, int scanline_byte_length)
 	{
-		int channels = get_image_data_channels();
 		switch (predictor_type)
 		{
-		case 0: break; // none
-		case 1: predictor_sub(scanline, prev_scanline, scanline_byte_length, channels, bit_depth); break;
-		case 2: predictor_up(scanline, prev_scanline, scanline_byte_length, channels, bit_depth); break;
-		case 3: predictor_average(scanline, prev_scanline, scanline_byte_length, channels, bit_depth); break;
-		case 4: predictor_paeth(scanline, prev_scanline, scanline_byte_length, channels, bit_depth); break;
-		default: throw Exception("Invalid PNG image file");
+		case 1: PNGPredictorSSE2<bytes_per_pixel>::sub(scanline, scanline_byte_length); return true;
+		case 3: PNGPredictorSSE2<bytes_per_pixel>::average(scanline, prev_scanline, scanline_byte_length); return true;
+		case 4:
+#ifdef USE_SSSE3
+			if (use_ssse3)
+			{
+				PNGPredictorSSE2<bytes_per_pixel>::paeth_ssse3(scanline, prev_scanline, scanline_byte_length);
+				return true;
+			}
+#endif
+			PNGPredictorSSE2<bytes_per_pixel>::paeth(scanline, prev_scanline, scanline_byte_length);
+			return true;
+		default: return false;
 		}
 	}
+#endif
 
-	void PNGLoader::predictor_sub(unsigned char *scanline, const unsigned char *prev_scanline, int byte_length, int channels, int bit_depth)
+	void PNGLoader::predictor_sub(unsigned char *scanline, const unsigned char * /*prev_scanline*/, int byte_length, int channels, int bit_depth)
 	{
 		int bytes_per_pixel = channels * ((bit_depth + 7) / 8);
-		for (int i = 0; i < byte_length; i++)
-		{
-			int x = scanline[i];
-			int a = i >= bytes_per_pixel ? scanline[i - bytes_per_pixel] : 0;
-			scanline[i] = x + a;
-		}
+		for (int i = bytes_per_pixel; i < byte_length; i++)
+			scanline[i] += scanline[i - bytes_per_pixel];
 	}
 
-	void PNGLoader::predictor_up(unsigned char *scanline, const unsigned char *prev_scanline, int byte_length, int channels, int bit_depth)
+	void PNGLoader::predictor_up(unsigned char *scanline, const unsigned char *prev_scanline, int byte_length, int /*channels*/, int /*bit_depth*/)
 	{
-		//int bytes_per_pixel = channels * ((bit_depth + 7) / 8);
 		for (int i = 0; i < byte_length; i++)
-		{
-			int x = scanline[i];
-			int b = prev_scanline[i];
-			scanline[i] = x + b;
-		}
+			scanline[i] += prev_scanline[i];
 	}
 
 	void PNGLoader::predictor_average(unsigned char *scanline, const unsigned char *prev_scanline, int byte_length, int channels, int bit_depth)
 	{
-		int bytes_per_pixel = channels * ((bit_depth + 7) / 8);
-		for (int i = 0; i < byte_length; i++)
-		{
-			int x = scanline[i];
-			int a = i >= bytes_per_pixel ? scanline[i - bytes_per_pixel] : 0;
-			int b = prev_scanline[i];
-			scanline[i] = x + (a + b) / 2;
-		}
+		int bytes_per_pixel = std::min(channels * ((bit_depth + 7) / 8), byte_length);
+		for (int i = 0; i < bytes_per_pixel; i++)
+			scanline[i] += prev_scanline[i] / 2;
+		for (int i = bytes_per_pixel; i < byte_length; i++)
+			scanline[i] += (scanline[i - bytes_per_pixel] + prev_scanline[i]) / 2;
 	}
 
 	void PNGLoader::predictor_paeth(unsigned char *scanline, const unsigned char *prev_scanline, int byte_length, int channels, int bit_depth)
 	{
-		int bytes_per_pixel = channels * ((bit_depth + 7) / 8);
-		for (int i = 0; i < byte_length; i++)
+		// The first pixel has no left neighbors, which makes the predictor equal to the up predictor
+		int bytes_per_pixel = std::min(channels * ((bit_depth + 7) / 8), byte_length);
+		for (int i = 0; i < bytes_per_pixel; i++)
+			scanline[i] += prev_scanline[i];
+
+		for (int i = bytes_per_pixel; i < byte_length; i++)
 		{
-			int x = scanline[i];
-			int a = i >= bytes_per_pixel ? scanline[i - bytes_per_pixel] : 0;
+			int a = scanline[i - bytes_per_pixel];
 			int b = prev_scanline[i];
-			int c = i >= bytes_per_pixel ? prev_scanline[i - bytes_per_pixel] : 0;
-			int p = a + b - c;
-			int pa = abs((p - a));
-			int pb = abs((p - b));
-			int pc = abs(p - c);
+			int c = prev_scanline[i - bytes_per_pixel];
+			int pa = abs(b - c);
+			int pb = abs(a - c);
+			int pc = abs(a + b - 2 * c);
 			int pr;
 			if (pa <= pb && pa <= pc)
 				pr = a;
@@ -429,7 +581,7 @@ namespace uicore
 				pr = b;
 			else
 				pr = c;
-			scanline[i] = x + pr;
+			scanline[i] += pr;
 		}
 	}
 
@@ -30,33 +30,46 @@
 
 #include "UICore/Core/IOData/iodevice.h"
 #include "UICore/Display/Image/pixel_buffer.h"
+#include "UICore/Display/ImageFormats/image_file_info.h"
 #include "UICore/Core/System/databuffer.h"
+#include "UICore/Core/Zip/zlib_compression.h"
 #include <map>
+#include <vector>
+#include <functional>
 
 namespace uicore
 {
 	class PNGLoader
 	{
 	public:
+		typedef std::function<void(const Size &image_size, int y, const std::shared_ptr<PixelBuffer> &scanline)> ScanlineCallback;
+
 		static std::shared_ptr<PixelBuffer> load(const std::shared_ptr<IODevice> &iodevice, bool srgb);
+		static void load(const std::shared_ptr<IODevice> &iodevice, bool srgb, const ScanlineCallback &callback);
+		static ImageFileInfo probe(const std::shared_ptr<IODevice> &iodevice, bool srgb);
 
 	private:
-		PNGLoader(const std::shared_ptr<IODevice> &iodevice, bool force_srgb);
+		PNGLoader(const std::shared_ptr<IODevice> &iodevice, bool force_srgb, const ScanlineCallback &callback);
 		~PNGLoader();
-		void read_magic();
+		static void read_magic(IODevice *file);
 		void read_chunks();
 		void decode_header();
 		void decode_palette();
 		void decode_colorkey();
-		void decode_image();
-		void decode_interlace_none(const unsigned char *data, int data_length);
-		void decode_interlace_adam7(const unsigned char *data, int data_length);
+		void begin_image();
+		void decode_image_data(const unsigned char *data, int data_length);
+		bool begin_row();
+		void decode_row();
+		void end_image();
 
 		void create_image();
+		static float decode_pixel_ratio(const unsigned char *phys);
 		void create_scanline_buffers();
 		int get_image_data_channels();
 
 		void filter_scanline(int predictor_type, int scanline_byte_length);
+		bool filter_scanline_sse2(int predictor_type, int scanline_byte_length, int bytes_per_pixel);
+		template<int bytes_per_pixel> bool filter_scanline_sse2(int predictor_type, int scanline_byte_length);
 		static void predictor_sub(unsigned char *scanline, const unsigned char *prev_scanline, int byte_length, int channels, int bit_depth);
 		static void predictor_up(unsigned char *scanline, const unsigned char *prev_scanline, int byte_length, int channels, int bit_depth);
 		static void predictor_average(unsigned char *scanline, const unsigned char *prev_scanline, int byte_length, int channels, int bit_depth);
@@ -78,13 +91,13 @@ namespace uicore
 
 		static int abs(int a) { return a >= 0 ? a : -a; }
 
-		inline unsigned int from_network_order(unsigned int v)
+		static unsigned int from_network_order(unsigned int v)
 		{
 			unsigned char *p = reinterpret_cast<unsigned char *>(&v);
 			return (static_cast<unsigned int>(p[0]) << 24) | (static_cast<unsigned int>(p[1]) << 16) | (static_cast<unsigned int>(p[2]) << 8) | p[3];
 		}
 
-		inline unsigned short from_network_order(unsigned short v)
+		static unsigned short from_network_order(unsigned short v)
 		{
 			unsigned char *p = reinterpret_cast<unsigned char *>(&v);
 			return (static_cast<unsigned int>(p[0]) << 8) | p[1];
@@ -92,12 +105,15 @@ namespace uicore
 
 		std::shared_ptr<IODevice> file;
 		bool force_srgb;
+		bool use_sse2 = false;
+		bool use_ssse3 = false;
+		ScanlineCallback scanline_callback;
 
 		std::shared_ptr<PixelBuffer> image;
+		std::shared_ptr<PixelBuffer> callback_scanline;
 
 		std::shared_ptr<DataBuffer> ihdr; // image header, which is the first chunk in a PNG datastream.
 		std::shared_ptr<DataBuffer> plte; // palette table associated with indexed PNG images.
-		std::shared_ptr<DataBuffer> idat; // image data chunks.
 
 		std::shared_ptr<DataBuffer> trns; // Transparency information
 		std::shared_ptr<DataBuffer> chrm; // Colour space information (5 chunks)
@@ -105,6 +121,7 @@ namespace uicore
 		std::shared_ptr<DataBuffer> iccp;
 		std::shared_ptr<DataBuffer> sbit;
 		std::shared_ptr<DataBuffer> srgb;
+		std::shared_ptr<DataBuffer> phys; // Physical pixel dimensions
 
 		unsigned int image_width;
 		unsigned int image_height;
@@ -114,8 +131,20 @@ namespace uicore
 		unsigned char filter_method;
 		unsigned char interlace_method;
 
-		unsigned char *scanline;
+		std::shared_ptr<ZLibDecompressor> idat_inflater; // image data chunks are decompressed as they are read.
+		std::vector<unsigned char> idat_chunk;
+
+		// Current row of the image data being decompressed
+		int pass = 0;
+		int row_y = 0;
+		int row_pixel_length = 0;
+		int row_byte_length = 0;
+		int row_pos = 0;
+		bool image_complete = false;
+
+		unsigned char *scanline;	// Preceded by the predictor type byte
 		unsigned char *prev_scanline;
+		static const int scanline_padding = 16;
 		Vec4ub *scanline_4ub;
 		Vec4us *scanline_4us;
 
@@ -0,0 +1,221 @@
+/*
+**  UICore
+**  Copyright (c) 1997-2015 The UICore Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries UICore may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include <emmintrin.h>
+#if defined(_MSC_VER) || defined(__SSSE3__) || defined(__GNUC__)
+#define USE_SSSE3
+#include <tmmintrin.h>
+#if defined(_MSC_VER) || defined(__SSSE3__)
+#define SSSE3_TARGET
+#else
+#define SSSE3_TARGET __attribute__((target("ssse3")))
+#endif
+#endif
+
+#if defined(_MSC_VER)
+#define PNG_PREDICTOR_INLINE __forceinline
+#else
+#define PNG_PREDICTOR_INLINE inline __attribute__((always_inline))
+#endif
+#include <cstring>
+
+namespace uicore
+{
+	/// \brief SSE2 versions of the PNG predictors for 3, 4, 6 and 8 bytes per pixel
+	///
+	/// Each pixel depends on the pixel to its left, so the vectors only hold a single pixel widened to 16 bits.
+	template<int bytes_per_pixel>
+	class PNGPredictorSSE2
+	{
+	public:
+		static void sub(unsigned char *scanline, int byte_length)
+		{
+			__m128i a = _mm_setzero_si128();
+			for (int i = 0; i < byte_length; i += bytes_per_pixel)
+			{
+				a = _mm_add_epi8(a, load(scanline + i));
+				store(scanline + i, a);
+			}
+		}
+
+		static void average(unsigned char *scanline, const unsigned char *prev_scanline, int byte_length)
+		{
+			__m128i one = _mm_set1_epi8(1);
+			__m128i a = _mm_setzero_si128();
+			for (int i = 0; i < byte_length; i += bytes_per_pixel)
+			{
+				__m128i b = load(prev_scanline + i);
+				__m128i x = load(scanline + i);
+
+				// _mm_avg_epu8 rounds up while the predictor rounds down
+				__m128i avg = _mm_sub_epi8(_mm_avg_epu8(a, b), _mm_and_si128(_mm_xor_si128(a, b), one));
+				a = _mm_add_epi8(x, avg);
+				store(scanline + i, a);
+			}
+		}
+
+		static void paeth(unsigned char *scanline, const unsigned char *prev_scanline, int byte_length)
+		{
+			paeth_kernel<false>(scanline, prev_scanline, byte_length);
+		}
+
+#ifdef USE_SSSE3
+		SSSE3_TARGET static void paeth_ssse3(unsigned char *scanline, const unsigned char *prev_scanline, int byte_length)
+		{
+			paeth_kernel<true>(scanline, prev_scanline, byte_length);
+		}
+#endif
+
+	private:
+		// Forced inline so the SSSE3 variant is compiled with the target of paeth_ssse3
+		template<bool use_ssse3>
+		static PNG_PREDICTOR_INLINE void paeth_kernel(unsigned char *scanline, const unsigned char *prev_scanline, int byte_length)
+		{
+			__m128i zero = _mm_setzero_si128();
+			__m128i one = _mm_set1_epi16(1);
+			__m128i mask_ff = _mm_set1_epi16(0xff);
+			__m128i a = zero;
+			__m128i c = zero;
+			for (int i = 0; i < byte_length; i += bytes_per_pixel)
+			{
+				__m128i b = _mm_unpacklo_epi8(load(prev_scanline + i), zero);
+				__m128i x = _mm_unpacklo_epi8(load(scanline + i), zero);
+
+				// p = a + b - c, pa = |p - a| = |b - c|, pb = |p - b| = |a - c|, pc = |p - c| = |pa + pb|
+				__m128i pa = _mm_sub_epi16(b, c);
+				__m128i pb = _mm_sub_epi16(a, c);
+				__m128i pc = _mm_add_epi16(pa, pb);
+				pa = use_ssse3 ? abs_epi16_ssse3(pa) : abs_epi16(pa);
+				pb = use_ssse3 ? abs_epi16_ssse3(pb) : abs_epi16(pb);
+				pc = use_ssse3 ? abs_epi16_ssse3(pc) : abs_epi16(pc);
+
+				// Ties are broken in the order a, b, c
+				__m128i use_a = _mm_and_si128(_mm_cmpgt_epi16(_mm_add_epi16(pb, one), pa), _mm_cmpgt_epi16(_mm_add_epi16(pc, one), pa));
+				__m128i use_b = _mm_cmpgt_epi16(_mm_add_epi16(pc, one), pb);
+				__m128i pr = select(use_a, a, select(use_b, b, c));
+
+				a = _mm_and_si128(_mm_add_epi16(x, pr), mask_ff);
+				c = b;
+				store(scanline + i, _mm_packus_epi16(a, a));
+			}
+		}
+
+		// Partial pixels are assembled in registers. Copying them through a temporary stalls store forwarding on every pixel
+		static __m128i load(const unsigned char *p)
+		{
+			if (bytes_per_pixel == 3)
+			{
+				int v = p[0] | (p[1] << 8) | (p[2] << 16);
+				return _mm_cvtsi32_si128(v);
+			}
+			else if (bytes_per_pixel == 6)
+			{
+				unsigned short hi;
+				int lo;
+				memcpy(&lo, p, 4);
+				memcpy(&hi, p + 4, 2);
+				return _mm_insert_epi16(_mm_cvtsi32_si128(lo), hi, 2);
+			}
+			else if (bytes_per_pixel == 4)
+			{
+				int v;
+				memcpy(&v, p, 4);
+				return _mm_cvtsi32_si128(v);
+			}
+			else
+			{
+				return _mm_loadl_epi64(reinterpret_cast<const __m128i*>(p));
+			}
+		}
+
+		static void store(unsigned char *p, __m128i v)
+		{
+			if (bytes_per_pixel == 3)
+			{
+				int value = _mm_cvtsi128_si32(v);
+				p[0] = (unsigned char)value;
+				p[1] = (unsigned char)(value >> 8);
+				p[2] = (unsigned char)(value >> 16);
+			}
+			else if (bytes_per_pixel == 6)
+			{
+				int lo = _mm_cvtsi128_si32(v);
+				unsigned short hi = (unsigned short)_mm_extract_epi16(v, 2);
+				memcpy(p, &lo, 4);
+				memcpy(p + 4, &hi, 2);
+			}
+			else if (bytes_per_pixel == 4)
+			{
+				int value = _mm_cvtsi128_si32(v);
+				memcpy(p, &value, 4);
+			}
+			else
+			{
+				_mm_storel_epi64(reinterpret_cast<__m128i*>(p), v);
+			}
+		}
+
+		static __m128i select(__m128i mask, __m128i a, __m128i b)
+		{
+			return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+		}
+
+		static __m128i abs_epi16(__m128i v)
+		{
+			return _mm_max_epi16(v, _mm_sub_epi16(_mm_setzero_si128(), v));
+		}
+
+#ifdef USE_SSSE3
+		SSSE3_TARGET static __m128i abs_epi16_ssse3(__m128i v)
+		{
+			return _mm_abs_epi16(v);
+		}
+#else
+		static __m128i abs_epi16_ssse3(__m128i v)
+		{
+			return abs_epi16(v);
+		}
+#endif
+	};
+
+	/// \brief SSE2 version of the up predictor, which has no dependency between pixels
+	inline void png_predictor_up_sse2(unsigned char *scanline, const unsigned char *prev_scanline, int byte_length)
+	{
+		int sse_length = (byte_length / 16) * 16;
+		for (int i = 0; i < sse_length; i += 16)
+		{
+			__m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(scanline + i));
+			__m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(prev_scanline + i));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(scanline + i), _mm_add_epi8(x, b));
+		}
+		for (int i = sse_length; i < byte_length; i++)
+			scanline[i] = scanline[i] + prev_scanline[i];
+	}
+}
@@ -29,22 +29,24 @@
 #include "UICore/precomp.h"
 #include "png_writer.h"
 #include "UICore/Core/Zip/zlib_compression.h"
+#include "UICore/Core/System/thread_pool.h"
 
 namespace uicore
 {
-	void PNGWriter::save(const std::shared_ptr<IODevice> &iodevice, std::shared_ptr<PixelBuffer> image)
+	void PNGWriter::save(const std::shared_ptr<IODevice> &iodevice, std::shared_ptr<PixelBuffer> image, bool multithreaded)
 	{
-		PNGWriter writer(iodevice, image);
+		PNGWriter writer(iodevice, image, multithreaded);
 		writer.save();
 	}
 	
-	PNGWriter::PNGWriter(const std::shared_ptr<IODevice> &iodevice, std::shared_ptr<PixelBuffer> src_image) : device(iodevice)
+	PNGWriter::PNGWriter(const std::shared_ptr<IODevice> &iodevice, std::shared_ptr<PixelBuffer> src_image, bool multithreaded) : device(iodevice), multithreaded(multithreaded)
 	{
 		// This writer only supports RGBA format
 		if (src_image->bytes_per_pixel() < 8)
 			image = src_image->to_format(tf_rgba8);
 		else
 			image = src_image->to_format(tf_rgba16);
+		image->set_pixel_ratio(src_image->pixel_ratio());
 	}
 	
 	void PNGWriter::save()
@@ -114,56 +116,124 @@ namespace uicore
 	
 	void PNGWriter::write_data()
 	{
-		//int width = image->width();
 		int height = image->height();
 		int bytes_per_pixel = image->bytes_per_pixel();
-		
-		std::vector<unsigned char> scanline_orig;
-		std::vector<unsigned char> scanline_filtered;
-		scanline_orig.resize((image->width() + 1) * bytes_per_pixel);
-		scanline_filtered.resize(image->width() * bytes_per_pixel + 1);
-		
-		auto idat_uncompressed = DataBuffer::create(height * scanline_filtered.size());
-		
-		for (int y = 0; y < height; y++)
+		int row_length = image->width() * bytes_per_pixel;
+
+		auto idat_uncompressed = DataBuffer::create((size_t)height * (row_length + 1));
+
+		// Filtering only looks at the unfiltered rows, so the rows can be split between threads
+		const int min_batch_bytes = 64 * 1024;
+		ThreadPool::shared().parallel_for(height, std::max(min_batch_bytes / (row_length + 1), 1), [&](int begin, int end)
 		{
-			// Grab scanline
-			memcpy(scanline_orig.data() + bytes_per_pixel, image->line(y), scanline_orig.size() - bytes_per_pixel);
+			std::vector<unsigned char> row(row_length);
+			std::vector<unsigned char> prev_row(row_length);
+			std::vector<unsigned char> filtered(row_length);
 
-			// Convert to big endian for 16 bit
-			if (bytes_per_pixel == 8)
+			if (begin > 0)
+				read_scanline(begin - 1, prev_row.data());
+
+			for (int y = begin; y < end; y++)
 			{
-				for (size_t x = 0; x < scanline_orig.size(); x+=2)
-				{
-					std::swap(scanline_orig[x], scanline_orig[x + 1]);
-				}
+				read_scanline(y, row.data());
+				filter_scanline(row.data(), prev_row.data(), row_length, bytes_per_pixel, filtered.data(), idat_uncompressed->data<unsigned char>() + (size_t)y * (row_length + 1));
+				row.swap(prev_row);
 			}
+		});
+
+		std::shared_ptr<DataBuffer> idat = multithreaded ? ZLibCompression::compress_parallel(idat_uncompressed, false) : ZLibCompression::compress(idat_uncompressed, false);
+
+		write_chunk("IDAT", idat->data(), idat->size());
+	}
 
-			// Filter scanline
-			/*
-			scanline_filtered[0] = 0; // None filter type
-			for (int i = bytes_per_pixel; i < scanline_orig.size(); i++)
+	void PNGWriter::read_scanline(int y, unsigned char *output)
+	{
+		int length = image->width() * image->bytes_per_pixel();
+		memcpy(output, image->line(y), length);
+
+		// Convert to big endian for 16 bit
+		if (image->bytes_per_pixel() == 8)
+		{
+			for (int x = 0; x < length; x += 2)
+				std::swap(output[x], output[x + 1]);
+		}
+	}
+
+	void PNGWriter::filter_scanline(const unsigned char *scanline, const unsigned char *prev_scanline, int length, int bytes_per_pixel, unsigned char *temp, unsigned char *output)
+	{
+		// Pick the predictor giving the smallest sum of absolute differences, which usually compresses best
+		unsigned int best_cost = 0xffffffff;
+		for (int predictor_type = 0; predictor_type < 5; predictor_type++)
+		{
+			unsigned int cost = apply_predictor(predictor_type, scanline, prev_scanline, length, bytes_per_pixel, temp);
+			if (cost < best_cost)
 			{
-				scanline_filtered[i - bytes_per_pixel + 1] = scanline_orig[i];
+				best_cost = cost;
+				output[0] = predictor_type;
+				memcpy(output + 1, temp, length);
 			}
-			*/
-			scanline_filtered[0] = 1; // Sub filter type
-			for (int i = bytes_per_pixel; i < scanline_orig.size(); i++)
+		}
+	}
+
+	template<int predictor_type>
+	inline int PNGWriter::predict(int a, int b, int c)
+	{
+		switch (predictor_type)
+		{
+		default:
+		case 0: return 0; // none
+		case 1: return a; // sub
+		case 2: return b; // up
+		case 3: return (a + b) / 2; // average
+		case 4: // paeth
 			{
-				unsigned char a = scanline_orig[i - bytes_per_pixel];
-				unsigned char x = scanline_orig[i];
-				scanline_filtered[i - bytes_per_pixel + 1] = x - a;
+				int pa = std::abs(b - c);
+				int pb = std::abs(a - c);
+				int pc = std::abs(a + b - 2 * c);
+				if (pa <= pb && pa <= pc)
+					return a;
+				else if (pb <= pc)
+					return b;
+				else
+					return c;
 			}
-			
-			// Output scanline
-			memcpy(idat_uncompressed->data<unsigned char>() + y * scanline_filtered.size(), scanline_filtered.data(), scanline_filtered.size());
 		}
-		
-		std::shared_ptr<DataBuffer> idat = ZLibCompression::compress(idat_uncompressed, false);
-		
-		write_chunk("IDAT", idat->data(), idat->size());
 	}
-	
+
+	template<int predictor_type>
+	unsigned int PNGWriter::apply_predictor(const unsigned char *scanline, const unsigned char *prev_scanline, int length, int bytes_per_pixel, unsigned char *output)
+	{
+		// The first pixel has no left neighbours. Handling it separately keeps the main loop free of branches so it can be vectorized
+		unsigned int cost = 0;
+		int first = std::min(bytes_per_pixel, length);
+		for (int i = 0; i < first; i++)
+		{
+			unsigned char value = scanline[i] - predict<predictor_type>(0, prev_scanline[i], 0);
+			output[i] = value;
+			cost += std::abs((int)(signed char)value);
+		}
+		for (int i = first; i < length; i++)
+		{
+			unsigned char value = scanline[i] - predict<predictor_type>(scanline[i - bytes_per_pixel], prev_scanline[i], prev_scanline[i - bytes_per_pixel]);
+			output[i] = value;
+			cost += std::abs((int)(signed char)value);
+		}
+		return cost;
+	}
+
+	unsigned int PNGWriter::apply_predictor(int predictor_type, const unsigned char *scanline, const unsigned char *prev_scanline, int length, int bytes_per_pixel, unsigned char *output)
+	{
+		switch (predictor_type)
+		{
+		default:
+		case 0: return apply_predictor<0>(scanline, prev_scanline, length, bytes_per_pixel, output);
+		case 1: return apply_predictor<1>(scanline, prev_scanline, length, bytes_per_pixel, output);
+		case 2: return apply_predictor<2>(scanline, prev_scanline, length, bytes_per_pixel, output);
+		case 3: return apply_predictor<3>(scanline, prev_scanline, length, bytes_per_pixel, output);
+		case 4: return apply_predictor<4>(scanline, prev_scanline, length, bytes_per_pixel, output);
+		}
+	}
+
 	void PNGWriter::write_chunk(const char name[4], const void *data, int size)
 	{
 		unsigned char size_data[4];
@@ -37,20 +37,26 @@ namespace uicore
 	class PNGWriter
 	{
 	public:
-		static void save(const std::shared_ptr<IODevice> &iodevice, std::shared_ptr<PixelBuffer> image);
+		static void save(const std::shared_ptr<IODevice> &iodevice, std::shared_ptr<PixelBuffer> image, bool multithreaded);
 		
 	private:
-		PNGWriter(const std::shared_ptr<IODevice> &iodevice, std::shared_ptr<PixelBuffer> image);
+		PNGWriter(const std::shared_ptr<IODevice> &iodevice, std::shared_ptr<PixelBuffer> image, bool multithreaded);
 		void save();
 
 		void write_magic();
 		void write_headers();
 		void write_data();
+		void read_scanline(int y, unsigned char *output);
+		static void filter_scanline(const unsigned char *scanline, const unsigned char *prev_scanline, int length, int bytes_per_pixel, unsigned char *temp, unsigned char *output);
+		static unsigned int apply_predictor(int predictor_type, const unsigned char *scanline, const unsigned char *prev_scanline, int length, int bytes_per_pixel, unsigned char *output);
+		template<int predictor_type> static unsigned int apply_predictor(const unsigned char *scanline, const unsigned char *prev_scanline, int length, int bytes_per_pixel, unsigned char *output);
+		template<int predictor_type> static int predict(int a, int b, int c);
 		
 		void write_chunk(const char name[4], const void *data, int size);
 		
 		std::shared_ptr<IODevice> device;
 		std::shared_ptr<PixelBuffer> image;
+		bool multithreaded;
 	};
 	
 	class PNGCRC32
@@ -37,10 +37,19 @@ namespace uicore
 		return loader.image;
 	}
 
-	TargaLoader::TargaLoader(const std::shared_ptr<IODevice> &iodevice, bool srgb)
+	ImageFileInfo TargaLoader::probe(const std::shared_ptr<IODevice> &iodevice, bool srgb)
+	{
+		TargaLoader loader(iodevice, srgb, true);
+		return ImageFileInfo(loader.image_width, loader.image_height, srgb ? tf_srgb8_alpha8 : tf_rgba8);
+	}
+
+	TargaLoader::TargaLoader(const std::shared_ptr<IODevice> &iodevice, bool srgb, bool header_only)
 		: file(iodevice), srgb(srgb)
 	{
 		read_header();
+		if (header_only)
+			return;
+
 		read_image_id();
 		read_color_map();
 		read_image_data();
@@ -100,13 +109,20 @@ namespace uicore
 
 		if (image_type == 9 || image_type == 10 || image_type == 11) // RLE compressed
 		{
-			auto rle_data = DataBuffer::create(file->size() - file->position());
-			file->read(rle_data->data(), rle_data->size());
+			int input_available = (int)(file->size() - file->position());
+
+			// Memory backed devices let the compressed data be decoded in place
+			std::shared_ptr<DataBuffer> rle_data;
+			const unsigned char *input = static_cast<const unsigned char*>(file->try_read_in_place(input_available));
+			if (!input)
+			{
+				rle_data = DataBuffer::create(input_available);
+				file->read(rle_data->data(), rle_data->size());
+				input = reinterpret_cast<const unsigned char*>(rle_data->data());
+			}
 
-			unsigned char *input = reinterpret_cast<unsigned char*>(rle_data->data());
 			unsigned char *output = reinterpret_cast<unsigned char*>(image_data->data());
 			int pixels_left = image_width * image_height;
-			int input_available = rle_data->size();
 			while (pixels_left > 0 && input_available > 0)
 			{
 				int code = *input;
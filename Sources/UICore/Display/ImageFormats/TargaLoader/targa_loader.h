@@ -31,6 +31,7 @@
 #include "UICore/Core/IOData/iodevice.h"
 #include "UICore/Core/System/databuffer.h"
 #include "UICore/Display/Image/pixel_buffer.h"
+#include "UICore/Display/ImageFormats/image_file_info.h"
 #include <vector>
 
 namespace uicore
@@ -39,9 +40,10 @@ namespace uicore
 	{
 	public:
 		static std::shared_ptr<PixelBuffer> load(const std::shared_ptr<IODevice> &iodevice, bool srgb);
+		static ImageFileInfo probe(const std::shared_ptr<IODevice> &iodevice, bool srgb);
 
 	private:
-		TargaLoader(const std::shared_ptr<IODevice> &iodevice, bool srgb);
+		TargaLoader(const std::shared_ptr<IODevice> &iodevice, bool srgb, bool header_only = false);
 		void read_header();
 		void read_image_id();
 		void read_color_map();
@@ -29,6 +29,8 @@
 #include "UICore/precomp.h"
 #include <iostream>
 #include "UICore/Core/IOData/file.h"
+#include "UICore/Core/IOData/memory_device.h"
+#include "UICore/Core/IOData/mapped_file.h"
 #include "UICore/Core/IOData/path_help.h"
 #include "UICore/Display/ImageFormats/dds_format.h"
 #include "UICore/Display/Image/pixel_buffer.h"
@@ -37,13 +39,21 @@
 
 namespace uicore
 {
-	std::shared_ptr<PixelBufferSet> DDSFormat::load(const std::string &filename)
+	namespace
 	{
-		auto file = File::open_existing(filename);
-		return load(file);
+		class DDSHeader
+		{
+		public:
+			TextureDimensions dimensions = texture_2d;
+			TextureFormat format = tf_rgba8;
+			int width = 0;
+			int height = 0;
+			int slices = 1;
+			int levels = 1;
+		};
 	}
 
-	std::shared_ptr<PixelBufferSet> DDSFormat::load(const std::shared_ptr<IODevice> &file)
+	static DDSHeader read_dds_header(IODevice *file)
 	{
 #define fourccvalue(a,b,c,d) ((static_cast<unsigned int>(a)) | (static_cast<unsigned int>(b) << 8) | (static_cast<unsigned int>(c) << 16) | (static_cast<unsigned int>(d) << 24))
 #define isbitmask(r,g,b,a) (format_red_bit_mask == (r) && format_green_bit_mask == (g) && format_blue_bit_mask == (b) && format_alpha_bit_mask == (a))
@@ -278,11 +288,42 @@ namespace uicore
 			}
 		}
 
-		TextureFormat original_format = texture_format;
-		if (texture_format == tf_bgra8 || texture_format == tf_rgb8 || texture_format == tf_bgr8)
-			texture_format = tf_rgba8;
+		DDSHeader header;
+		header.dimensions = texture_dimensions;
+		header.format = texture_format;
+		header.width = texture_width;
+		header.height = texture_height;
+		header.slices = texture_slices;
+		header.levels = texture_levels;
+		return header;
+	}
+
+	static TextureFormat dds_loaded_format(TextureFormat file_format, bool decompress)
+	{
+		if (file_format == tf_bgra8 || file_format == tf_rgb8 || file_format == tf_bgr8)
+			return tf_rgba8;
+		else if (decompress && (file_format == tf_compressed_srgb_s3tc_dxt1 || file_format == tf_compressed_srgb_alpha_s3tc_dxt1 || file_format == tf_compressed_srgb_alpha_s3tc_dxt3 || file_format == tf_compressed_srgb_alpha_s3tc_dxt5))
+			return tf_srgb8_alpha8;
+		else if (decompress && PixelBuffer::is_compressed(file_format))
+			return tf_rgba8;
+		else
+			return file_format;
+	}
+
+	std::shared_ptr<PixelBufferSet> DDSFormat::load(const std::string &filename, bool decompress)
+	{
+		auto file = MemoryDevice::open(MappedFile::open_or_read(filename));
+		return load(file, decompress);
+	}
+
+	std::shared_ptr<PixelBufferSet> DDSFormat::load(const std::shared_ptr<IODevice> &file, bool decompress)
+	{
+		DDSHeader header = read_dds_header(file.get());
+
+		TextureFormat original_format = header.format;
+		TextureFormat texture_format = dds_loaded_format(original_format, decompress);
 
-		auto set = PixelBufferSet::create(texture_dimensions, texture_format, texture_width, texture_height, texture_slices);
+		auto set = PixelBufferSet::create(header.dimensions, texture_format, header.width, header.height, header.slices);
 
 		int bytes_per_pixel = 0;
 		int bytes_per_block = 0;
@@ -295,12 +336,12 @@ namespace uicore
 			bytes_per_pixel = PixelBuffer::bytes_per_pixel(original_format);
 		}
 
-		for (int slice = 0; slice < texture_slices; slice++)
+		for (int slice = 0; slice < header.slices; slice++)
 		{
-			for (int level = 0; level < texture_levels; level++)
+			for (int level = 0; level < header.levels; level++)
 			{
-				int mip_width = max(texture_width >> level, 1);
-				int mip_height = max(texture_height >> level, 1);
+				int mip_width = max(header.width >> level, 1);
+				int mip_height = max(header.height >> level, 1);
 
 				auto buffer = PixelBuffer::create(mip_width, mip_height, original_format);
 
@@ -324,4 +365,16 @@ namespace uicore
 
 		return set;
 	}
+
+	ImageFileInfo DDSFormat::probe(const std::string &filename, bool decompress)
+	{
+		auto file = File::open_existing(filename);
+		return probe(file, decompress);
+	}
+
+	ImageFileInfo DDSFormat::probe(const std::shared_ptr<IODevice> &file, bool decompress)
+	{
+		DDSHeader header = read_dds_header(file.get());
+		return ImageFileInfo(header.width, header.height, dds_loaded_format(header.format, decompress));
+	}
 }
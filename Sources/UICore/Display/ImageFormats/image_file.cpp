@@ -29,13 +29,19 @@
 #include "UICore/precomp.h"
 #include "UICore/Core/IOData/path_help.h"
 #include "UICore/Core/IOData/file.h"
+#include "UICore/Core/IOData/memory_device.h"
+#include "UICore/Core/IOData/mapped_file.h"
+#include "UICore/Core/IOData/directory.h"
 #include "UICore/Display/ImageFormats/image_file.h"
 #include "UICore/Display/ImageFormats/image_file_type.h"
+#include "UICore/Display/ImageFormats/dds_format.h"
 #include "UICore/Display/Image/pixel_buffer.h"
 #include "UICore/Core/System/exception.h"
 #include "UICore/Core/Text/text.h"
+#include "UICore/Core/System/thread_pool.h"
 #include "UICore/Core/IOData/path_help.h"
 #include "../setup_display.h"
+#include <algorithm>
 
 namespace uicore
 {
@@ -85,6 +91,103 @@ namespace uicore
 		return factory->load(file, srgb);
 	}
 
+	std::shared_ptr<PixelBuffer> ImageFile::load(const std::string &filename, const ImageImportDescription &import_desc, const std::string &type)
+	{
+		SetupDisplay::start();
+
+		std::string ext = type;
+		if (ext.empty())
+		{
+			ext = FilePath::extension(filename);
+			ext = Text::to_lower(ext);
+		}
+
+		auto file = MemoryDevice::open(MappedFile::open_or_read(filename));
+		return ImageFile::load(file, ext, import_desc);
+	}
+
+	std::shared_ptr<PixelBuffer> ImageFile::load(const std::shared_ptr<IODevice> &file, const std::string &type, const ImageImportDescription &import_desc)
+	{
+		SetupDisplay::start();
+		auto &types = *SetupDisplay::get_image_provider_factory_types();
+		if (types.find(type) == types.end()) throw Exception("Unknown image provider type " + type);
+
+		ImageFileType *factory = types[type];
+		return factory->load(file, import_desc);
+	}
+
+	ImageFileInfo ImageFile::probe(const std::string &filename, const std::string &type, bool srgb)
+	{
+		SetupDisplay::start();
+
+		std::string ext = type;
+		if (ext.empty())
+		{
+			ext = FilePath::extension(filename);
+			ext = Text::to_lower(ext);
+		}
+
+		// Only the headers are read, so the file is not mapped or read into memory
+		auto file = File::open_existing(filename);
+		return ImageFile::probe(file, ext, srgb);
+	}
+
+	ImageFileInfo ImageFile::probe(const std::shared_ptr<IODevice> &file, const std::string &type, bool srgb)
+	{
+		SetupDisplay::start();
+
+		// DDS files load as a PixelBufferSet and therefore have no image provider type
+		if (type == "dds")
+			return DDSFormat::probe(file);
+
+		auto &types = *SetupDisplay::get_image_provider_factory_types();
+		auto it = types.find(type);
+		if (it == types.end()) throw Exception("Unknown image provider type " + type);
+
+		return it->second->probe(file, srgb);
+	}
+
+	std::vector<std::pair<std::string, ImageFileInfo>> ImageFile::probe_directory(const std::string &path, bool srgb)
+	{
+		SetupDisplay::start();
+		auto &types = *SetupDisplay::get_image_provider_factory_types();
+
+		std::vector<std::string> filenames;
+		for (const auto &filename : Directory::files(path, true))
+		{
+			std::string ext = Text::to_lower(FilePath::extension(filename));
+			if (ext == "dds" || types.find(ext) != types.end())
+				filenames.push_back(filename);
+		}
+		std::sort(filenames.begin(), filenames.end());
+
+		// Each probe is dominated by file open and read latency, so they are spread over the pool one file at a time
+		std::vector<ImageFileInfo> infos(filenames.size());
+		std::vector<char> probed(filenames.size());
+		ThreadPool::shared().parallel_for((int)filenames.size(), 1, [&](int begin, int end)
+		{
+			for (int i = begin; i < end; i++)
+			{
+				try
+				{
+					infos[i] = probe(filenames[i], std::string(), srgb);
+					probed[i] = 1;
+				}
+				catch (const Exception &)
+				{
+				}
+			}
+		});
+
+		std::vector<std::pair<std::string, ImageFileInfo>> result;
+		for (size_t i = 0; i < filenames.size(); i++)
+		{
+			if (probed[i])
+				result.push_back(std::make_pair(filenames[i], infos[i]));
+		}
+		return result;
+	}
+
 	void ImageFile::save(std::shared_ptr<PixelBuffer> buffer, const std::string &filename, const std::string &type)
 	{
 		SetupDisplay::start();
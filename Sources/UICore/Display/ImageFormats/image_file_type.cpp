@@ -53,4 +53,15 @@ namespace uicore
 			}
 		}
 	}
+
+	std::shared_ptr<PixelBuffer> ImageFileType::load(const std::shared_ptr<IODevice> &file, const ImageImportDescription &import_desc)
+	{
+		return load(file, import_desc.is_srgb());
+	}
+
+	ImageFileInfo ImageFileType::probe(const std::shared_ptr<IODevice> &file, bool srgb)
+	{
+		auto image = load(file, srgb);
+		return ImageFileInfo(image->width(), image->height(), image->format(), image->pixel_ratio());
+	}
 }
@@ -30,6 +30,8 @@
 #include "UICore/precomp.h"
 #include <iostream>
 #include "UICore/Core/IOData/file.h"
+#include "UICore/Core/IOData/memory_device.h"
+#include "UICore/Core/IOData/mapped_file.h"
 #include "UICore/Core/IOData/path_help.h"
 #include "UICore/Display/ImageFormats/jpeg_format.h"
 #include "UICore/Core/System/databuffer.h"
@@ -42,7 +44,7 @@ namespace uicore
 {
 	std::shared_ptr<PixelBuffer> JPEGFormat::load(const std::string &filename, bool srgb)
 	{
-		auto file = File::open_existing(filename);
+		auto file = MemoryDevice::open(MappedFile::open_or_read(filename));
 		return JPEGLoader::load(file, srgb);
 	}
 
@@ -51,13 +53,60 @@ namespace uicore
 		return JPEGLoader::load(file, srgb);
 	}
 
+	std::shared_ptr<PixelBuffer> JPEGFormat::load(const std::shared_ptr<IODevice> &file, const ImageImportDescription &import_desc)
+	{
+		return JPEGLoader::load(file, import_desc.is_srgb(), import_desc.decode_scale());
+	}
+
+	std::shared_ptr<PixelBuffer> JPEGFormat::load(const std::shared_ptr<IODevice> &file, const ImageImportDescription &import_desc, const std::function<void(const std::shared_ptr<PixelBuffer> &image)> &scan_callback)
+	{
+		return JPEGLoader::load(file, import_desc.is_srgb(), import_desc.decode_scale(), scan_callback);
+	}
+
+	ImageFileInfo JPEGFormat::probe(const std::string &filename, bool srgb)
+	{
+		auto file = File::open_existing(filename);
+		return JPEGLoader::probe(file, srgb);
+	}
+
+	ImageFileInfo JPEGFormat::probe(const std::shared_ptr<IODevice> &file, bool srgb)
+	{
+		return JPEGLoader::probe(file, srgb);
+	}
+
 	void JPEGFormat::save(std::shared_ptr<PixelBuffer> buffer, const std::string &filename, int quality)
 	{
-		auto file = File::create_always(filename);
-		return JPEGFormat::save(buffer, file, quality);
+		JPEGFormat::save(buffer, filename, JPEGSaveSettings(quality));
 	}
 
 	void JPEGFormat::save(std::shared_ptr<PixelBuffer> buffer, const std::shared_ptr<IODevice> &file, int quality)
+	{
+		JPEGFormat::save(buffer, file, JPEGSaveSettings(quality));
+	}
+
+	void JPEGFormat::save(std::shared_ptr<PixelBuffer> buffer, const std::string &filename, const JPEGSaveSettings &settings)
+	{
+		auto file = File::create_always(filename);
+		JPEGFormat::save(buffer, file, settings);
+	}
+
+	namespace
+	{
+		class JPEGOutputStream : public uicore_jpge::output_stream
+		{
+		public:
+			bool put_buf(const void *data, int len) override
+			{
+				const uicore_jpge::uint8 *bytes = static_cast<const uicore_jpge::uint8 *>(data);
+				output.insert(output.end(), bytes, bytes + len);
+				return true;
+			}
+
+			std::vector<uicore_jpge::uint8> output;
+		};
+	}
+
+	void JPEGFormat::save(std::shared_ptr<PixelBuffer> buffer, const std::shared_ptr<IODevice> &file, const JPEGSaveSettings &settings)
 	{
 		if (buffer->format() != tf_rgb8)
 		{
@@ -66,15 +115,17 @@ namespace uicore
 			buffer = newbuf;
 		}
 
-		auto output = DataBuffer::create(buffer->width() * buffer->height() * 5);
-		int size = output->size();
-
 		uicore_jpge::params desc;
-		desc.m_quality = quality;
-		bool result = uicore_jpge::compress_image_to_jpeg_file_in_memory(output->data(), size, buffer->width(), buffer->height(), 3, output->data<uicore_jpge::uint8>(), desc);
+		desc.m_quality = settings.quality;
+		desc.m_restart_rows = settings.restart_rows;
+		desc.m_two_pass_flag = settings.optimize_huffman;
+
+		JPEGOutputStream stream;
+		stream.output.reserve(buffer->width() * buffer->height() / 2 + 1024);
+		bool result = uicore_jpge::compress_image_to_jpeg_stream(stream, buffer->width(), buffer->height(), 3, buffer->data<uicore_jpge::uint8>(), buffer->pitch(), desc);
 		if (!result)
 			throw Exception("Unable to compress JPEG image");
 
-		file->write(output->data(), size);
+		file->write(stream.output.data(), (int)stream.output.size());
 	}
 }
@@ -30,6 +30,8 @@
 #include "UICore/precomp.h"
 #include "UICore/Core/System/exception.h"
 #include "UICore/Core/IOData/file.h"
+#include "UICore/Core/IOData/memory_device.h"
+#include "UICore/Core/IOData/mapped_file.h"
 #include "UICore/Core/IOData/path_help.h"
 #include "UICore/Core/Text/text.h"
 #include "UICore/Display/Image/pixel_buffer.h"
@@ -43,7 +45,7 @@ namespace uicore
 {
 	std::shared_ptr<PixelBuffer> PNGFormat::load(const std::string &filename, bool srgb)
 	{
-		auto file = File::open_existing(filename);
+		auto file = MemoryDevice::open(MappedFile::open_or_read(filename));
 		return PNGLoader::load(file, srgb);
 	}
 
@@ -52,15 +54,36 @@ namespace uicore
 		return PNGLoader::load(file, srgb);
 	}
 
-	void PNGFormat::save(std::shared_ptr<PixelBuffer> buffer, const std::string &filename)
+	std::shared_ptr<PixelBuffer> PNGFormat::load(const std::shared_ptr<IODevice> &file, const ImageImportDescription &import_desc)
+	{
+		return PNGLoader::load(file, import_desc.is_srgb());
+	}
+
+	void PNGFormat::load_scanlines(const std::shared_ptr<IODevice> &file, const std::function<void(const Size &image_size, int y, const std::shared_ptr<PixelBuffer> &scanline)> &callback, bool srgb)
+	{
+		PNGLoader::load(file, srgb, callback);
+	}
+
+	ImageFileInfo PNGFormat::probe(const std::string &filename, bool srgb)
+	{
+		auto file = File::open_existing(filename);
+		return PNGLoader::probe(file, srgb);
+	}
+
+	ImageFileInfo PNGFormat::probe(const std::shared_ptr<IODevice> &file, bool srgb)
+	{
+		return PNGLoader::probe(file, srgb);
+	}
+
+	void PNGFormat::save(std::shared_ptr<PixelBuffer> buffer, const std::string &filename, bool multithreaded)
 	{
 		auto file = File::create_always(filename);
-		save(buffer, file);
+		save(buffer, file, multithreaded);
 	}
 
-	void PNGFormat::save(std::shared_ptr<PixelBuffer> buffer, const std::shared_ptr<IODevice> &iodev)
+	void PNGFormat::save(std::shared_ptr<PixelBuffer> buffer, const std::shared_ptr<IODevice> &iodev, bool multithreaded)
 	{
-		PNGWriter::save(iodev, buffer);
+		PNGWriter::save(iodev, buffer, multithreaded);
 		/*
 		if (buffer.get_format() != tf_rgba8)
 		{
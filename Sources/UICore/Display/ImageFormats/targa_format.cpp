@@ -29,6 +29,8 @@
 #include "UICore/precomp.h"
 #include "UICore/Core/System/exception.h"
 #include "UICore/Core/IOData/file.h"
+#include "UICore/Core/IOData/memory_device.h"
+#include "UICore/Core/IOData/mapped_file.h"
 #include "UICore/Core/IOData/path_help.h"
 #include "UICore/Display/ImageFormats/targa_format.h"
 #include "UICore/Display/Image/pixel_buffer.h"
@@ -38,7 +40,7 @@ namespace uicore
 {
 	std::shared_ptr<PixelBuffer> TargaFormat::load(const std::string &filename, bool srgb)
 	{
-		auto file = File::open_existing(filename);
+		auto file = MemoryDevice::open(MappedFile::open_or_read(filename));
 		return TargaLoader::load(file, srgb);
 	}
 
@@ -47,6 +49,22 @@ namespace uicore
 		return TargaLoader::load(file, srgb);
 	}
 
+	std::shared_ptr<PixelBuffer> TargaFormat::load(const std::shared_ptr<IODevice> &file, const ImageImportDescription &import_desc)
+	{
+		return TargaLoader::load(file, import_desc.is_srgb());
+	}
+
+	ImageFileInfo TargaFormat::probe(const std::string &filename, bool srgb)
+	{
+		auto file = File::open_existing(filename);
+		return TargaLoader::probe(file, srgb);
+	}
+
+	ImageFileInfo TargaFormat::probe(const std::shared_ptr<IODevice> &file, bool srgb)
+	{
+		return TargaLoader::probe(file, srgb);
+	}
+
 	void TargaFormat::save(std::shared_ptr<PixelBuffer> buffer, const std::string &filename)
 	{
 		throw Exception("TargaFormat doesn't support saving");
@@ -31,6 +31,7 @@
 #include "UICore/Display/Render/texture_impl.h"
 #include "UICore/Display/Render/graphic_context_impl.h"
 #include "UICore/Display/Image/pixel_buffer.h"
+#include "UICore/Display/Image/pixel_buffer_set.h"
 #include "UICore/Display/ImageFormats/image_file.h"
 #include "UICore/Core/Math/color.h"
 #include "UICore/Core/IOData/path_help.h"
@@ -38,6 +39,36 @@
 
 namespace uicore
 {
+	namespace
+	{
+		std::shared_ptr<Texture2D> create_from_image(const std::shared_ptr<GraphicContext> &context, std::shared_ptr<PixelBuffer> pb, const ImageImportDescription &import_desc)
+		{
+			TextureFormat format = import_desc.is_srgb() ? tf_srgb8_alpha8 : tf_rgba8;
+
+			if (!import_desc.mipmaps())
+			{
+				auto texture = Texture2D::create(context, pb->width(), pb->height(), format);
+				texture->set_subimage(context, Point(0, 0), pb, Rect(pb->size()), 0);
+				return texture;
+			}
+
+			// Downsampling must know if the pixels are sRGB encoded to filter them in linear space
+			if (pb->format() != format)
+			{
+				if ((pb->format() == tf_rgba8 && format == tf_srgb8_alpha8) || (pb->format() == tf_srgb8_alpha8 && format == tf_rgba8))
+					pb = PixelBuffer::create(pb->width(), pb->height(), format, pb->data());
+				else
+					pb = pb->to_format(format);
+			}
+
+			auto set = PixelBufferSet::create_mipmaps(pb);
+			auto texture = Texture2D::create(context, pb->width(), pb->height(), format, set->max_level() + 1);
+			for (int level = 0; level <= set->max_level(); level++)
+				texture->set_image(context, set->image(0, level), level);
+			return texture;
+		}
+	}
+
 	std::shared_ptr<Texture2D> Texture2D::create(const std::shared_ptr<GraphicContext> &context, int width, int height, TextureFormat format, int levels)
 	{
 		return static_cast<GraphicContextImpl*>(context.get())->create_texture_2d(width, height, format, levels);
@@ -50,22 +81,16 @@ namespace uicore
 
 	std::shared_ptr<Texture2D> Texture2D::create(const std::shared_ptr<GraphicContext> &context, const std::string &filename, const ImageImportDescription &import_desc)
 	{
-		std::shared_ptr<PixelBuffer> pb = ImageFile::load(filename, std::string());
+		std::shared_ptr<PixelBuffer> pb = ImageFile::load(filename, import_desc);
 		pb = import_desc.process(pb);
-
-		auto texture = create(context, pb->width(), pb->height(), import_desc.is_srgb() ? tf_srgb8_alpha8 : tf_rgba8);
-		texture->set_subimage(context, Point(0, 0), pb, Rect(pb->size()), 0);
-		return texture;
+		return create_from_image(context, pb, import_desc);
 	}
 
 	std::shared_ptr<Texture2D> Texture2D::create(const std::shared_ptr<GraphicContext> &context, const std::shared_ptr<IODevice> &file, const std::string &image_type, const ImageImportDescription &import_desc)
 	{
-		std::shared_ptr<PixelBuffer> pb = ImageFile::load(file, image_type);
+		std::shared_ptr<PixelBuffer> pb = ImageFile::load(file, image_type, import_desc);
 		pb = import_desc.process(pb);
-
-		auto texture = create(context, pb->width(), pb->height(), import_desc.is_srgb() ? tf_srgb8_alpha8 : tf_rgba8);
-		texture->set_subimage(context, Point(0, 0), pb, Rect(pb->size()), 0);
-		return texture;
+		return create_from_image(context, pb, import_desc);
 	}
 
 	std::shared_ptr<Texture2D> Texture2D::create(const std::shared_ptr<GraphicContext> &context, const std::shared_ptr<PixelBuffer> &image, bool is_srgb)
@@ -43,6 +43,43 @@ namespace uicore
 		std::function<std::shared_ptr<Image>(const std::shared_ptr<Canvas> &)> cb_get_image;
 	};
 
+	class ImageSourceAsync : public ImageSource
+	{
+	public:
+		ImageSourceAsync(const std::string &resource_name, const std::shared_ptr<Image> &placeholder) : resource_name(resource_name), placeholder(placeholder) { }
+
+		std::shared_ptr<Image> image(const std::shared_ptr<Canvas> &canvas) override
+		{
+			if (!loaded_image && !load_slot && !load_failed)
+			{
+				// Cached images are returned directly without signalling a change
+				load_slot = UIThread::image_async(canvas, resource_name, [this](const std::shared_ptr<Image> &image)
+				{
+					if (!image) // Keep showing the placeholder instead of retrying on every paint
+					{
+						load_failed = true;
+						load_slot = Slot();
+						return;
+					}
+
+					loaded_image = image;
+					if (loading)
+						sig_image_changed()();
+				});
+				loading = true;
+			}
+
+			return loaded_image ? loaded_image : placeholder;
+		}
+
+		std::string resource_name;
+		std::shared_ptr<Image> placeholder;
+		std::shared_ptr<Image> loaded_image;
+		Slot load_slot;
+		bool loading = false;
+		bool load_failed = false;
+	};
+
 	std::shared_ptr<ImageSource> ImageSource::from_callback(const std::function<std::shared_ptr<Image>(const std::shared_ptr<Canvas> &)> &get_image_callback)
 	{
 		return std::make_shared<ImageSourceCallback>(get_image_callback);
@@ -56,6 +93,11 @@ namespace uicore
 		});
 	}
 
+	std::shared_ptr<ImageSource> ImageSource::from_resource_async(const std::string &resource_name, const std::shared_ptr<Image> &placeholder)
+	{
+		return std::make_shared<ImageSourceAsync>(resource_name, placeholder);
+	}
+
 	std::shared_ptr<ImageSource> ImageSource::from_image(const std::shared_ptr<Image> &image)
 	{
 		return ImageSource::from_callback([=](const std::shared_ptr<Canvas> &canvas)
@@ -998,9 +998,12 @@ namespace uicore
 		if (last_measured_rects.empty())
 			return 0;
 
-		for (unsigned int cnt = 0; cnt < last_measured_rects.size(); cnt++)
+		// The rects are ordered left to right, so find the last one starting at or before the mouse
+		auto it = std::upper_bound(last_measured_rects.begin(), last_measured_rects.end(), (float)mouse_x, [](float x, const Rectf &box) { return x < box.left; });
+		if (it != last_measured_rects.begin())
 		{
-			if ((last_measured_rects[cnt].left <= mouse_x) && (last_measured_rects[cnt].right > mouse_x))
+			unsigned int cnt = it - last_measured_rects.begin() - 1;
+			if (last_measured_rects[cnt].right > mouse_x)
 				return cnt + 1;
 		}
 		if (last_measured_rects[0].left >= mouse_x)
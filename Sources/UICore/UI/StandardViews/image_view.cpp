@@ -45,6 +45,8 @@ namespace uicore
 		std::shared_ptr<ImageSource> highlighted_image;
 		std::shared_ptr<Image> canvas_image;
 		std::shared_ptr<Image> canvas_highlighted_image;
+		Slot image_changed_slot;
+		Slot highlighted_image_changed_slot;
 
 		void get_images(const std::shared_ptr<Canvas> &canvas)
 		{
@@ -69,6 +71,16 @@ namespace uicore
 	{
 		impl->image = image;
 		impl->canvas_image = nullptr;
+		impl->image_changed_slot = Slot();
+		if (image)
+		{
+			impl->image_changed_slot = image->sig_image_changed().connect([this]()
+			{
+				impl->canvas_image = nullptr;
+				set_needs_render();
+				set_needs_layout();
+			});
+		}
 		set_needs_render();
 		set_needs_layout();
 	}
@@ -87,6 +99,15 @@ namespace uicore
 	{
 		impl->highlighted_image = image;
 		impl->canvas_highlighted_image = nullptr;
+		impl->highlighted_image_changed_slot = Slot();
+		if (image)
+		{
+			impl->highlighted_image_changed_slot = image->sig_image_changed().connect([this]()
+			{
+				impl->canvas_highlighted_image = nullptr;
+				set_needs_render();
+			});
+		}
 		set_needs_render();
 		set_needs_layout();
 	}
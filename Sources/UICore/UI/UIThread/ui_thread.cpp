@@ -29,6 +29,10 @@
 #include "UICore/precomp.h"
 #include "UICore/Display/2D/canvas.h"
 #include "UICore/Display/2D/image.h"
+#include "UICore/Display/2D/texture_group.h"
+#include "UICore/Display/Image/pixel_buffer.h"
+#include "UICore/Display/ImageFormats/image_file.h"
+#include "UICore/Display/Render/texture_2d.h"
 #include "UICore/Display/Font/font.h"
 #include "UICore/Display/Font/font_family.h"
 #include "UICore/Display/System/run_loop.h"
@@ -37,10 +41,124 @@
 #include "UICore/Core/IOData/path_help.h"
 #include "UICore/Core/IOData/directory.h"
 #include "UICore/UI/Style/style.h"
+#include "UICore/Core/System/thread_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <list>
 #include <map>
 
 namespace uicore
 {
+	class UIThreadPendingImage;
+
+	class UIThreadImageSlot : public SlotImpl
+	{
+	public:
+		UIThreadImageSlot(const std::shared_ptr<UIThreadPendingImage> &pending, const std::function<void(const std::shared_ptr<Image> &)> &loaded);
+		~UIThreadImageSlot();
+
+		std::weak_ptr<UIThreadPendingImage> pending;
+		std::function<void(const std::shared_ptr<Image> &)> loaded;
+	};
+
+	class UIThreadPendingImage
+	{
+	public:
+		std::string name;
+		std::shared_ptr<GraphicContext> gc;
+		std::atomic<int> listener_count{ 0 };
+		std::vector<std::weak_ptr<UIThreadImageSlot>> slots;
+
+		std::shared_ptr<PixelBuffer> pixels;
+		std::exception_ptr error;
+		std::shared_ptr<Texture2D> texture;
+		int uploaded_rows = 0;
+
+		bool is_cancelled() const { return listener_count == 0; }
+	};
+
+	class UIThreadImageCache
+	{
+	public:
+		std::shared_ptr<Image> find(const std::string &name)
+		{
+			auto it = entries.find(name);
+			if (it == entries.end())
+			{
+				statistics.misses++;
+				return nullptr;
+			}
+
+			statistics.hits++;
+			lru.splice(lru.begin(), lru, it->second.lru_position);
+			return it->second.image;
+		}
+
+		void add(const std::string &name, const std::shared_ptr<Image> &image, TextureFormat format)
+		{
+			remove(name);
+
+			Entry entry;
+			entry.image = image;
+			entry.size = PixelBuffer::data_size(image->texture().texture()->size(), format);
+			lru.push_front(name);
+			entry.lru_position = lru.begin();
+			entries[name] = entry;
+
+			statistics.size += entry.size;
+			statistics.count++;
+
+			evict(budget);
+		}
+
+		// Evicts least recently used images that nothing else holds a reference to
+		void evict(int64_t max_size)
+		{
+			auto it = lru.end();
+			while (statistics.size > max_size && it != lru.begin())
+			{
+				--it;
+				auto &entry = entries[*it];
+				if (entry.image.use_count() == 1)
+				{
+					std::string name = *it;
+					it = lru.erase(it);
+					statistics.size -= entry.size;
+					statistics.count--;
+					statistics.evictions++;
+					entries.erase(name);
+				}
+			}
+		}
+
+		void remove(const std::string &name)
+		{
+			auto it = entries.find(name);
+			if (it != entries.end())
+			{
+				statistics.size -= it->second.size;
+				statistics.count--;
+				lru.erase(it->second.lru_position);
+				entries.erase(it);
+			}
+		}
+
+		int64_t budget = 128 * 1024 * 1024;
+		ImageCacheStatistics statistics;
+
+	private:
+		struct Entry
+		{
+			std::shared_ptr<Image> image;
+			int64_t size = 0;
+			std::list<std::string>::iterator lru_position;
+		};
+
+		std::map<std::string, Entry> entries;
+		std::list<std::string> lru; // Most recently used first
+	};
+
 	class UIThreadImpl
 	{
 	public:
@@ -60,7 +178,90 @@ namespace uicore
 		std::function<void(const std::exception_ptr &)> exception_handler;
 
 		std::map<std::string, std::shared_ptr<FontFamily>> font_families;
-		std::map<std::string, std::shared_ptr<Image>> images;
+		UIThreadImageCache images;
+
+		std::map<std::string, std::shared_ptr<UIThreadPendingImage>> pending_images;
+		std::deque<std::shared_ptr<UIThreadPendingImage>> upload_queue;
+		bool upload_scheduled = false;
+
+		// Texture data uploaded per message loop iteration
+		static const int upload_bytes_per_slice = 4 * 1024 * 1024;
+
+		void schedule_upload()
+		{
+			if (upload_scheduled)
+				return;
+
+			upload_scheduled = true;
+			RunLoop::main_thread_async([this]() { process_uploads(); });
+		}
+
+		void process_uploads()
+		{
+			upload_scheduled = false;
+
+			int budget = upload_bytes_per_slice;
+			while (budget > 0 && !upload_queue.empty())
+			{
+				auto pending = upload_queue.front();
+
+				if (pending->is_cancelled() || !pending->pixels)
+				{
+					upload_queue.pop_front();
+					remove_pending(pending);
+					if (!pending->is_cancelled())
+					{
+						// Failed loads are reported with a null image so the callers can release their slots
+						notify_loaded(pending, nullptr);
+						if (pending->error)
+							exception_handler(pending->error);
+					}
+					continue;
+				}
+
+				auto &pixels = pending->pixels;
+				if (!pending->texture)
+					pending->texture = Texture2D::create(pending->gc, pixels->width(), pixels->height(), pixels->format());
+
+				int rows = std::min(std::max(budget / pixels->pitch(), 1), pixels->height() - pending->uploaded_rows);
+				pending->texture->set_subimage(pending->gc, 0, pending->uploaded_rows, pixels, Rect(0, pending->uploaded_rows, pixels->width(), pending->uploaded_rows + rows));
+				pending->uploaded_rows += rows;
+				budget -= rows * pixels->pitch();
+
+				if (pending->uploaded_rows == pixels->height())
+				{
+					upload_queue.pop_front();
+					remove_pending(pending);
+
+					float pixel_ratio = pixels->pixel_ratio() != 0.0f ? pixels->pixel_ratio() : 1.0f;
+					auto image = Image::create(pending->texture, pixels->size(), pixel_ratio);
+					images.add(pending->name, image, pixels->format());
+
+					notify_loaded(pending, image);
+				}
+			}
+
+			if (!upload_queue.empty())
+				schedule_upload();
+		}
+
+		void notify_loaded(const std::shared_ptr<UIThreadPendingImage> &pending, const std::shared_ptr<Image> &image)
+		{
+			auto slots = pending->slots;
+			for (auto &weak_slot : slots)
+			{
+				auto slot = weak_slot.lock();
+				if (slot)
+					slot->loaded(image);
+			}
+		}
+
+		void remove_pending(const std::shared_ptr<UIThreadPendingImage> &pending)
+		{
+			auto it = pending_images.find(pending->name);
+			if (it != pending_images.end() && it->second == pending)
+				pending_images.erase(it);
+		}
 
 		static UIThreadImpl *instance()
 		{
@@ -125,9 +326,108 @@ namespace uicore
 	std::shared_ptr<Image> UIThread::image(const std::shared_ptr<Canvas> &canvas, const std::string &name)
 	{
 		auto &images = UIThreadImpl::instance()->images;
-		if (images.find(name) == images.end())
-			images[name] = Image::create(canvas, FilePath::combine(UIThreadImpl::instance()->resource_path, name));
-		return images[name];
+		auto image = images.find(name);
+		if (!image)
+		{
+			// Charge the cache with the format Texture2D::create uses for the import description
+			ImageImportDescription import_desc;
+			image = Image::create(canvas, FilePath::combine(UIThreadImpl::instance()->resource_path, name), import_desc);
+			images.add(name, image, import_desc.is_srgb() ? tf_srgb8_alpha8 : tf_rgba8);
+		}
+		return image;
+	}
+
+	Slot UIThread::image_async(const std::shared_ptr<Canvas> &canvas, const std::string &name, const std::function<void(const std::shared_ptr<Image> &)> &loaded)
+	{
+		auto impl = UIThreadImpl::instance();
+
+		auto image = impl->images.find(name);
+		if (image)
+		{
+			loaded(image);
+			return Slot();
+		}
+
+		auto &pending = impl->pending_images[name];
+		bool start_load = !pending || pending->is_cancelled();
+		if (start_load)
+		{
+			pending = std::make_shared<UIThreadPendingImage>();
+			pending->name = name;
+			pending->gc = canvas->gc();
+		}
+
+		auto slot = std::make_shared<UIThreadImageSlot>(pending, loaded);
+		pending->slots.push_back(slot);
+
+		if (start_load)
+		{
+			std::string filename = FilePath::combine(impl->resource_path, name);
+			std::shared_ptr<UIThreadPendingImage> job = pending;
+			ThreadPool::shared().queue([=]()
+			{
+				if (!job->is_cancelled())
+				{
+					try
+					{
+						ImageImportDescription import_desc;
+						auto pixels = ImageFile::load(filename, import_desc);
+						float pixel_ratio = pixels->pixel_ratio();
+						pixels = import_desc.process(pixels);
+						if (pixels->format() != tf_rgba8)
+							pixels = pixels->to_format(tf_rgba8);
+						pixels->set_pixel_ratio(pixel_ratio);
+						job->pixels = pixels;
+					}
+					catch (...)
+					{
+						job->error = std::current_exception();
+					}
+				}
+
+				RunLoop::main_thread_async([=]()
+				{
+					UIThreadImpl::instance()->upload_queue.push_back(job);
+					UIThreadImpl::instance()->schedule_upload();
+				});
+			});
+		}
+
+		return Slot(slot);
+	}
+
+	UIThreadImageSlot::UIThreadImageSlot(const std::shared_ptr<UIThreadPendingImage> &pending, const std::function<void(const std::shared_ptr<Image> &)> &loaded) : pending(pending), loaded(loaded)
+	{
+		pending->listener_count++;
+	}
+
+	UIThreadImageSlot::~UIThreadImageSlot()
+	{
+		auto p = pending.lock();
+		if (p)
+			p->listener_count--;
+	}
+
+	int64_t UIThread::image_cache_budget()
+	{
+		return UIThreadImpl::instance()->images.budget;
+	}
+
+	void UIThread::set_image_cache_budget(int64_t bytes)
+	{
+		auto &images = UIThreadImpl::instance()->images;
+		images.budget = bytes;
+		images.evict(bytes);
+	}
+
+	ImageCacheStatistics UIThread::image_cache_statistics()
+	{
+		return UIThreadImpl::instance()->images.statistics;
+	}
+
+	void UIThread::purge_image_cache()
+	{
+		UIThreadImpl::instance()->images.evict(0);
 	}
 
 	std::shared_ptr<Font> UIThread::font(const std::string &family, const FontDescription &desc)